@@ -0,0 +1,77 @@
+#include "corpus/corpus.hpp"
+#include "util/logger.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace {
+    /// \brief Parsed command line
+    struct options_t {
+        std::filesystem::path path = {};
+        bool x86 = false;
+        corpus::config_t config = {};
+    };
+
+    void print_help(char* argv[]) {
+        logger::info("Usage: {} [out.exe] [options...]", argv[0]);
+        logger::info("Available options:");
+        logger::info<1>("{:<12} {:<8} -- {}", "-x86", "", "Generate a x86 image instead of x64");
+        logger::info<1>("{:<12} {:<8} -- {}", "-functions", "[count]", "Set the number of functions");
+        logger::info<1>("{:<12} {:<8} -- {}", "-blocks", "[count]", "Set the number of basic blocks per function");
+        logger::info<1>("{:<12} {:<8} -- {}", "-fanout", "[count]", "Set the jump table fan-out, 0 disables jump tables");
+        logger::info<1>("{:<12} {:<8} -- {}", "-relocs", "[count]", "Set the number of relocated immediates per function");
+    }
+
+    [[nodiscard]] options_t parse_options(const int argc, char* argv[]) {
+        options_t result = {.path = argv[1]};
+
+        for (int i = 2; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "-x86") {
+                result.x86 = true;
+                continue;
+            }
+
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::format("corpus: missing value for {}", arg));
+            }
+
+            const auto value = static_cast<std::size_t>(std::stoull(argv[++i], nullptr, 0));
+            if (arg == "-functions") {
+                result.config.functions = value;
+            } else if (arg == "-blocks") {
+                result.config.blocks = value;
+            } else if (arg == "-fanout") {
+                result.config.jump_table_fanout = value;
+            } else if (arg == "-relocs") {
+                result.config.relocated_immediates = value;
+            } else {
+                throw std::runtime_error(std::format("corpus: unknown option {}", arg));
+            }
+        }
+
+        return result;
+    }
+
+    int startup(const int argc, char* argv[]) try {
+        if (argc < 2 || std::string_view{argv[1]} == "-h" || std::string_view{argv[1]} == "--help") {
+            print_help(argv);
+            return argc < 2 ? 1 : 0;
+        }
+
+        const auto options = parse_options(argc, argv);
+        const auto output = options.x86 ? corpus::generate<win::image_x86_t>(options.config) : corpus::generate<win::image_x64_t>(options.config);
+        corpus::save(output, options.path);
+
+        logger::info("corpus: saved {} functions ({} instructions, {:#x} bytes) to {}", output.functions.size(), output.instructions,
+                     output.image.size(), options.path.string());
+        return 0;
+    } catch (std::exception& err) {
+        logger::critical("RUNTIME ERROR: {}", err.what());
+        return 1;
+    }
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    return startup(argc, argv);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+namespace bench::jit {
+    /// \brief Cycles counter, uses the core cycles from perf events if they're available and falls back to rdtsc otherwise
+    /// \note rdtsc ticks with the reference frequency, so the numbers are off if the core is boosting/throttling.
+    /// Perf events are usually unavailable within containers or with `perf_event_paranoid` > 2
+    class CycleCounter {
+    public:
+        NON_COPYABLE(CycleCounter);
+
+        CycleCounter() {
+            perf_event_attr attr = {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        ~CycleCounter() {
+            if (fd_ != -1) {
+                close(fd_);
+            }
+        }
+
+        /// \brief Count the cycles that it took to execute the callback
+        /// \param callback callback
+        /// \return cycles
+        template <typename Fn>
+        [[nodiscard]] std::uint64_t measure(Fn&& callback) const {
+            if (fd_ == -1) {
+                _mm_lfence();
+                const auto start = __rdtsc();
+                _mm_lfence();
+                callback();
+                _mm_lfence();
+                return __rdtsc() - start;
+            }
+
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            callback();
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+
+            std::uint64_t result = 0;
+            if (read(fd_, &result, sizeof(result)) != sizeof(result)) {
+                return 0;
+            }
+            return result;
+        }
+
+        /// \brief Check whether we're counting the core cycles
+        [[nodiscard]] bool uses_perf() const noexcept {
+            return fd_ != -1;
+        }
+
+    private:
+        int fd_ = -1;
+    };
+} // namespace bench::jit
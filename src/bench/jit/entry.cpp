@@ -0,0 +1,63 @@
+#include "jit/harness.hpp"
+#include "jit/stubs.hpp"
+#include "util/logger.hpp"
+#include "util/random.hpp"
+
+#include <string_view>
+
+namespace {
+    /// \brief Measure the suite and print the results, the cheapest stubs go first
+    /// \param harness harness
+    /// \param suite suite name
+    /// \param cases stubs
+    /// \param filter substring that the stub name should contain
+    void run_suite(const bench::jit::Harness& harness, const std::string_view suite, const std::vector<bench::jit::case_t>& cases,
+                   const std::string_view filter) {
+        std::vector<bench::jit::result_t> results = {};
+        for (const auto& stub : cases) {
+            if (!filter.empty() && !stub.name.contains(filter)) {
+                continue;
+            }
+
+            results.emplace_back(harness.measure(stub));
+        }
+
+        if (results.empty()) {
+            return;
+        }
+
+        std::ranges::sort(results, {}, &bench::jit::result_t::cycles);
+
+        logger::info("{}:", suite);
+        for (const auto& result : results) {
+            if (result.estimate.has_value()) {
+                logger::info<1>("{:<40} {:>8.2f} cycles {:>5} bytes (estimated {:.2f})", result.name, result.cycles, result.size, *result.estimate);
+                continue;
+            }
+
+            logger::info<1>("{:<40} {:>8.2f} cycles {:>5} bytes", result.name, result.cycles, result.size);
+        }
+    }
+
+    int startup(const int argc, char* argv[]) try {
+        rnd::detail::seed(0x1337);
+
+        const std::string_view filter = argc > 1 ? argv[1] : "";
+        const bench::jit::Harness harness;
+        logger::info_or_warn(harness.uses_perf(), "jit: counting {}", harness.uses_perf() ? "core cycles" : "reference cycles (rdtsc)");
+
+        run_suite(harness, "mathop operations", bench::jit::stubs::mathop_operations(), filter);
+        run_suite(harness, "mathop budgets", bench::jit::stubs::mathop_budgets(), filter);
+        run_suite(harness, "opaque predicates", bench::jit::stubs::opaque_predicates(), filter);
+        run_suite(harness, "constant crypt", bench::jit::stubs::anti_symbolic_execution(), filter);
+        run_suite(harness, "spill frames", bench::jit::stubs::spill_frames(), filter);
+        return 0;
+    } catch (std::runtime_error& err) {
+        logger::critical("RUNTIME ERROR: {}", err.what());
+        return 1;
+    }
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    return startup(argc, argv);
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "jit/counter.hpp"
+#include "jit/memory.hpp"
+#include "easm/assembler/assembler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+
+namespace bench::jit {
+    /// \brief Stub builder, `next` is bound right after the stub so that the branches have somewhere to go to
+    using builder_t = std::function<void(zasm::Program& program, zasm::x86::Assembler* as, zasm::Label next)>;
+
+    /// \brief Stub that we should measure
+    struct case_t {
+        std::string name = {};
+        builder_t builder = {};
+        /// \brief Number of the measured units within the stub, results are divided by it
+        std::size_t units = 1;
+        /// \brief Estimated cycles per unit, if there's any
+        std::optional<double> estimate = std::nullopt;
+    };
+
+    /// \brief Measurement result
+    struct result_t {
+        std::string name = {};
+        /// \brief Cycles per unit, baseline loop is subtracted
+        double cycles = 0.;
+        std::optional<double> estimate = std::nullopt;
+        /// \brief Stub size in bytes
+        std::size_t size = 0;
+    };
+
+    /// \brief Assembles the stubs into a loop and runs it natively
+    /// \note The stubs are executed in the middle of the loop body:
+    ///     push rbx, rbp, r12-r15
+    ///     sub rsp, frame            ; opaque predicates are reading random stuff from stack, so it should be there
+    ///     mov [rsp+counter], rdi
+    ///   loop:
+    ///     <stub>
+    ///   next:
+    ///     dec qword ptr [rsp+counter]
+    ///     jnz loop
+    ///     ...
+    /// Stubs could clobber any register except for rsp (that's what the obfuscated code does), so the counter lives on stack.
+    class Harness {
+    public:
+        NON_COPYABLE(Harness);
+
+        /// \param iterations loop iterations per run
+        /// \param repeats number of runs, the fastest one wins
+        explicit Harness(const std::size_t iterations = 100000, const std::size_t repeats = 11): iterations_(iterations), repeats_(repeats) {
+            baseline_ = run({.name = "baseline", .builder = [](zasm::Program&, zasm::x86::Assembler*, zasm::Label) -> void { }}).first;
+        }
+
+        /// \brief Measure the stub
+        /// \param stub stub
+        /// \return result
+        [[nodiscard]] result_t measure(const case_t& stub) const {
+            const auto [cycles, size] = run(stub);
+
+            const auto delta = cycles > baseline_ ? cycles - baseline_ : 0;
+            return {
+                .name = stub.name,
+                .cycles = static_cast<double>(delta) / static_cast<double>(iterations_) / static_cast<double>(stub.units),
+                .estimate = stub.estimate,
+                .size = size,
+            };
+        }
+
+        /// \brief Check whether we're counting the core cycles
+        [[nodiscard]] bool uses_perf() const noexcept {
+            return counter_.uses_perf();
+        }
+
+    private:
+        static constexpr std::int32_t kFrameSize = 0x308; // 6 pushes + ret address + frame are keeping rsp aligned
+        static constexpr std::int32_t kCounterOffset = 0x300;
+        static constexpr std::array kCalleeSaved = {zasm::x86::rbx, zasm::x86::rbp, zasm::x86::r12,
+                                                    zasm::x86::r13, zasm::x86::r14, zasm::x86::r15};
+
+        /// \brief Assemble and run the stub
+        /// \param stub stub
+        /// \return the fastest run cycles, stub size
+        [[nodiscard]] std::pair<std::uint64_t, std::size_t> run(const case_t& stub) const {
+            using namespace zasm::x86;
+
+            zasm::Program program(zasm::MachineMode::AMD64);
+            Assembler as(program);
+
+            for (const auto& reg : kCalleeSaved) {
+                as.push(reg);
+            }
+            as.sub(rsp, zasm::Imm(kFrameSize));
+            as.mov(qword_ptr(rsp, kCounterOffset), rdi);
+
+            const auto loop = program.createLabel();
+            const auto next = program.createLabel();
+            as.bind(loop);
+
+            const auto size_before = easm::estimate_program_size(program);
+            stub.builder(program, &as, next);
+            const auto stub_size = easm::estimate_program_size(program) - size_before;
+
+            /// Stubs are moving the cursor around, the loop tail goes after everything
+            as.setCursor(program.getTail());
+            as.bind(next);
+            as.dec(qword_ptr(rsp, kCounterOffset));
+            as.jnz(loop);
+            as.add(rsp, zasm::Imm(kFrameSize));
+            for (auto it = kCalleeSaved.rbegin(); it != kCalleeSaved.rend(); std::advance(it, 1)) {
+                as.pop(*it);
+            }
+            as.ret();
+
+            /// Assemble it to get the size first, then reassemble it at the real address
+            ExecutableMemory memory(easm::assemble_program(nullptr, program).data.size());
+            memory.seal(easm::assemble_program(memory.address(), program).data);
+
+            const auto entry = memory.as<void (*)(std::uint64_t)>();
+            auto result = std::numeric_limits<std::uint64_t>::max();
+            for (std::size_t i = 0; i < repeats_; ++i) {
+                result = std::min(result, counter_.measure([entry, this]() -> void { entry(iterations_); }));
+            }
+
+            return {result, stub_size};
+        }
+
+        CycleCounter counter_ = {};
+        std::size_t iterations_ = 0;
+        std::size_t repeats_ = 0;
+        std::uint64_t baseline_ = 0;
+    };
+} // namespace bench::jit
@@ -0,0 +1,58 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace bench::jit {
+    /// \brief Executable memory region, it's writable until `seal` is called
+    class ExecutableMemory {
+    public:
+        NON_COPYABLE(ExecutableMemory);
+
+        /// \param size region size
+        explicit ExecutableMemory(const std::size_t size): size_(size) {
+            ptr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr_ == MAP_FAILED) {
+                throw std::runtime_error(std::format("jit: unable to allocate {:#x} bytes", size_));
+            }
+        }
+
+        ~ExecutableMemory() {
+            munmap(ptr_, size_);
+        }
+
+        /// \brief Copy the code and make the region executable
+        /// \param code assembled code
+        void seal(const std::span<const std::uint8_t> code) {
+            if (code.size() > size_) {
+                throw std::runtime_error(std::format("jit: code doesn't fit ({:#x} > {:#x})", code.size(), size_));
+            }
+
+            std::memcpy(ptr_, code.data(), code.size());
+            if (mprotect(ptr_, size_, PROT_READ | PROT_EXEC) != 0) {
+                throw std::runtime_error("jit: unable to make the region executable");
+            }
+        }
+
+        /// \brief Get the region start address
+        [[nodiscard]] std::uintptr_t address() const noexcept {
+            return reinterpret_cast<std::uintptr_t>(ptr_); // NOLINT
+        }
+
+        /// \brief Get the region start as a function ptr
+        template <typename Ty>
+        [[nodiscard]] Ty as() const noexcept {
+            return reinterpret_cast<Ty>(ptr_); // NOLINT
+        }
+
+    private:
+        void* ptr_ = nullptr;
+        std::size_t size_ = 0;
+    };
+} // namespace bench::jit
@@ -0,0 +1,184 @@
+#pragma once
+#include "jit/harness.hpp"
+#include "mathop/mathop.hpp"
+#include "obfuscator/transforms/transforms/util/anti_decompilers.hpp"
+#include "obfuscator/transforms/transforms/util/opaque_predicates.hpp"
+
+#include <format>
+#include <memory>
+#include <vector>
+
+/// \note Stubs are generated the same way the transforms are generating them, except for the register allocation,
+/// every register is assumed to be alive so that the spills are included in the numbers.
+namespace bench::jit::stubs {
+    using Img = pe::X64Image;
+
+    namespace detail {
+        /// \brief Number of the operations in the chain, so that the loop overhead wouldn't matter
+        constexpr std::size_t kChainLength = 16;
+
+        /// \brief Operations that we're measuring
+        [[nodiscard]] inline std::vector<std::pair<std::string, std::shared_ptr<mathop::Operation>>> operations() {
+            return {
+                {"add", std::make_shared<mathop::operations::Add>()},       {"sub", std::make_shared<mathop::operations::Sub>()},
+                {"inc", std::make_shared<mathop::operations::Inc>()},       {"dec", std::make_shared<mathop::operations::Dec>()},
+                {"xor", std::make_shared<mathop::operations::Xor>()},       {"neg", std::make_shared<mathop::operations::Neg>()},
+                {"not", std::make_shared<mathop::operations::Not>()},       {"lea_add", std::make_shared<mathop::operations::LeaAdd>()},
+                {"rol", std::make_shared<mathop::operations::Rol>()},       {"ror", std::make_shared<mathop::operations::Ror>()},
+                {"bswap", std::make_shared<mathop::operations::Bswap>()},
+            };
+        }
+
+        /// \brief Get the accumulator register for the bit size
+        [[nodiscard]] inline zasm::x86::Gp accumulator(const zasm::BitSize bit_size) {
+            switch (getBitSize(bit_size)) {
+            case 8:
+                return zasm::x86::al;
+            case 16:
+                return zasm::x86::ax;
+            case 32:
+                return zasm::x86::eax;
+            default:
+                return zasm::x86::rax;
+            }
+        }
+    } // namespace detail
+
+    /// \brief Dependent chains of the same mathop operation, measures the latency of a single one
+    [[nodiscard]] inline std::vector<case_t> mathop_operations() {
+        std::vector<case_t> result = {};
+
+        for (const auto& [name, operation] : detail::operations()) {
+            for (const auto bit_size : {zasm::BitSize::_8, zasm::BitSize::_16, zasm::BitSize::_32, zasm::BitSize::_64}) {
+                const auto cost = operation->cost(bit_size);
+                if (!cost.has_value()) {
+                    continue;
+                }
+
+                mathop::Expression expression = {};
+                for (std::size_t i = 0; i < detail::kChainLength; ++i) {
+                    expression.emplace_operation(operation.get(), bit_size);
+                }
+
+                result.emplace_back(case_t{
+                    .name = std::format("mathop/{}/{}", name, getBitSize(bit_size)),
+                    .builder = [operation, expression, bit_size](zasm::Program&, zasm::x86::Assembler* as, zasm::Label) mutable -> void {
+                        expression.lift_revert(as, detail::accumulator(bit_size));
+                    },
+                    .units = detail::kChainLength,
+                    .estimate = static_cast<double>(cost->latency),
+                });
+            }
+        }
+
+        return result;
+    }
+
+    /// \brief Expressions generated with the latency budget
+    [[nodiscard]] inline std::vector<case_t> mathop_budgets() {
+        std::vector<case_t> result = {};
+
+        for (const auto cycles : {4, 8, 16, 32}) {
+            for (const auto bit_size : {zasm::BitSize::_32, zasm::BitSize::_64}) {
+                auto expression = mathop::ExpressionGenerator::get().generate(bit_size, mathop::budget_t{.cycles = static_cast<std::size_t>(cycles)});
+                const auto cost = expression.cost();
+
+                result.emplace_back(case_t{
+                    .name = std::format("mathop_budget/{}/{}", cycles, getBitSize(bit_size)),
+                    .builder = [expression, bit_size](zasm::Program&, zasm::x86::Assembler* as, zasm::Label) mutable -> void {
+                        expression.lift_revert(as, detail::accumulator(bit_size));
+                    },
+                    .estimate = static_cast<double>(cost.latency),
+                });
+            }
+        }
+
+        return result;
+    }
+
+    /// \brief Every opaque predicate
+    [[nodiscard]] inline std::vector<case_t> opaque_predicates() {
+        std::vector<case_t> result = {};
+
+        for (std::size_t i = 0; i < obfuscator::transform_util::kOpaquePredicatesCount; ++i) {
+            result.emplace_back(case_t{
+                .name = std::format("opaque_predicate/{}", i),
+                .builder = [i](zasm::Program&, zasm::x86::Assembler* as, const zasm::Label next) -> void {
+                    analysis::LRUReg<Img> lru_reg = {};
+                    analysis::VarAlloc<Img> var_alloc(&lru_reg);
+                    obfuscator::transform_util::generate_opaque_predicate(as, next, next, &var_alloc, i);
+                },
+            });
+        }
+
+        return result;
+    }
+
+    /// \brief ConstantCrypt decryption with and without the anti symbolic execution sequences
+    [[nodiscard]] inline std::vector<case_t> anti_symbolic_execution() {
+        std::vector<case_t> result = {};
+
+        for (const auto anti_symbolic : {false, true}) {
+            for (const auto bit_size : {zasm::BitSize::_8, zasm::BitSize::_16, zasm::BitSize::_32}) {
+                auto expression = mathop::ExpressionGenerator::get().generate(bit_size, 5);
+
+                result.emplace_back(case_t{
+                    .name = std::format("constant_crypt/{}/{}", anti_symbolic ? "anti_symbolic" : "plain", getBitSize(bit_size)),
+                    .builder = [expression, bit_size, anti_symbolic](zasm::Program& program, zasm::x86::Assembler* as, zasm::Label) mutable -> void {
+                        analysis::LRUReg<Img> lru_reg = {};
+                        analysis::VarAlloc<Img> var_alloc(&lru_reg);
+                        auto var_1 = var_alloc.get_for_bits(bit_size);
+
+                        auto* push_at = as->getCursor();
+                        as->mov(var_1, mathop::imm_to_zasm(expression.emulate(mathop::imm_for_bits(bit_size, 0x1337))));
+                        auto* decryption_start_at = as->getCursor();
+                        expression.lift_revert(as, var_1);
+                        auto* decryption_ends_at = as->getCursor();
+
+                        if (anti_symbolic) {
+                            obfuscator::transform_util::anti_symbolic_execution(var_alloc, bit_size, &program, as, decryption_start_at,
+                                                                                decryption_ends_at);
+                        }
+
+                        /// Save/restore everything around it, just like the transform does
+                        as->setCursor(push_at);
+                        var_alloc.push(as);
+                        var_alloc.push_flags(as);
+                        as->setCursor(program.getTail());
+                        var_alloc.pop_flags(as);
+                        var_alloc.pop(as);
+                    },
+                });
+            }
+        }
+
+        return result;
+    }
+
+    /// \brief Registers/flags spills that are wrapping the ConstantCrypt decryption
+    [[nodiscard]] inline std::vector<case_t> spill_frames() {
+        std::vector<case_t> result = {};
+
+        for (const auto flags : {false, true}) {
+            for (std::size_t regs = 1; regs <= 4; ++regs) {
+                result.emplace_back(case_t{
+                    .name = std::format("spill/{}_regs{}", regs, flags ? "+flags" : ""),
+                    .builder = [regs, flags](zasm::Program&, zasm::x86::Assembler* as, zasm::Label) -> void {
+                        analysis::LRUReg<Img> lru_reg = {};
+                        analysis::VarAlloc<Img> var_alloc(&lru_reg, 0, flags ? analysis::kAllFlags : 0);
+                        for (std::size_t i = 0; i < regs; ++i) {
+                            static_cast<void>(var_alloc.get());
+                        }
+
+                        var_alloc.push(as);
+                        var_alloc.push_flags(as);
+                        var_alloc.pop_flags(as);
+                        var_alloc.pop(as);
+                    },
+                });
+            }
+        }
+
+        return result;
+    }
+} // namespace bench::jit::stubs
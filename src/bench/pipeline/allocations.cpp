@@ -0,0 +1,82 @@
+#include "pipeline/allocations.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace bench::pipeline::allocations {
+    namespace {
+        std::atomic<std::size_t> bytes_ = 0; // NOLINT
+        std::atomic<std::size_t> count_ = 0; // NOLINT
+
+        void* allocate(std::size_t size) {
+            bytes_.fetch_add(size, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+
+            /// malloc(0) is allowed to return null, operator new isn't
+            if (auto* result = std::malloc(size == 0 ? 1 : size); result != nullptr) {
+                return result;
+            }
+            throw std::bad_alloc();
+        }
+
+        void* allocate(std::size_t size, std::align_val_t alignment) {
+            bytes_.fetch_add(size, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+
+            const auto align = static_cast<std::size_t>(alignment);
+            size = (std::max<std::size_t>(size, 1) + align - 1) & ~(align - 1);
+#if defined(_MSC_VER)
+            auto* result = _aligned_malloc(size, align);
+#else
+            auto* result = std::aligned_alloc(align, size);
+#endif
+            if (result != nullptr) {
+                return result;
+            }
+            throw std::bad_alloc();
+        }
+
+        void release_aligned(void* ptr) noexcept {
+#if defined(_MSC_VER)
+            _aligned_free(ptr);
+#else
+            std::free(ptr);
+#endif
+        }
+    } // namespace
+
+    std::size_t bytes() noexcept {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t count() noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+} // namespace bench::pipeline::allocations
+
+/// The nothrow and array versions are forwarded to these by the standard library
+void* operator new(const std::size_t size) {
+    return bench::pipeline::allocations::allocate(size);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return bench::pipeline::allocations::allocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    bench::pipeline::allocations::release_aligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    bench::pipeline::allocations::release_aligned(ptr);
+}
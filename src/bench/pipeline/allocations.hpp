@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+/// \note Global operator new hook, counts every allocation that was made by the benchmark process. It's not scoped by
+/// thread, but the stages are benchmarked on a single thread anyway.
+namespace bench::pipeline::allocations {
+    /// \brief Total number of bytes allocated so far
+    [[nodiscard]] std::size_t bytes() noexcept;
+
+    /// \brief Total number of allocations so far
+    [[nodiscard]] std::size_t count() noexcept;
+
+    /// \brief Allocations that were made between the construction and `stop`
+    class Scope {
+    public:
+        Scope() noexcept: bytes_(bytes()), count_(count()) { }
+
+        /// \brief Stop counting and add the allocations to the totals
+        /// \param total_bytes bytes accumulator
+        /// \param total_count allocations accumulator
+        void stop(std::size_t& total_bytes, std::size_t& total_count) const noexcept {
+            total_bytes += bytes() - bytes_;
+            total_count += count() - count_;
+        }
+
+    private:
+        std::size_t bytes_ = 0;
+        std::size_t count_ = 0;
+    };
+} // namespace bench::pipeline::allocations
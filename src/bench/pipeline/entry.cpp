@@ -0,0 +1,125 @@
+#include "corpus/corpus.hpp"
+#include "obfuscator/transforms/scheduler.hpp"
+#include "pipeline/inputs.hpp"
+#include "pipeline/stages.hpp"
+#include "util/logger.hpp"
+#include "util/random.hpp"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <format>
+#include <memory>
+
+namespace {
+    /// \brief Number of instructions within the synthetic programs
+    constexpr std::array kSyntheticSizes = {std::size_t{1'000}, std::size_t{16'000}, std::size_t{128'000}};
+
+    /// \brief Generated images, the functions are getting bigger and so are the jump tables within them
+    constexpr std::array kCorpusConfigs = {
+        corpus::config_t{.functions = 64, .blocks = 16, .jump_table_fanout = 4, .relocated_immediates = 2},
+        corpus::config_t{.functions = 64, .blocks = 256, .jump_table_fanout = 32, .relocated_immediates = 32},
+        corpus::config_t{.functions = 16, .blocks = 4096, .jump_table_fanout = 256, .relocated_immediates = 512},
+    };
+
+    /// \brief The inputs should outlive the benchmarks
+    std::vector<std::unique_ptr<bench::pipeline::binary_t>> binaries = {}; // NOLINT
+    std::vector<std::shared_ptr<zasm::Program>> programs = {}; // NOLINT
+    std::vector<std::shared_ptr<void>> images = {}; // NOLINT
+
+    /// \brief Register the easm benchmarks
+    /// \param name input name
+    /// \param program program that should be estimated/assembled
+    /// \param base base address
+    void register_program(const std::string& name, const zasm::Program* program, const memory::address base) {
+        benchmark::RegisterBenchmark(std::format("estimate_program_size/{}", name), bench::pipeline::stages::estimate_program_size, program);
+        benchmark::RegisterBenchmark(std::format("assemble_program/{}", name), bench::pipeline::stages::assemble_program, program, base);
+    }
+
+    /// \brief Register the synthetic programs
+    void register_synthetic() {
+        for (const auto machine_mode : {zasm::MachineMode::AMD64, zasm::MachineMode::I386}) {
+            for (const auto size : kSyntheticSizes) {
+                const auto* program = programs.emplace_back(bench::pipeline::synthetic_program(machine_mode, size)).get();
+                const auto name = std::format("synthetic_{}_{}", machine_mode == zasm::MachineMode::AMD64 ? "x64" : "x86", size);
+                register_program(name, program, memory::address{0x140001000ULL});
+            }
+        }
+    }
+
+    /// \brief Register the benchmarks for a binary from the resources
+    /// \tparam Img PE Image type, either x64 or x86
+    /// \param binary binary
+    template <pe::any_image_t Img>
+    void register_binary(bench::pipeline::binary_t* binary) {
+        using namespace bench::pipeline;
+        const auto name = binary->name();
+
+        benchmark::RegisterBenchmark(std::format("pe_parse/{}", name), stages::pe_parse<Img>, binary);
+        benchmark::RegisterBenchmark(std::format("pe_rebuild/{}", name), stages::pe_rebuild<Img>, binary);
+
+        auto image = std::make_shared<image_t<Img>>(*binary);
+        images.emplace_back(image);
+        if (image->functions.empty()) {
+            return;
+        }
+
+        /// The biggest function is the most interesting one
+        const auto& function = image->functions.front();
+        const auto func_name = std::format("{}/{}", name, function.name);
+        logger::info("bench: {}: using {} ({:#x} bytes)", name, function.name, function.size.value_or(0));
+
+        benchmark::RegisterBenchmark(std::format("bb_decomp/{}", func_name), stages::bb_decomp<Img>, image.get(), function);
+        benchmark::RegisterBenchmark(std::format("bb_insn_passes/{}", func_name), stages::bb_insn_passes<Img>, image.get(), function);
+
+        for (const auto& [tag, _] : obfuscator::TransformScheduler::get().for_arch<Img>().transforms) {
+            const auto& transform_name = obfuscator::TransformSharedConfigStorage::get().get_for(tag).name;
+            benchmark::RegisterBenchmark(std::format("transform/{}/{}", transform_name, func_name), stages::transform<Img>, image.get(), function, tag)
+                ->Unit(benchmark::kMillisecond);
+        }
+
+        /// Decoded program of the function, relocated to its original address
+        const auto analysed = analysis::analyse(&image->image, function);
+        const auto* program = programs.emplace_back(analysed.program).get();
+        register_program(func_name, program, memory::address{image->image.raw_image->get_nt_headers()->optional_header.image_base} + function.rva);
+    }
+
+    int startup(int argc, char* argv[]) try {
+        benchmark::Initialize(&argc, argv);
+
+        rnd::detail::seed(0x1337);
+        obfuscator::startup_scheduler();
+
+        /// The remaining argument is the directory with binaries, test resources are used by default
+        const std::filesystem::path resources = argc > 1 ? std::filesystem::path{argv[1]} : std::filesystem::path{OBFUSCATOR_RESOURCES_PATH};
+        binaries = bench::pipeline::discover_binaries(resources);
+        logger::info("bench: found {} binaries in {}", binaries.size(), resources.string());
+
+        for (const auto& config : kCorpusConfigs) {
+            const auto name = std::format("corpus_{}x{}", config.functions, config.blocks);
+            binaries.emplace_back(bench::pipeline::synthetic_binary<win::image_x64_t>(name + "_x64", config));
+            binaries.emplace_back(bench::pipeline::synthetic_binary<win::image_x86_t>(name + "_x86", config));
+        }
+
+        register_synthetic();
+        for (const auto& binary : binaries) {
+            if (binary->x64) {
+                register_binary<pe::X64Image>(binary.get());
+            } else {
+                register_binary<pe::X86Image>(binary.get());
+            }
+        }
+
+        /// We don't want the stages to spam with the progress bars
+        logger::enabled = false;
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return 0;
+    } catch (std::runtime_error& err) {
+        logger::critical("RUNTIME ERROR: {}", err.what());
+        return 1;
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+    return startup(argc, argv);
+}
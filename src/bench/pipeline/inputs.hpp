@@ -0,0 +1,166 @@
+#pragma once
+#include "analysis/analysis.hpp"
+#include "corpus/corpus.hpp"
+#include "func_parser/parser.hpp"
+#include "pe/arch/arch.hpp"
+#include "pe/common/common.hpp"
+#include "util/files.hpp"
+#include "util/logger.hpp"
+#include "util/memory/casts.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench::pipeline {
+    /// \brief PE binary that we've found in the resources
+    struct binary_t {
+        std::filesystem::path path = {};
+        std::vector<std::uint8_t> data = {};
+        bool x64 = false;
+        /// \brief Known functions, the pdb/map lookup is skipped if there are any (used for the generated images)
+        func_parser::function_list_t functions = {};
+
+        /// \brief Get the raw image
+        template <pe::any_raw_image_t Img>
+        [[nodiscard]] Img* raw() {
+            return memory::cast<Img*>(data.data());
+        }
+
+        /// \brief Benchmark name prefix
+        [[nodiscard]] std::string name() const {
+            return path.filename().string();
+        }
+    };
+
+    /// \brief Parsed binary with the functions from its pdb/map, the biggest functions go first
+    /// \tparam Img PE Image type, either x64 or x86
+    template <pe::any_image_t Img>
+    struct image_t {
+        explicit image_t(binary_t& binary): image(binary.raw<pe::to_raw_img_t<Img>>()), functions(binary.functions) {
+            if (!functions.empty()) {
+                sort();
+                return;
+            }
+
+            func_parser::Instance<Img> parser = {};
+            parser.setup(&image, config_parser::func_parser_config_t{.pdb_enabled = true, .map_enabled = true},
+                         config_parser::obfuscator_config_t{.binary_path = binary.path});
+
+            try {
+                parser.collect_functions();
+                functions = parser.functions();
+            } catch (const std::runtime_error& err) {
+                logger::warn("bench: unable to discover functions of {}: {}", binary.name(), err.what());
+            }
+
+            sort();
+        }
+
+        Img image;
+        func_parser::function_list_t functions = {};
+
+    private:
+        void sort() {
+            std::ranges::stable_sort(functions, std::ranges::greater{}, [](const func_parser::function_t& func) -> std::size_t { //
+                return func.size.value_or(0);
+            });
+        }
+    };
+
+    /// \brief Collect the PE binaries from the directory
+    /// \param root directory path
+    /// \return binaries, sorted by their paths
+    [[nodiscard]] inline std::vector<std::unique_ptr<binary_t>> discover_binaries(const std::filesystem::path& root) {
+        std::vector<std::unique_ptr<binary_t>> result = {};
+
+        std::error_code ec = {};
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root, ec)) {
+            if (!entry.is_regular_file() || entry.file_size() < sizeof(win::dos_header_t)) {
+                continue;
+            }
+
+            auto binary = std::make_unique<binary_t>(binary_t{.path = entry.path(), .data = util::read_file(entry.path())});
+            if (binary->data.size() < sizeof(win::dos_header_t) || !pe::common::is_valid(binary->raw<win::image_x64_t>())) {
+                continue;
+            }
+
+            /// Make sure that the nt headers are within the file, there could be some random stuff that starts with `MZ`
+            const auto nt_offset = static_cast<std::size_t>(binary->raw<win::image_x64_t>()->dos_header.e_lfanew);
+            if (nt_offset + sizeof(win::nt_headers_x64_t) > binary->data.size()) {
+                continue;
+            }
+
+            binary->x64 = pe::arch::is_x64(binary->raw<win::image_x64_t>());
+            result.emplace_back(std::move(binary));
+        }
+
+        if (ec) {
+            logger::warn("bench: unable to iterate over {}: {}", root.string(), ec.message());
+        }
+
+        std::ranges::sort(result, {}, [](const std::unique_ptr<binary_t>& binary) -> const std::filesystem::path& { return binary->path; });
+        return result;
+    }
+
+    /// \brief Generate the synthetic image
+    /// \tparam Img Raw image type, either x64 or x86
+    /// \param name binary name
+    /// \param config corpus configuration
+    /// \return binary with the known functions
+    template <pe::any_raw_image_t Img>
+    [[nodiscard]] std::unique_ptr<binary_t> synthetic_binary(const std::string_view name, const corpus::config_t& config) {
+        auto output = corpus::generate<Img>(config);
+        return std::make_unique<binary_t>(binary_t{
+            .path = name,
+            .data = std::move(output.image),
+            .x64 = std::is_same_v<Img, win::image_x64_t>,
+            .functions = std::move(output.functions),
+        });
+    }
+
+    /// \brief Count the instructions within the program
+    [[nodiscard]] inline std::size_t count_instructions(const zasm::Program& program) {
+        std::size_t result = 0;
+        for (const auto* node = program.getHead(); node != nullptr; node = node->getNext()) {
+            result += node->holds<zasm::Instruction>() ? 1 : 0;
+        }
+        return result;
+    }
+
+    /// \brief Generate a program that looks like some regular compiled code, every block consists of 8 instructions
+    /// and ends with a conditional jump to the next one
+    /// \param machine_mode machine mode
+    /// \param insns_count number of instructions
+    /// \return program
+    [[nodiscard]] inline std::unique_ptr<zasm::Program> synthetic_program(const zasm::MachineMode machine_mode, const std::size_t insns_count) {
+        using namespace zasm::x86;
+
+        auto program = std::make_unique<zasm::Program>(machine_mode);
+        Assembler as(*program);
+
+        const std::array regs = {eax, ecx, edx, ebx, esi, edi};
+        const auto sp = machine_mode == zasm::MachineMode::AMD64 ? Gp(rsp) : Gp(esp);
+        for (std::size_t i = 0; i < insns_count; i += 8) {
+            const auto& dst = regs[i % regs.size()];
+            const auto& src = regs[(i + 1) % regs.size()];
+            const auto next = as.createLabel();
+
+            as.mov(dst, zasm::Imm(static_cast<std::int32_t>(i * 0x1337)));
+            as.add(dst, src);
+            as.xor_(dword_ptr(sp, 0x10), dst);
+            as.lea(src, dword_ptr(sp, 0x20));
+            as.imul(dst, src, zasm::Imm(3));
+            as.mov(dword_ptr(sp, 0x14), src);
+            as.cmp(dst, zasm::Imm(0x100));
+            as.jnz(next);
+            as.bind(next);
+        }
+
+        return program;
+    }
+} // namespace bench::pipeline
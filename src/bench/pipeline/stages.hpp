@@ -0,0 +1,199 @@
+#pragma once
+#include "analysis/analysis.hpp"
+#include "analysis/passes/misc/bb_insn_passes.hpp"
+#include "easm/assembler/assembler.hpp"
+#include "obfuscator/function.hpp"
+#include "obfuscator/transforms/scheduler.hpp"
+#include "pipeline/allocations.hpp"
+#include "pipeline/inputs.hpp"
+#include "util/random.hpp"
+
+#include <benchmark/benchmark.h>
+#include <optional>
+
+/// \note Every stage is benchmarked in isolation, the inputs that the stage needs are prepared outside of the
+/// timed region. Throughput is reported in instructions (or bytes for the PE stuff) and the allocations are reported per
+/// iteration, counted only within the timed region too.
+namespace bench::pipeline::stages {
+    namespace detail {
+        /// \brief Accumulated allocations of the timed regions
+        struct allocated_t {
+            std::size_t bytes = 0;
+            std::size_t count = 0;
+        };
+
+        /// \brief Run the timed region and count its allocations
+        template <typename Fn>
+        void timed(allocated_t& allocated, Fn&& fn) {
+            const allocations::Scope scope = {};
+            fn();
+            scope.stop(allocated.bytes, allocated.count);
+        }
+
+        /// \brief Set the throughput and allocation counters
+        /// \param state benchmark state
+        /// \param insns number of instructions processed per iteration
+        /// \param allocated allocations of the timed regions
+        inline void report(benchmark::State& state, const std::size_t insns, const allocated_t& allocated) {
+            const auto iterations = static_cast<double>(state.iterations());
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(insns));
+            state.counters["insns"] = static_cast<double>(insns);
+            state.counters["per_1k_insns"] = benchmark::Counter(iterations * static_cast<double>(insns) / 1000.,
+                                                                benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+            state.counters["bytes_allocated"] = benchmark::Counter(static_cast<double>(allocated.bytes), benchmark::Counter::kAvgIterations,
+                                                                   benchmark::Counter::kIs1024);
+            state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocated.count), benchmark::Counter::kAvgIterations);
+        }
+
+        /// \brief Count the instructions within the analysed function
+        template <pe::any_image_t Img>
+        [[nodiscard]] std::size_t count_instructions(const analysis::Function<Img>& function) {
+            std::size_t result = 0;
+            function.bb_storage->iter_bbs([&result](const analysis::bb_t& bb) -> void { result += bb.size(); });
+            return result;
+        }
+    } // namespace detail
+
+    /// \brief `bb_decomp::Instance` construction, which is the decoding and the cfg building
+    template <pe::any_image_t Img>
+    void bb_decomp(benchmark::State& state, image_t<Img>* image, const func_parser::function_t& function) {
+        const auto insns = detail::count_instructions(analysis::analyse(&image->image, function));
+
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                analysis::bb_decomp::Instance<Img> instance(&image->image, function.rva, function.size);
+                benchmark::DoNotOptimize(instance);
+            });
+        }
+
+        detail::report(state, insns, allocated);
+    }
+
+    /// \brief `bb_insn_passes_t`, the passes are re-applied to the same function over and over
+    template <pe::any_image_t Img>
+    void bb_insn_passes(benchmark::State& state, image_t<Img>* image, const func_parser::function_t& function) {
+        auto analysed = analysis::analyse(&image->image, function);
+        const auto insns = detail::count_instructions(analysed);
+
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                benchmark::DoNotOptimize(analysis::passes::bb_insn_passes_t<Img>::apply(&analysed, &image->image)); //
+            });
+        }
+
+        detail::report(state, insns, allocated);
+    }
+
+    /// \brief Run the transform on a freshly analysed function, the chances are ignored and everything is applied once
+    template <pe::any_image_t Img>
+    void transform(benchmark::State& state, image_t<Img>* image, const func_parser::function_t& function, const obfuscator::TransformTag tag) {
+        auto& transform = *obfuscator::TransformScheduler::get().for_arch<Img>().transforms.at(tag);
+        auto& config = obfuscator::TransformSharedConfigStorage::get().get_for(tag);
+
+        std::size_t insns = 0;
+        detail::allocated_t allocated = {};
+        std::optional<analysis::Function<Img>> analysed = std::nullopt;
+        std::optional<obfuscator::Function<Img>> obf_func = std::nullopt;
+        std::optional<rnd::Stream> stream = std::nullopt;
+        for (auto _ : state) {
+            /// Transforms are modifying the function, so every iteration needs its own copy. The previous one is
+            /// released here too, so that its destruction doesn't end up in the timed region
+            state.PauseTiming();
+            obf_func.reset();
+            analysed.reset();
+            analysed.emplace(&image->image, function);
+            obf_func.emplace(*analysed, &image->image);
+            insns = detail::count_instructions(*analysed);
+            stream.reset();
+            stream.emplace(function.name, tag);
+            state.ResumeTiming();
+
+            detail::timed(allocated, [&]() -> void {
+                auto ctx = obfuscator::TransformContext(config);
+                if (transform.feature(obfuscator::TransformFeaturesSet::HAS_FUNCTION_TRANSFORM)) {
+                    transform.run_on_function(ctx, &*obf_func);
+                }
+
+                if (transform.feature(obfuscator::TransformFeaturesSet::HAS_BB_TRANSFORM)) {
+                    for (auto& basic_block : obf_func->bb_storage->temp_copy()) {
+                        transform.run_on_bb(ctx, &*obf_func, basic_block);
+                    }
+                }
+
+                if (transform.feature(obfuscator::TransformFeaturesSet::HAS_INSN_TRANSFORM)) {
+                    for (auto& basic_block : obf_func->bb_storage->temp_copy()) {
+                        for (auto& insn : basic_block->temp_insns_copy()) {
+                            transform.run_on_insn(ctx, &*obf_func, insn);
+                        }
+                    }
+                }
+
+                if (transform.feature(obfuscator::TransformFeaturesSet::HAS_NODE_TRANSFORM)) {
+                    for (auto* node = obf_func->program->getHead(); node != nullptr; node = node->getNext()) {
+                        transform.run_on_node(ctx, &*obf_func, node);
+                    }
+                }
+            });
+        }
+
+        detail::report(state, insns, allocated);
+    }
+
+    /// \brief `easm::estimate_program_size`
+    inline void estimate_program_size(benchmark::State& state, const zasm::Program* program) {
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                benchmark::DoNotOptimize(easm::estimate_program_size(*program)); //
+            });
+        }
+
+        detail::report(state, count_instructions(*program), allocated);
+    }
+
+    /// \brief `easm::assemble_program`
+    inline void assemble_program(benchmark::State& state, const zasm::Program* program, const memory::address base) {
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                benchmark::DoNotOptimize(easm::assemble_program(base, *program)); //
+            });
+        }
+
+        detail::report(state, count_instructions(*program), allocated);
+    }
+
+    /// \brief `pe::Image` construction, which is the sections and relocations parsing
+    template <pe::any_image_t Img>
+    void pe_parse(benchmark::State& state, binary_t* binary) {
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                Img image(binary->raw<pe::to_raw_img_t<Img>>());
+                benchmark::DoNotOptimize(image);
+            });
+        }
+
+        detail::report(state, 0, allocated);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(binary->data.size()));
+    }
+
+    /// \brief `rebuild_pe` of the unmodified image
+    template <pe::any_image_t Img>
+    void pe_rebuild(benchmark::State& state, binary_t* binary) {
+        Img image(binary->raw<pe::to_raw_img_t<Img>>());
+
+        detail::allocated_t allocated = {};
+        for (auto _ : state) {
+            detail::timed(allocated, [&]() -> void {
+                benchmark::DoNotOptimize(image.rebuild_pe_image()); //
+            });
+        }
+
+        detail::report(state, 0, allocated);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(binary->data.size()));
+    }
+} // namespace bench::pipeline::stages
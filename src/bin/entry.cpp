@@ -5,7 +5,12 @@
 #include "pe/common/common.hpp"
 #include "util/files.hpp"
 #include "util/logger.hpp"
+#include "util/memory/accounting.hpp"
 #include "util/random.hpp"
+#include "util/trace.hpp"
+
+#include <ranges>
+#include <string_view>
 
 namespace {
     template <pe::any_raw_image_t Img>
@@ -21,6 +26,28 @@ namespace {
         logger::info("startup: bye-bye");
     }
 
+    /// \brief Print the top memory consumers, if the accounting is compiled in
+    void report_memory() {
+        constexpr std::size_t kTop = 16;
+        if (!memory::accounting::enabled()) {
+            return;
+        }
+
+        const auto report = memory::accounting::report();
+        auto print = [](const std::string_view kind, const memory::accounting::usage_t& usage) -> void {
+            logger::info("memory: {} {:<32} peak: {:>10} KiB | retained: {:>10} KiB | allocated: {:>12} KiB in {} allocations", kind,
+                         usage.name, usage.peak / 1024, usage.retained / 1024, usage.allocated / 1024, usage.allocations);
+        };
+
+        print("total   ", report.total);
+        for (const auto& stage : report.stages | std::views::take(kTop)) {
+            print("stage   ", stage);
+        }
+        for (const auto& function : report.functions | std::views::take(kTop)) {
+            print("function", function);
+        }
+    }
+
     int startup(const int argc, char* argv[]) try {
         rnd::detail::seed();
         obfuscator::startup_scheduler();
@@ -28,9 +55,14 @@ namespace {
         auto config = config_parser::from_argv(argc, argv);
 
         const auto binary_path = config.obfuscator_config().binary_path;
+        const auto trace_path = config.obfuscator_config().trace_path;
+        if (trace_path.has_value()) {
+            util::trace::enable();
+        }
 
+        /// Sections are referencing the mapped file until they're modified, so it should outlive the image
         logger::info("main: loading binary from {}", binary_path.string());
-        auto file = util::read_file(binary_path);
+        const util::MappedFile file(binary_path);
         if (file.empty()) {
             throw std::runtime_error("Got empty binary");
         }
@@ -50,6 +82,13 @@ namespace {
             bootstrap(img_x86, config);
         }
 
+        if (trace_path.has_value()) {
+            util::trace::save(*trace_path);
+            logger::info("main: saved trace to {}", trace_path->string());
+        }
+
+        report_memory();
+
         return 0;
     } catch (std::runtime_error& err) {
         logger::critical("RUNTIME ERROR: {}", err.what());
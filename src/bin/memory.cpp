@@ -0,0 +1,159 @@
+#if defined(OBFUSCATOR_MEMORY_ACCOUNTING)
+#include "util/memory/accounting.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/// \note Global operator new hook for the allocation accounting. Every allocation gets a header right before it
+/// with the owner that it was accounted to, so that it could be subtracted from the same scope once it's released
+namespace {
+    struct header_t {
+        void* base = nullptr;
+        memory::accounting::owner_t owner = {};
+        std::size_t size = 0;
+    };
+
+    constexpr std::size_t kMinAlignment = alignof(std::max_align_t);
+
+    [[nodiscard]] constexpr std::size_t align_up(const std::size_t value, const std::size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    void* allocate(const std::size_t size, const std::size_t alignment) {
+        const auto align = std::max(alignment, kMinAlignment);
+        const auto offset = align_up(sizeof(header_t), align);
+        const auto total = align_up(offset + std::max<std::size_t>(size, 1), align);
+
+#if defined(_MSC_VER)
+        auto* base = static_cast<std::uint8_t*>(_aligned_malloc(total, align));
+#else
+        auto* base = static_cast<std::uint8_t*>(std::aligned_alloc(align, total));
+#endif
+        if (base == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        auto* result = base + offset;
+        *(reinterpret_cast<header_t*>(result) - 1) = header_t{
+            .base = base,
+            .owner = memory::accounting::on_alloc(size),
+            .size = size,
+        };
+        return result;
+    }
+
+    void* try_allocate(const std::size_t size, const std::size_t alignment) noexcept {
+        try {
+            return allocate(size, alignment);
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    void release(void* ptr) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+
+        const auto* header = static_cast<header_t*>(ptr) - 1;
+        memory::accounting::on_free(header->owner, header->size);
+
+#if defined(_MSC_VER)
+        _aligned_free(header->base);
+#else
+        std::free(header->base);
+#endif
+    }
+
+    /// Start accounting right away, everything that is allocated before the first scope goes to the unscoped entry
+    [[maybe_unused]] const auto kEnabled = []() -> bool {
+        memory::accounting::enable();
+        return true;
+    }();
+} // namespace
+
+/// Every replaceable version is replaced, as some of the runtimes don't forward the nothrow/array versions to the
+/// regular ones and we can't release the allocations that don't have our header
+void* operator new(const std::size_t size) {
+    return allocate(size, kMinAlignment);
+}
+
+void* operator new[](const std::size_t size) {
+    return allocate(size, kMinAlignment);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept {
+    return try_allocate(size, kMinAlignment);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept {
+    return try_allocate(size, kMinAlignment);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return try_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return try_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+#endif
@@ -2,6 +2,8 @@
 #include "util/passes.hpp"
 
 #include "analysis/passes/label_references.hpp"
+#include "analysis/passes/liveness.hpp"
+#include "analysis/passes/loops.hpp"
 #include "analysis/passes/misc/bb_insn_passes.hpp"
 
 namespace analysis {
@@ -13,7 +15,9 @@ namespace analysis {
         //
         ::passes::apply< //
             passes::bb_insn_passes_t<Img>, //
-            passes::label_references_t<Img> //
+            passes::label_references_t<Img>, //
+            passes::loops_t<Img>, //
+            passes::liveness_t<Img> //
             >(this, image);
     }
 
@@ -4,9 +4,10 @@
 #include "analysis/lru_reg/lru_reg.hpp"
 #include "func_parser/parser.hpp"
 #include "observer/observer.hpp"
+#include "util/trace.hpp"
 #include "util/types.hpp"
 
-#include <list>
+#include <vector>
 
 namespace analysis {
     template <pe::any_image_t Img>
@@ -23,63 +24,51 @@ namespace analysis {
             bb_provider = std::make_shared<functional_bb_provider_t>();
 
             /// Set RVA finder
-            bb_provider->set_rva_finder([storage = bb_storage.get()](const rva_t rva, bb_t*) -> std::optional<std::shared_ptr<bb_t>> {
-                /// Find by RVA
-                auto it = std::ranges::find_if(storage->basic_blocks, [rva](auto&& bb) -> bool {
-                    return bb->start_rva.has_value() && bb->start_rva.value() == rva; //
-                });
-
-                /// Return wrapped in optional
-                return it == std::end(storage->basic_blocks) ? std::nullopt : std::make_optional(*it);
+            bb_provider->set_rva_finder([storage = bb_storage.get()](const rva_t rva, bb_t*) -> std::optional<bb_t*> {
+                return storage->find_by_start_rva(rva); //
             });
 
             /// Set VA finder
             bb_provider->set_va_finder([img_base = image->raw_image->get_nt_headers()->optional_header.image_base,
-                                        provider = bb_provider.get()](const rva_t va, bb_t* callee) -> std::optional<std::shared_ptr<bb_t>> {
+                                        provider = bb_provider.get()](const rva_t va, bb_t* callee) -> std::optional<bb_t*> {
                 /// Substract base and find by RVA
                 return provider->find_by_start_rva(va - img_base, callee); //
             });
 
             /// Set Label finder
-            bb_provider->set_label_finder([storage = bb_storage.get()](const zasm::Label* label, bb_t*) -> std::optional<std::shared_ptr<bb_t>> {
-                for (auto& bb : storage->basic_blocks) {
-                    /// Continue if bb doesn't contain this label
-                    if (!bb->contains_label(label->getId())) {
-                        continue;
-                    }
-
-                    return bb;
-                }
-
-                return std::nullopt;
+            bb_provider->set_label_finder([storage = bb_storage.get()](const zasm::Label* label, bb_t*) -> std::optional<bb_t*> {
+                return storage->find_by_label(label->getId()); //
             });
 
             /// Set reference acquire callback
-            bb_provider->set_ref_acquire([storage = bb_storage.get()](const bb_t* bb) -> std::optional<std::shared_ptr<bb_t>> {
-                /// Try to find by ptr
-                auto it = std::ranges::find_if(storage->basic_blocks, [bb](const auto& p) -> bool {
-                    return p.get() == bb; //
-                });
-
-                /// Not found
-                if (it == std::end(storage->basic_blocks)) {
-                    return std::nullopt;
-                }
-
-                /// Found
-                return std::make_optional(*it);
+            bb_provider->set_ref_acquire([storage = bb_storage.get()](const bb_t* bb) -> std::optional<bb_t*> {
+                return storage->acquire_ref(bb); //
             });
 
             assembler = std::make_shared<zasm::x86::Assembler>(*program);
             observer = std::make_shared<Observer>(program, bb_storage, bb_provider);
 
+            const util::trace::Span _("analysis: passes");
             apply_passes(image);
         }
 
         ~Function() = default;
         Function(const Function& instance)
             : program(instance.program), assembler(instance.assembler), observer(instance.observer), bb_storage(instance.bb_storage),
-              parsed_func(instance.parsed_func), range(instance.range), lru_reg(instance.lru_reg), bb_provider(instance.bb_provider) { }
+              parsed_func(instance.parsed_func), range(instance.range), lru_reg(instance.lru_reg), consumed_relocations(instance.consumed_relocations),
+              bb_provider(instance.bb_provider) { }
+
+        /// \brief Release all the analysis state at once, the function shouldn't be used after this
+        /// \note Should be called once the function is linked
+        void release() {
+            observer.reset();
+            bb_provider.reset();
+            image_references.clear();
+            instructions_lookup.clear();
+            bb_storage.reset();
+            assembler.reset();
+            program.reset();
+        }
 
     private:
         void apply_passes(Img* image);
@@ -92,7 +81,7 @@ namespace analysis {
         std::shared_ptr<zasm::x86::Assembler> assembler;
         std::shared_ptr<Observer> observer;
 
-        // A list of split basic blocks
+        // A list of split basic blocks, it also owns all the instructions and labels
         //
         std::shared_ptr<bb_storage_t> bb_storage;
 
@@ -111,13 +100,18 @@ namespace analysis {
         // A list of references within the image, key is the instruction and value is RVA
         // it referenced
         //
-        std::unordered_map<rva_t, std::list<insn_t*>> image_references;
+        std::unordered_map<rva_t, std::vector<insn_t*>> image_references;
 
         // A lookup table with key set to insn rva and value is the ptr to insn info,
-        // \fixme: @es3n1n: ptr could be invalid at some point
+        // ptrs are owned by the bb storage
         //
         std::unordered_map<rva_t, insn_t*> instructions_lookup = {};
 
+        // A list of PE relocations that were consumed by instructions of this function, they
+        // should be erased from the image by the owner once the analysis is done
+        //
+        std::vector<rva_t> consumed_relocations = {};
+
         // BB Provider
         //
         std::shared_ptr<functional_bb_provider_t> bb_provider = {};
@@ -125,6 +119,7 @@ namespace analysis {
 
     template <pe::any_image_t Img>
     Function<Img> analyse(Img* image, const func_parser::function_t& function) {
+        const util::trace::Span _("analysis", function.name);
         auto result = Function<Img>(image, function);
         logger::debug("analysis: analysed function {}", function);
         return result;
@@ -1,6 +1,7 @@
 #include "analysis/bb_decomp/bb_decomp.hpp"
 #include "analysis/common/debug.hpp"
 #include "util/logger.hpp"
+#include "util/trace.hpp"
 
 namespace analysis::bb_decomp {
     template <pe::any_image_t Img>
@@ -24,92 +25,74 @@ namespace analysis::bb_decomp {
         });
 
         // Ref acquire
-        bb_provider_->set_ref_acquire([this](const bb_t* bb) -> std::optional<std::shared_ptr<bb_t>> {
-            /// Try to find in basic_blocks_ first
-            auto it = std::ranges::find_if(basic_blocks_, [bb](const auto& pair) -> bool {
-                return pair.second.get() == bb; //
-            });
-            if (it != std::end(basic_blocks_)) {
-                return it->second;
-            }
-
-            /// Try to find in virtual basic blocks
-            auto vit = std::ranges::find_if(virtual_basic_blocks_, [bb](const auto& value) -> bool {
-                return value.get() == bb; //
-            });
-            if (vit != std::end(virtual_basic_blocks_)) {
-                return *vit;
-            }
-
-            /// Not found :shrug:
-            return std::nullopt;
+        bb_provider_->set_ref_acquire([this](const bb_t* bb) -> std::optional<bb_t*> {
+            return bb_storage_->acquire_ref(bb); //
         });
 
         // Label finder
-        bb_provider_->set_label_finder([this](const zasm::Label* label, bb_t*) -> std::optional<std::shared_ptr<bb_t>> {
-            // Searching in basic blocks with rvas first
-            for (auto& bb : std::views::values(basic_blocks_)) {
-                if (!bb->contains_label(label->getId())) {
-                    continue;
-                }
-
-                return bb;
-            }
-
-            // Searching in virtual basic blocks
-            for (auto& bb : virtual_basic_blocks_) {
-                if (!bb->contains_label(label->getId())) {
-                    continue;
-                }
-
-                return bb;
-            }
-
-            // Not found
-            return std::nullopt;
+        bb_provider_->set_label_finder([this](const zasm::Label* label, bb_t*) -> std::optional<bb_t*> {
+            return bb_storage_->find_by_label(label->getId()); //
         });
 
         // Starting with the first basic block, and it will process others automatically
         //
         logger::info("bb_decomp: running phase 1");
-        process_bb(function_start_);
+        {
+            const util::trace::Span _("bb_decomp: phase 1 (decode)");
+            process_bb(function_start_);
+        }
 
         // Expand jumptables
         //
         logger::info("bb_decomp: running phase 2");
-        collect_jumptables();
-        collect_jumptable_entries();
+        {
+            const util::trace::Span _("bb_decomp: phase 2 (jump tables)");
+            collect_jumptables();
+            collect_jumptable_entries();
+        }
 
         // Splitting basic blocks (pt.1)
         //
         logger::info("bb_decomp: running phase 3");
-        split();
-        update_refs();
+        {
+            const util::trace::Span _("bb_decomp: phase 3 (split)");
+            split();
+            update_refs();
+        }
 
         // Expand jumptables and split basic blocks one more time
         //
         logger::info("bb_decomp: running phase 4");
-        expand_jumptables();
-        update_rescheduled_cf();
-        update_refs();
-        split();
+        {
+            const util::trace::Span _("bb_decomp: phase 4 (expand jump tables)");
+            expand_jumptables();
+            update_rescheduled_cf();
+            update_refs();
+            split();
+        }
 
         // Insert jmps to successors
         //
         logger::info("bb_decomp: running phase 5");
-        update_refs();
-        insert_jmps();
+        {
+            const util::trace::Span _("bb_decomp: phase 5 (insert jmps)");
+            update_refs();
+            insert_jmps();
+        }
 
         // Sanitizing blocks
         //
         logger::info("bb_decomp: running phase 6");
-        sanitize();
-        update_tree();
+        {
+            const util::trace::Span _("bb_decomp: phase 6 (sanitize)");
+            sanitize();
+            update_tree();
+        }
         // dump();
     }
 
     template <pe::any_image_t Img>
-    std::shared_ptr<bb_t> Instance<Img>::process_bb(const rva_t rva) {
+    bb_t* Instance<Img>::process_bb(const rva_t rva) {
         // Initialising stuff
         // \fixme: @es3n1n: override `get_nt_headers` in `pe::Image` class
         const std::uint64_t image_base = image_->raw_image->get_nt_headers()->optional_header.image_base;
@@ -185,7 +168,7 @@ namespace analysis::bb_decomp {
         std::unordered_map<insn_t*, bb_t*> insns = {};
         for (auto& bb : std::views::values(basic_blocks_)) {
             for (auto& insn : *bb) {
-                insns[insn.get()] = bb.get();
+                insns[insn] = bb;
             }
         }
 
@@ -225,7 +208,9 @@ namespace analysis::bb_decomp {
             logger::warn("bb_decomp: got {} outdated nodes while updating refs", insns.size());
 
             for (auto& [insn, bb] : insns) {
-                std::erase_if(bb->instructions, [insn](const std::shared_ptr<insn_t>& item) -> bool { return item.get() == insn; });
+                if (bb->instructions.contains(insn)) {
+                    bb->instructions.erase(bb->instructions.iterator_to(insn));
+                }
             }
         }
     }
@@ -272,7 +257,7 @@ namespace analysis::bb_decomp {
 
                     // Iterating over instructions and shrinking the ones that we already have in our BB
                     //
-                    std::erase_if(bb_2->instructions, [this, bb](const std::shared_ptr<insn_t>& insn) -> bool {
+                    bb_2->instructions.erase_if([this, bb](insn_t* insn) -> bool {
                         // Removing `bb` instructions from the `bb_2`
                         //
                         // const bool should_remove = std::ranges::find_if(bb, [insn](const insn_t& insn2) -> bool {
@@ -303,7 +288,7 @@ namespace analysis::bb_decomp {
 
                     // Updating successors of the basic block that contains instructions from the `bb_2`
                     //
-                    for (auto& successor : bb_2->successors) {
+                    for (auto* successor : bb_2->successors()) {
                         bb->push_successor(successor);
                     }
 
@@ -313,7 +298,7 @@ namespace analysis::bb_decomp {
 
                     // Since we merged the successors from this list we can clear it and set to the `bb`
                     //
-                    bb_2->successors.clear();
+                    bb_2->clear_successors();
                     bb_2->push_successor(bb);
 
                     // Exit from loop
@@ -332,8 +317,9 @@ namespace analysis::bb_decomp {
 
     template <pe::any_image_t Img>
     void Instance<Img>::sanitize() {
-        const auto erased_bbs = std::erase_if(basic_blocks_, [](auto& basic_block) -> bool {
-            const auto nodes_erased = std::erase_if(basic_block.second->instructions, [](auto& insn) -> bool {
+        std::unordered_set<const bb_t*> erased = {};
+        const auto erased_bbs = std::erase_if(basic_blocks_, [&erased](auto& basic_block) -> bool {
+            const auto nodes_erased = basic_block.second->instructions.erase_if([](insn_t* insn) -> bool {
                 return insn->flags & TO_BE_REMOVED; //
             });
 
@@ -341,10 +327,16 @@ namespace analysis::bb_decomp {
                 logger::debug("bb_decomp: sanitized {} nodes", nodes_erased);
             }
 
-            return !basic_block.second->flags.valid;
+            if (basic_block.second->flags.valid) {
+                return false;
+            }
+
+            erased.emplace(basic_block.second);
+            return true;
         });
 
         if (erased_bbs > 0) {
+            bb_storage_->erase_if([&erased](const bb_t& basic_block) -> bool { return erased.contains(&basic_block); });
             logger::debug("bb_decomp: sanitized {} basic blocks", erased_bbs);
         }
     }
@@ -358,7 +350,7 @@ namespace analysis::bb_decomp {
                 continue;
             }
 
-            auto& last_insn = bb->instructions.at(bb->size() - 1);
+            const auto& last_insn = bb->instructions.back();
             const auto last_mnemonic = last_insn->ref->getMnemonic().value();
 
             /// Looks legit, i think?
@@ -381,12 +373,12 @@ namespace analysis::bb_decomp {
                     return false;
                 }
             });
-            auto* expected_next_bb = expected_cf_next_bb != std::end(last_insn->cf) ? expected_cf_next_bb->bb.get() : nullptr;
+            auto* expected_next_bb = expected_cf_next_bb != std::end(last_insn->cf) ? expected_cf_next_bb->bb : nullptr;
 
             /// If we didn't find it via CF info, then try to get the first successor
             if (expected_next_bb == nullptr) {
-                assert(bb->successors.size() == 1);
-                expected_next_bb = bb->successors.at(0).get();
+                assert(bb->successors().size() == 1);
+                expected_next_bb = bb->successors().front();
             }
 
             /// Let's see if we end up on a successor after this node
@@ -410,7 +402,7 @@ namespace analysis::bb_decomp {
                 }
 
                 /// Verify that the next BB is the expected one
-                if (expected_next_bb == next_bb->second.get()) {
+                if (expected_next_bb == next_bb->second) {
                     continue;
                 }
             }
@@ -441,7 +433,7 @@ namespace analysis::bb_decomp {
         /// Iterating over the all basic blocks
         for (auto& bb : std::views::values(basic_blocks_)) {
             /// Trying to find the insn with CF changers
-            const auto& last_insn = bb->instructions.at(bb->size() - 1);
+            const auto& last_insn = bb->instructions.back();
 
             /// No CF info
             if (last_insn->cf.empty()) {
@@ -461,7 +453,7 @@ namespace analysis::bb_decomp {
 
                 /// Discovering BB by VA
                 if (cf_changer.rescheduled_va.has_value()) {
-                    auto new_bb = bb_provider_->find_by_start_va(cf_changer.rescheduled_va.value(), bb.get());
+                    auto new_bb = bb_provider_->find_by_start_va(cf_changer.rescheduled_va.value(), bb);
                     assert(new_bb.has_value());
                     cf_changer.bb = new_bb.value();
                     continue;
@@ -492,16 +484,22 @@ namespace analysis::bb_decomp {
         /// issues since we merged successors/predecessors list and it could
         /// contain some multiple "dead" nodes, that we should update manually
 
-        /// Step 0. Clear all predecessors info
-        /// We cannot do this in the Step 1
-        for (auto& bb : std::views::values(basic_blocks_)) {
-            bb->predecessors.clear();
-        }
+        /// Step 0. Remove all the "outdated" info, within a single pass over the edges
+        const auto is_tracked = [this](const bb_t& bb) -> bool {
+            if (!bb.start_rva.has_value()) {
+                return false;
+            }
+
+            const auto it = basic_blocks_.find(*bb.start_rva);
+            return it != std::end(basic_blocks_) && it->second == &bb;
+        };
+        bb_storage_->clear_predecessors_if(is_tracked);
+        bb_storage_->clear_successors_if(is_tracked);
 
         /// Step 1. Updating successors
         for (auto& [start, bb] : basic_blocks_) {
-            /// Remove all the "outdated" info
-            bb->successors.clear();
+            /// Whether the CF changer has already linked the successors
+            bool has_successors = false;
 
             /// Looking for the dead CF changer refs
             /// (because since we're splitting them, the dst bb could've been already deleted at some point)
@@ -531,17 +529,18 @@ namespace analysis::bb_decomp {
                     cf_changer.bb = bb_it->second;
 
                     /// Remember this BB as a successor
-                    bb->successors.emplace_back(cf_changer.bb);
+                    bb->push_successor(cf_changer.bb);
+                    has_successors = true;
                 }
                 break;
             }
 
             /// If it wasn't already initialized by the CF changer
-            if (bb->successors.empty()) {
+            if (!has_successors) {
                 /// "Linear" CF
 
                 /// Looking up for the next BBs
-                auto* last_node = bb->instructions.at(bb->size() - 1)->node_ref->getNext();
+                auto* last_node = bb->instructions.back()->node_ref->getNext();
                 while (last_node != nullptr && !last_node->holds<zasm::Instruction>()) {
                     last_node = last_node->getNext();
                 }
@@ -555,12 +554,14 @@ namespace analysis::bb_decomp {
                 const auto* analysis_info = last_node->getUserData<insn_t>();
                 auto acquired_bb = bb_provider_->acquire_ref(analysis_info->bb_ref);
                 assert(acquired_bb.has_value());
-                bb->successors.emplace_back(acquired_bb.value());
+                bb->push_successor(acquired_bb.value());
             }
+        }
 
-            /// Iterating over the successors and updating predecessors in successors
-            for (const auto& successor : bb->successors) {
-                successor->predecessors.emplace_back(bb);
+        /// Step 2. Iterating over the successors and updating predecessors in successors
+        for (auto* bb : std::views::values(basic_blocks_)) {
+            for (auto* successor : bb->successors()) {
+                successor->push_predecessor(bb);
             }
         }
     }
@@ -5,6 +5,7 @@
 
 #include <optional>
 #include <ranges>
+#include <unordered_set>
 #include <vector>
 
 namespace analysis::bb_decomp {
@@ -16,7 +17,7 @@ namespace analysis::bb_decomp {
         Instance(Img* image, const rva_t rva, const std::optional<std::size_t> function_size = std::nullopt)
             : image_(image), function_start_(rva), function_size_(function_size), program_(std::make_shared<zasm::Program>(image->guess_machine_mode())),
               assembler_(std::make_shared<zasm::x86::Assembler>(*program_)), decoder_(easm::Decoder(image_->guess_machine_mode())),
-              bb_provider_(std::make_shared<functional_bb_provider_t>()) {
+              bb_provider_(std::make_shared<functional_bb_provider_t>()), bb_storage_(std::make_shared<bb_storage_t>()) {
             collect();
         }
         ~Instance() = default;
@@ -24,7 +25,7 @@ namespace analysis::bb_decomp {
         Instance(const Instance& instance)
             : image_(instance.image_), function_start_(instance.function_start_), function_size_(instance.function_size_),
               basic_blocks_(instance.basic_blocks_), program_(std::move(instance.program_)), assembler_(std::move(instance.assembler_)),
-              decoder_(instance.decoder_), jump_tables_(instance.jump_tables_), bb_provider_(instance.bb_provider_) { }
+              decoder_(instance.decoder_), jump_tables_(instance.jump_tables_), bb_provider_(instance.bb_provider_), bb_storage_(instance.bb_storage_) { }
 
         void collect();
         void split();
@@ -33,18 +34,20 @@ namespace analysis::bb_decomp {
         [[maybe_unused]] void dump(); // to stdout
         [[maybe_unused]] void dump_to_visualizer(); // to visualizer script dir
 
-        void clear() noexcept {
+        void clear() {
             basic_blocks_.clear();
+            virtual_basic_blocks_.clear();
+            bb_storage_ = std::make_shared<bb_storage_t>();
         }
 
-        [[nodiscard]] std::vector<std::shared_ptr<bb_t>> export_raw_blocks() const {
+        [[nodiscard]] std::vector<bb_t*> export_raw_blocks() const {
             auto result = basic_blocks_ | std::ranges::views::values | std::ranges::to<std::vector>();
             result.insert(result.end(), virtual_basic_blocks_.begin(), virtual_basic_blocks_.end());
             return result;
         }
 
         [[nodiscard]] std::shared_ptr<bb_storage_t> export_blocks() const {
-            return std::make_shared<bb_storage_t>(export_raw_blocks());
+            return bb_storage_;
         }
 
         [[nodiscard]] std::shared_ptr<zasm::Program> export_program() {
@@ -52,7 +55,7 @@ namespace analysis::bb_decomp {
         }
 
     private:
-        std::shared_ptr<bb_t> process_bb(rva_t rva);
+        bb_t* process_bb(rva_t rva);
         void update_refs();
         void insert_jmps();
         void update_tree();
@@ -63,17 +66,17 @@ namespace analysis::bb_decomp {
         void collect_jumptable_entries();
         void expand_jumptables();
 
-        std::shared_ptr<bb_t> make_successor(const rva_t successor, const bb_t* predecessor) {
+        bb_t* make_successor(const rva_t successor, const bb_t* predecessor) {
             const auto predecssor_ref = bb_provider_->acquire_ref(predecessor);
             assert(predecssor_ref.has_value());
             return make_successor(successor, predecssor_ref.value());
         }
 
-        std::shared_ptr<bb_t> make_successor(const rva_t successor, const rva_t predecessor) {
+        bb_t* make_successor(const rva_t successor, const rva_t predecessor) {
             return make_successor(successor, at(predecessor));
         }
 
-        std::shared_ptr<bb_t> make_successor(const rva_t successor, const std::shared_ptr<bb_t>& predecessor) {
+        bb_t* make_successor(const rva_t successor, bb_t* predecessor) {
             // Don't analyse already existing bbs
             //
             if (seen_bb(successor)) {
@@ -93,8 +96,8 @@ namespace analysis::bb_decomp {
             return successor_ptr;
         }
 
-        [[nodiscard]] std::shared_ptr<bb_t> make_virtual_bb() {
-            auto result = std::make_shared<bb_t>(image_->guess_machine_mode());
+        [[nodiscard]] bb_t* make_virtual_bb() {
+            auto* result = bb_storage_->make_bb(image_->guess_machine_mode());
             virtual_basic_blocks_.emplace_back(result);
             return result;
         }
@@ -111,30 +114,26 @@ namespace analysis::bb_decomp {
             return (rva - function_start_) >= function_size_;
         }
 
-        [[nodiscard]] std::shared_ptr<bb_t> at(const rva_t rva) {
+        [[nodiscard]] bb_t* at(const rva_t rva) {
             if (const auto it = basic_blocks_.find(rva); it != basic_blocks_.end()) {
                 return it->second;
             }
 
-            basic_blocks_[rva] = std::make_shared<bb_t>(image_->guess_machine_mode());
-            return basic_blocks_[rva];
+            auto& result = basic_blocks_[rva];
+            result = bb_storage_->make_bb(image_->guess_machine_mode());
+            return result;
         }
 
-        void push_last_N_instruction(const std::size_t count, const std::shared_ptr<bb_t>& basic_block) const {
+        void push_last_N_instruction(const std::size_t count, bb_t* basic_block) const {
             basic_block->push_last_N_insns(assembler_.get(), bb_provider_.get(), count);
         }
 
-        [[nodiscard]] std::shared_ptr<insn_t> push_last_instruction(const std::shared_ptr<bb_t>& basic_block,
-                                                                    const std::optional<rva_t> rva = std::nullopt,
-                                                                    const std::optional<std::uint8_t> size = std::nullopt) const {
+        [[nodiscard]] insn_t* push_last_instruction(bb_t* basic_block, const std::optional<rva_t> rva = std::nullopt,
+                                                    const std::optional<std::uint8_t> size = std::nullopt) const {
             return basic_block->push_insn(assembler_->getCursor(), bb_provider_.get(), rva, size);
         }
 
-        [[nodiscard]] std::shared_ptr<label_t> push_last_label(const std::shared_ptr<bb_t>& basic_block) const {
-            return basic_block->push_label(assembler_->getCursor(), bb_provider_.get());
-        }
-
-        std::shared_ptr<label_t> push_last_label(bb_t* basic_block) const {
+        label_t* push_last_label(bb_t* basic_block) const {
             return basic_block->push_label(assembler_->getCursor(), bb_provider_.get());
         }
 
@@ -142,8 +141,8 @@ namespace analysis::bb_decomp {
         rva_t function_start_ = nullptr;
         std::optional<std::size_t> function_size_ = std::nullopt;
 
-        std::unordered_map<rva_t, std::shared_ptr<bb_t>> basic_blocks_ = {};
-        std::vector<std::shared_ptr<bb_t>> virtual_basic_blocks_ = {}; // = without the rva
+        std::unordered_map<rva_t, bb_t*> basic_blocks_ = {};
+        std::vector<bb_t*> virtual_basic_blocks_ = {}; // = without the rva
 
         std::shared_ptr<zasm::Program> program_ = {};
         std::shared_ptr<zasm::x86::Assembler> assembler_ = {};
@@ -152,6 +151,9 @@ namespace analysis::bb_decomp {
         std::unordered_map<rva_t, jump_table_t> jump_tables_ = {};
 
         std::shared_ptr<functional_bb_provider_t> bb_provider_ = {};
+
+        /// \brief Owner of all the basic blocks (including the virtual ones) and their lookup tables
+        std::shared_ptr<bb_storage_t> bb_storage_ = {};
     };
 
     template <pe::any_image_t Img>
@@ -10,8 +10,8 @@ namespace analysis::bb_decomp {
         const auto machine_mode = image_->guess_machine_mode();
 
         for (auto& basic_block : std::views::values(basic_blocks_)) {
-            for (std::size_t i = 0; i < basic_block->size(); ++i) {
-                const auto& insn = basic_block->instructions.at(i);
+            for (auto insn_it = basic_block->begin(); insn_it != basic_block->end(); ++insn_it) {
+                const auto& insn = *insn_it;
 
                 /// We aren't interested in the successful estimations of jcc/jmps
                 if (!(insn->flags & UNABLE_TO_ESTIMATE_JCC)) {
@@ -27,12 +27,15 @@ namespace analysis::bb_decomp {
                 /// Init the jumptable info
                 auto jump_table = jump_table_t{};
                 jump_table.bb = basic_block;
-                jump_table.jmp_at = basic_block->instructions.begin() + static_cast<std::ptrdiff_t>(i);
+                jump_table.jmp_at = insn_it;
 
                 /// Now we need find its table ptr, we are gonna do this by iterating back and
                 /// matching the load_index and/or base_move
-                for (std::size_t j = i; j != static_cast<std::size_t>(-1); j--) {
-                    const auto& prev_insn = basic_block->instructions.at(j);
+                /// `j` is the distance from the jmp, `index_load_j` is the distance of the index load
+                std::size_t j = 0;
+                std::size_t index_load_j = 0;
+                for (auto prev_it = std::make_reverse_iterator(std::next(insn_it)); prev_it != basic_block->instructions.rend(); ++prev_it, ++j) {
+                    const auto& prev_insn = *prev_it;
 
                     auto match_load_index = [&]() -> void {
                         /// If already found
@@ -62,7 +65,8 @@ namespace analysis::bb_decomp {
 
                         /// Yay.
                         jump_table.jump_table_rva = std::make_optional(mem->getDisplacement());
-                        jump_table.index_load_at = basic_block->begin() + static_cast<std::ptrdiff_t>(j);
+                        jump_table.index_load_at = std::prev(prev_it.base());
+                        index_load_j = j;
                     };
 
                     auto match_base_move = [&]() -> void {
@@ -77,7 +81,7 @@ namespace analysis::bb_decomp {
                         }
 
                         /// Check the max allowed distance
-                        if (std::distance(basic_block->begin(), *jump_table.index_load_at) - j > 3) {
+                        if (j - index_load_j > 3) {
                             return;
                         }
 
@@ -102,7 +106,7 @@ namespace analysis::bb_decomp {
                             return;
                         }
 
-                        jump_table.base_move_at = basic_block->begin() + static_cast<std::ptrdiff_t>(j);
+                        jump_table.base_move_at = std::prev(prev_it.base());
                     };
 
                     match_load_index();
@@ -212,7 +216,7 @@ namespace analysis::bb_decomp {
 
             /// Erase other nodes
             for (auto it = *info.index_load_at; it != (*info.bb)->instructions.end(); ++it) {
-                const auto ptr = it->get();
+                auto* ptr = *it;
                 if (!ptr->rva.has_value()) {
                     continue;
                 }
@@ -244,11 +248,11 @@ namespace analysis::bb_decomp {
             auto current_bb = *info.bb;
 
             /// Clear its old successors list
-            current_bb->successors.clear();
+            current_bb->clear_successors();
 
             /// Some temporary info about the new virtual bbs
             struct bb_info_t {
-                std::shared_ptr<bb_t> ptr = nullptr;
+                bb_t* ptr = nullptr;
                 zasm::Node* first = nullptr;
                 zasm::Node* last = nullptr;
                 const std::size_t count = 0;
@@ -287,14 +291,14 @@ namespace analysis::bb_decomp {
                 (void)push_last_label(successor);
 
                 /// Save the successor for previous virtual bb
-                current_bb->successors.emplace_back(new_bb);
+                current_bb->push_successor(new_bb);
 
                 /// Save the successor
-                new_bb->successors.emplace_back(successor);
-                new_bb->predecessors.emplace_back(current_bb);
+                new_bb->push_successor(successor);
+                new_bb->push_predecessor(current_bb);
 
                 /// Save the new_bb predecessor
-                successor->predecessors.emplace_back(new_bb);
+                successor->push_predecessor(new_bb);
 
                 current_bb = successor;
                 index++;
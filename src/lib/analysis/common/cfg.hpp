@@ -0,0 +1,95 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace analysis {
+    /// \brief Basic block id, unique within the bb storage that allocated the block
+    using bb_id_t = std::uint32_t;
+
+    /// \brief One direction of the CFG (either successors or predecessors)
+    /// Every node owns its own row of destinations, so the insertion/erasure is proportional to the node degree and the
+    /// reads never move the storage around. A span returned by `at` stays valid until the same row is modified
+    /// \tparam Ty Node type
+    template <typename Ty>
+    struct cfg_edges_t {
+        DEFAULT_CTOR_DTOR(cfg_edges_t);
+        NON_COPYABLE(cfg_edges_t);
+
+        /// \brief Insert the edge, each edge is inserted only once
+        /// \param from source node id
+        /// \param to destination node id
+        /// \param target destination node ptr
+        /// \return true if inserted, false if the edge already exists
+        bool push(const bb_id_t from, const bb_id_t to, Ty* target) {
+            if (from >= rows_.size()) {
+                rows_.resize(static_cast<std::size_t>(from) + 1);
+            }
+
+            /// Out-degree is almost always <= 2 (and jump tables are bounded), so a linear scan is cheaper than any set
+            auto& row = rows_[from];
+            if (std::ranges::any_of(row, [to](const Ty* it) -> bool { return it->id == to; })) {
+                return false;
+            }
+
+            row.emplace_back(target);
+            ++size_;
+            return true;
+        }
+
+        /// \brief Erase all the edges that start at the nodes that match the predicate
+        /// \param predicate callback
+        /// \return number of erased edges
+        std::size_t erase_if(const std::function<bool(bb_id_t)>& predicate) {
+            std::size_t result = 0;
+            for (bb_id_t from = 0; from < rows_.size(); ++from) {
+                if (!rows_[from].empty() && predicate(from)) {
+                    result += erase(from);
+                }
+            }
+
+            return result;
+        }
+
+        /// \brief Erase all the edges that start at the node
+        /// \param from source node id
+        /// \return number of erased edges
+        std::size_t erase(const bb_id_t from) {
+            if (from >= rows_.size()) {
+                return 0;
+            }
+
+            auto& row = rows_[from];
+            const auto result = row.size();
+            size_ -= result;
+            row.clear();
+            return result;
+        }
+
+        /// \brief Get the destinations of the node in the insertion order
+        /// \note The span is valid until the edges of this node are modified
+        /// \param from source node id
+        /// \return span of the destination nodes
+        [[nodiscard]] std::span<Ty* const> at(const bb_id_t from) const {
+            if (from >= rows_.size()) {
+                return {};
+            }
+
+            return rows_[from];
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+    private:
+        /// \brief Destinations of every node, `rows_[id]` are the destinations of the node `id`
+        std::vector<std::vector<Ty*>> rows_ = {};
+        /// \brief Total number of edges
+        std::size_t size_ = 0;
+    };
+} // namespace analysis
@@ -4,10 +4,19 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <ranges>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "analysis/common/cfg.hpp"
+#include "analysis/liveness/types.hpp"
 #include "easm/easm.hpp"
+#include "util/intrusive_list.hpp"
 #include "util/iterators.hpp"
+#include "util/object_pool.hpp"
 #include "util/structs.hpp"
 #include "util/types.hpp"
 
@@ -16,6 +25,7 @@ namespace analysis {
     using rva_t = types::rva_t;
 
     struct bb_t;
+    struct bb_storage_t;
 
     // CF direction representation
     //
@@ -26,7 +36,7 @@ namespace analysis {
             JMP
         };
 
-        std::shared_ptr<bb_t> bb;
+        bb_t* bb = nullptr;
         e_type type = e_type::JMP;
 
         /// Set to true if we were unable to find the next node.
@@ -54,7 +64,8 @@ namespace analysis {
     //
     enum e_insn_fl : std::uint8_t {
         UNABLE_TO_ESTIMATE_JCC = (1 << 0),
-        TO_BE_REMOVED = (1 << 1)
+        TO_BE_REMOVED = (1 << 1),
+        PRESERVE = (1 << 2) // the peephole optimizer shouldn't touch it
     };
 
     // CPU Flags
@@ -108,9 +119,9 @@ namespace analysis {
 
     struct bb_t;
 
-    // Instruction repr
+    // Instruction repr, the node stores its position within the BB instructions list
     // \todo @es3n1n: Some smart .destroy method that would unlink zasm node, remove relocs, etc
-    struct insn_t {
+    struct insn_t : util::IntrusiveListHook<insn_t> {
         // RVA to the start of the insn
         //
         std::optional<rva_t> rva = std::nullopt;
@@ -150,6 +161,14 @@ namespace analysis {
         cpu_flags_t flags_tested = {};
         cpu_flags_t flags_undefined = {};
 
+        // Registers/flags that are read/written by this instruction
+        //
+        insn_effects_t effects = {};
+
+        // Recompute the effects after the operands were modified in place, marks the owning bb as dirty
+        //
+        void update_effects();
+
         // Util to find first op of type
         //
         template <typename Ty>
@@ -189,7 +208,7 @@ namespace analysis {
             return !cf.empty();
         }
 
-        [[nodiscard]] std::shared_ptr<bb_t> linear_successor() const;
+        [[nodiscard]] bb_t* linear_successor() const;
     };
 
     struct bb_provider_t {
@@ -199,24 +218,24 @@ namespace analysis {
         /// \param va virtual address
         /// \param callee basic block callee
         /// \return optional bb ref
-        [[nodiscard]] virtual std::optional<std::shared_ptr<bb_t>> find_by_start_va(rva_t va, bb_t* callee) const = 0;
+        [[nodiscard]] virtual std::optional<bb_t*> find_by_start_va(rva_t va, bb_t* callee) const = 0;
 
         /// \brief Find bb by start RVA
         /// \param rva relative virtual address
         /// \param callee basic block callee
         /// \return optional bb ref
-        [[nodiscard]] virtual std::optional<std::shared_ptr<bb_t>> find_by_start_rva(rva_t rva, bb_t* callee) const = 0;
+        [[nodiscard]] virtual std::optional<bb_t*> find_by_start_rva(rva_t rva, bb_t* callee) const = 0;
 
         /// \brief Find bb by label
         /// \param label label ptr
         /// \param callee basic block callee
         /// \return optional bb ref
-        [[nodiscard]] virtual std::optional<std::shared_ptr<bb_t>> find_by_label(const zasm::Label* label, bb_t* callee) const = 0;
+        [[nodiscard]] virtual std::optional<bb_t*> find_by_label(const zasm::Label* label, bb_t* callee) const = 0;
 
         /// \brief Acquire bb reference from raw BB ptr
         /// \param ptr basic block ptr
         /// \return optional bb ref
-        [[nodiscard]] virtual std::optional<std::shared_ptr<bb_t>> acquire_ref(const bb_t* ptr) const = 0;
+        [[nodiscard]] virtual std::optional<bb_t*> acquire_ref(const bb_t* ptr) const = 0;
     };
 
     struct label_t {
@@ -247,22 +266,44 @@ namespace analysis {
 
         // A set of disassembled instructions
         //
-        std::vector<std::shared_ptr<insn_t>> instructions;
+        util::IntrusiveList<insn_t> instructions;
 
         // Attached labels
         //
-        std::unordered_map<zasm::Label::Id, std::shared_ptr<label_t>> labels;
+        std::unordered_map<zasm::Label::Id, label_t*> labels;
 
-        // BB Successor - a block that this block can lead to
-        // BB Predecessor - a block that always executes before this block
+        // Block id within the storage, the CFG edges are indexed by it
         //
-        std::vector<std::shared_ptr<bb_t>> successors;
-        std::vector<std::shared_ptr<bb_t>> predecessors;
+        bb_id_t id = 0;
 
         // Set to true if we changed the instructions list, you should reset it by yourself
+        // \note The liveness analysis is resetting it once it recomputes the block
         //
         std::atomic_bool dirty = false;
 
+        // Set the dirty flag and queue the block to the storage dirty list, so that the liveness analysis
+        // wouldn't have to look through all the blocks
+        //
+        void mark_dirty();
+
+        // Register liveness info, maintained by the `analysis::liveness`
+        //
+        bb_liveness_t liveness = {};
+
+        // Transform chance multiplier, 1 - transforms are applied at their full strength, 0 - the block is left untouched
+        // \note Set from the execution profile, so that we wouldn't bloat the hot paths
+        //
+        float chance_scale = 1.F;
+
+        // Number of natural loops that contain this block, maintained by the `analysis::loops`
+        //
+        std::uint32_t loop_depth = 0;
+
+        // The storage that owns this BB, we should notify it whenever the start RVA or labels are changed
+        // so it could keep its lookup tables up to date
+        //
+        bb_storage_t* storage = nullptr;
+
         // bf Flags
         //
         union {
@@ -275,27 +316,23 @@ namespace analysis {
 
         // Util methods
         //
-        void push_successor(const std::shared_ptr<bb_t>& value) {
-            // Inserting only once
-            //
-            if (std::ranges::find(successors, value) != successors.end()) {
-                return;
-            }
-
-            successors.emplace_back(value);
-        }
+        // BB Successor - a block that this block can lead to
+        // BB Predecessor - a block that always executes before this block
+        //
+        // The edges are owned by the storage, spans are valid until the edges of this block are modified
+        //
+        [[nodiscard]] std::span<bb_t* const> successors() const;
+        [[nodiscard]] std::span<bb_t* const> predecessors() const;
 
-        void push_predecessor(const std::shared_ptr<bb_t>& value) {
-            // Inserting only once
-            //
-            if (std::ranges::find(predecessors, value) != predecessors.end()) {
-                return;
-            }
+        // Inserting only once
+        //
+        void push_successor(bb_t* value);
+        void push_predecessor(bb_t* value);
 
-            predecessors.emplace_back(value);
-        }
+        void clear_successors();
+        void clear_predecessors();
 
-        std::shared_ptr<label_t> push_label(zasm::Node* label_node_ptr, const bb_provider_t* bb_provider) {
+        label_t* push_label(zasm::Node* label_node_ptr, const bb_provider_t* bb_provider) {
             assert(bb_provider != nullptr);
 
             // Acquire label ref
@@ -305,23 +342,23 @@ namespace analysis {
             }
 
             // Construct info
-            auto it = std::make_shared<label_t>();
+            auto* it = new_label();
             it->ref = ref;
             it->node_ref = label_node_ptr;
             it->bb_ref = this;
             it->id = ref->getId();
 
             // Save the ptr
-            label_node_ptr->setUserData(it.get()); // remember the ptr
+            label_node_ptr->setUserData(it); // remember the ptr
             labels[it->id] = it;
+            on_label_pushed(it->id);
 
             // We are done here
             return it;
         }
 
-        std::shared_ptr<insn_t> push_insn(zasm::Node* insn_node_ptr, const bb_provider_t* bb_provider, const std::optional<rva_t> rva = std::nullopt,
-                                          const std::optional<std::uint8_t> size = std::nullopt,
-                                          const std::optional<decltype(instructions)::iterator>& at = std::nullopt) {
+        insn_t* push_insn(zasm::Node* insn_node_ptr, const bb_provider_t* bb_provider, const std::optional<rva_t> rva = std::nullopt,
+                          const std::optional<std::uint8_t> size = std::nullopt, const std::optional<decltype(instructions)::iterator>& at = std::nullopt) {
             assert(bb_provider != nullptr);
 
             /// We are storing only instructions
@@ -334,7 +371,7 @@ namespace analysis {
             }
 
             /// Construct insn struct
-            auto it = std::make_shared<insn_t>();
+            auto* it = new_insn();
             it->node_ref = insn_node_ptr;
             it->ref = ref;
             it->bb_ref = this;
@@ -351,6 +388,7 @@ namespace analysis {
                 it->flags_modified.set(modified);
                 it->flags_tested.set(tested);
                 it->flags_undefined.set(undefined);
+                it->effects = insn_effects_t::from(res.value(), machine_mode);
             }
 
             /// Fill the CF change info
@@ -379,7 +417,7 @@ namespace analysis {
                     ref_it.rescheduled = true;
                     ref_it.rescheduled_va = rescheduled_va;
                 };
-                auto push_cf_changer = [&it, reschedule](const cf_direction_t::e_type ref_type, const std::optional<std::shared_ptr<bb_t>>& bb_ref,
+                auto push_cf_changer = [&it, reschedule](const cf_direction_t::e_type ref_type, const std::optional<bb_t*>& bb_ref,
                                                          const std::optional<rva_t> va = std::nullopt) -> void {
                     if (!bb_ref.has_value()) {
                         // This is bad. Let's reschedule it
@@ -446,9 +484,9 @@ namespace analysis {
             update_cf();
 
             /// Save the node
-            insn_node_ptr->setUserData(it.get()); // remember the ptr
-            instructions.emplace(at.value_or(instructions.end()), it);
-            dirty = true;
+            insn_node_ptr->setUserData(it); // remember the ptr
+            instructions.insert(at.value_or(instructions.end()), it);
+            mark_dirty();
             return it;
         }
 
@@ -457,22 +495,18 @@ namespace analysis {
             ///
             auto node = assembler->getCursor();
 
-            /// Insert in reverse order
+            /// Insert in reverse order, each node goes before the previously inserted one
             ///
-            std::size_t i;
-            for (i = 0; i < count && node != nullptr; i++, node = node->getPrev()) {
-                (void)push_insn(node, bb_provider);
+            auto at = instructions.end();
+            for (std::size_t i = 0; i < count && node != nullptr; i++, node = node->getPrev()) {
+                if (const auto insn = push_insn(node, bb_provider, std::nullopt, std::nullopt, at); insn != nullptr) {
+                    at = instructions.iterator_to(insn);
+                }
             }
-
-            /// Reverse the newly inserted nodes
-            ///
-            auto iter = instructions.begin();
-            std::advance(iter, count - i);
-            std::reverse(iter, instructions.end());
         }
 
-        [[nodiscard]] std::shared_ptr<insn_t> last_non_jmp_insn(zasm::Program* program = nullptr, const bool destroy_jmps = false,
-                                                                const bool include_conditional_jmps = false) const {
+        [[nodiscard]] insn_t* last_non_jmp_insn(zasm::Program* program = nullptr, const bool destroy_jmps = false,
+                                                const bool include_conditional_jmps = false) const {
             auto insns = temp_insns_copy();
             for (auto it = insns.rbegin(); it != insns.rend(); std::advance(it, 1)) {
                 auto insn = *it;
@@ -506,14 +540,20 @@ namespace analysis {
         }
 
         void clear() {
+            const auto previous_start_rva = start_rva;
+
             // Clearing all BB state
             //
             flags.valid = false;
             start_rva = nullptr;
             end_rva = nullptr;
-            successors.clear();
-            predecessors.clear();
+            clear_successors();
+            clear_predecessors();
             instructions.clear();
+
+            // Notify the storage
+            //
+            on_start_rva_changed(previous_start_rva);
         }
 
         void verify_ranges() const {
@@ -571,8 +611,10 @@ namespace analysis {
             // Update the range within the struct
             //
             assert(start_rva_.has_value() && end_rva_.has_value());
+            const auto previous_start_rva = start_rva;
             start_rva = *start_rva_;
             end_rva = *end_rva_;
+            on_start_rva_changed(previous_start_rva);
 
             // Verifying ranges just in case
             //
@@ -581,8 +623,8 @@ namespace analysis {
             }
         }
 
-        [[nodiscard]] std::vector<std::shared_ptr<insn_t>> temp_insns_copy() const {
-            return instructions;
+        [[nodiscard]] std::vector<insn_t*> temp_insns_copy() const {
+            return {instructions.begin(), instructions.end()};
         }
 
         [[nodiscard]] std::size_t size() const noexcept {
@@ -633,26 +675,33 @@ namespace analysis {
         auto end() const {
             return instructions.end();
         }
+
+        // Storage allocations/notifications, defined after the bb_storage_t
+        //
+        [[nodiscard]] insn_t* new_insn();
+        [[nodiscard]] label_t* new_label();
+        void on_label_pushed(zasm::Label::Id label_id);
+        void on_start_rva_changed(const std::optional<rva_t>& previous_start_rva);
     };
 
     /// \fixme @es3n1n: MOVE THIS STUFF TO .cpp!
-    [[nodiscard]] inline std::shared_ptr<bb_t> insn_t::linear_successor() const {
+    [[nodiscard]] inline bb_t* insn_t::linear_successor() const {
         if (is_jump()) {
             const auto it = std::ranges::find_if(cf, [](auto& pred) -> bool {
                 return pred.type == cf_direction_t::e_type::JCC_CONDITION_NOT_MET || pred.type == cf_direction_t::e_type::JMP;
             });
             return it->bb;
         }
-        assert(!bb_ref->successors.empty());
+        assert(!bb_ref->successors().empty());
         /// \todo @es3n1n: Check if last insn within the BB, return next insn if so
-        return bb_ref->successors.at(0);
+        return bb_ref->successors().front();
     }
 
     // Jump table representation
     //
     struct jump_table_t {
-        using insn_ptr_t = std::vector<std::shared_ptr<insn_t>>::iterator;
-        std::optional<std::shared_ptr<bb_t>> bb = std::nullopt;
+        using insn_ptr_t = decltype(bb_t::instructions)::iterator;
+        std::optional<bb_t*> bb = std::nullopt;
 
         std::optional<insn_ptr_t> index_load_at = std::nullopt; // mov reg, [bla+bla*bla]
         std::optional<insn_ptr_t> base_move_at = std::nullopt; // insn that goes before index_load and that uses register from index_load insn
@@ -662,47 +711,129 @@ namespace analysis {
         std::vector<rva_t> entries = {};
     };
 
+    /// \brief Basic block storage, it owns all the analysis objects (basic blocks, instructions, labels) of the function
+    /// and releases them all at once when destroyed
     struct bb_storage_t {
         DEFAULT_CTOR_DTOR(bb_storage_t);
-        DEFAULT_COPY(bb_storage_t);
-        explicit bb_storage_t(const std::vector<std::shared_ptr<bb_t>>& value): basic_blocks(value) { }
+        NON_COPYABLE(bb_storage_t);
+
+        using iterator = util::DerefPtrIter<bb_t>;
+        using const_iterator = util::DerefPtrIter<const bb_t>;
+
+        /// \brief Allocate a new basic block and index it
+        /// \param machine_mode bb machine mode
+        /// \return basic block ptr
+        [[nodiscard]] bb_t* make_bb(const zasm::MachineMode machine_mode) {
+            auto* bb = bb_pool_.make(machine_mode);
+            bb->storage = this;
+            bb->id = static_cast<bb_id_t>(by_id_.size());
+            by_id_.emplace_back(bb);
+            refs_.emplace(bb);
+            bb->mark_dirty(); // should be computed by the liveness analysis
+            return basic_blocks_.emplace_back(bb);
+        }
+
+        [[nodiscard]] bb_t* emplace_back() {
+            return make_bb(basic_blocks_.front()->machine_mode);
+        }
+
+        /// \brief Allocate a new instruction
+        /// \return instruction ptr, owned by the storage
+        [[nodiscard]] insn_t* make_insn() {
+            return insn_pool_.make();
+        }
+
+        /// \brief Allocate a new label
+        /// \return label ptr, owned by the storage
+        [[nodiscard]] label_t* make_label() {
+            return label_pool_.make();
+        }
 
-        using iterator = util::DerefSharedPtrIter<bb_t>;
-        using const_iterator = util::DerefSharedPtrIter<const bb_t>;
+        /// \brief Erase all the basic blocks that match the predicate
+        /// \note The memory is released only with the storage itself
+        /// \param predicate callback
+        /// \return number of erased blocks
+        std::size_t erase_if(const std::function<bool(const bb_t&)>& predicate) {
+            return std::erase_if(basic_blocks_, [this, &predicate](bb_t* bb) -> bool {
+                if (!predicate(*bb)) {
+                    return false;
+                }
 
-        [[nodiscard]] auto& emplace_back() {
-            return basic_blocks.emplace_back(std::make_shared<bb_t>(basic_blocks.begin()->get()->machine_mode));
+                unindex(bb);
+                return true;
+            });
+        }
+
+        /// \brief Find bb by its start RVA
+        /// \param rva relative virtual address
+        /// \return optional bb ref
+        [[nodiscard]] std::optional<bb_t*> find_by_start_rva(const rva_t rva) const {
+            const auto it = rva_lookup_.find(rva);
+            if (it == std::end(rva_lookup_)) {
+                return std::nullopt;
+            }
+
+            return it->second;
+        }
+
+        /// \brief Find bb that contains the label
+        /// \param label_id label id
+        /// \return optional bb ref
+        [[nodiscard]] std::optional<bb_t*> find_by_label(const zasm::Label::Id label_id) const {
+            const auto it = label_lookup_.find(label_id);
+            if (it == std::end(label_lookup_)) {
+                return std::nullopt;
+            }
+
+            return it->second;
+        }
+
+        /// \brief Acquire bb reference from raw BB ptr
+        /// \param ptr basic block ptr
+        /// \return optional bb ref, nullopt if the bb doesn't belong to this storage
+        [[nodiscard]] std::optional<bb_t*> acquire_ref(const bb_t* ptr) const {
+            const auto it = refs_.find(const_cast<bb_t*>(ptr));
+            if (it == std::end(refs_)) {
+                return std::nullopt;
+            }
+
+            return *it;
+        }
+
+        /// \brief Take the blocks that were marked as dirty since the last call
+        /// \note Could contain the blocks that were erased since then
+        /// \return dirty blocks
+        [[nodiscard]] std::vector<bb_t*> take_dirty() {
+            return std::exchange(dirty_, {});
         }
 
         void iter_bbs(const std::function<void(bb_t&)>& callback) {
-            std::ranges::for_each(basic_blocks, [callback](const std::shared_ptr<bb_t>& value) -> void { callback(*value); });
+            std::ranges::for_each(basic_blocks_, [callback](bb_t* value) -> void { callback(*value); });
         }
 
         void iter_insns(const std::function<void(insn_t&)>& callback) {
             iter_bbs([&callback](bb_t& basic_block) -> void { //
-                std::ranges::for_each(basic_block.instructions, [&callback](auto& ptr) -> void { callback(*ptr); });
+                std::ranges::for_each(basic_block.instructions, [&callback](insn_t* ptr) -> void { callback(*ptr); });
             });
         }
 
         /// Don't forget to stop the observer, i guess? (fixme)
-        [[nodiscard]] std::shared_ptr<bb_t> copy_bb(const std::shared_ptr<bb_t>& bb, zasm::x86::Assembler* as, zasm::Program* program,
-                                                    const bb_provider_t* provider) {
+        [[nodiscard]] bb_t* copy_bb(bb_t* bb, zasm::x86::Assembler* as, zasm::Program* program, const bb_provider_t* provider) {
             /// Alloc bb
-            auto new_bb = std::make_shared<bb_t>(bb->machine_mode);
-            basic_blocks.emplace_back(new_bb);
+            auto* new_bb = make_bb(bb->machine_mode);
 
             /// Copy all the instructions
-            for (const auto& insn : bb->instructions) {
+            for (const auto* insn : bb->instructions) {
                 /// Emit instruction copy, store it in the BB
                 as->emit(*insn->ref);
                 new_bb->push_insn(as->getCursor(), provider);
             }
 
             /// Insert jmp if needed
-            if (const auto last_insn = bb->instructions.at(bb->size() - 1);
-                !last_insn->is_jump() && !last_insn->is_conditional_jump() && !bb->successors.empty()) {
+            if (const auto* last_insn = bb->instructions.back();
+                !last_insn->is_jump() && !last_insn->is_conditional_jump() && !bb->successors().empty()) {
                 /// Get the linear successor
-                const auto successor = last_insn->linear_successor();
+                auto* successor = last_insn->linear_successor();
 
                 /// Create new label
                 const auto label = program->createLabel();
@@ -722,29 +853,169 @@ namespace analysis {
         }
 
         [[nodiscard]] auto begin() {
-            return iterator(basic_blocks.begin());
+            return iterator(basic_blocks_.begin());
         }
 
         [[nodiscard]] auto begin() const {
-            return const_iterator(basic_blocks.begin());
+            return const_iterator(basic_blocks_.begin());
         }
 
         [[nodiscard]] auto end() {
-            return iterator(basic_blocks.end());
+            return iterator(basic_blocks_.end());
         }
 
         [[nodiscard]] auto end() const {
-            return const_iterator(basic_blocks.end());
+            return const_iterator(basic_blocks_.end());
         }
 
         [[nodiscard]] std::size_t size() const {
-            return basic_blocks.size();
+            return basic_blocks_.size();
         }
 
-        [[nodiscard]] std::vector<std::shared_ptr<bb_t>> temp_copy() const {
-            return basic_blocks;
+        [[nodiscard]] std::vector<bb_t*> temp_copy() const {
+            return basic_blocks_;
+        }
+
+        /// \brief Drop the successors of all the blocks that match the predicate within a single pass over the edges
+        /// \param predicate callback
+        void clear_successors_if(const std::function<bool(const bb_t&)>& predicate) {
+            successors_.erase_if([this, &predicate](const bb_id_t id) -> bool { return predicate(*by_id_[id]); });
+        }
+
+        /// \brief Drop the predecessors of all the blocks that match the predicate within a single pass over the edges
+        /// \param predicate callback
+        void clear_predecessors_if(const std::function<bool(const bb_t&)>& predicate) {
+            predecessors_.erase_if([this, &predicate](const bb_id_t id) -> bool { return predicate(*by_id_[id]); });
+        }
+
+    private:
+        friend struct bb_t;
+
+        /// \brief Remove bb from the lookup tables
+        /// \param bb basic block ptr
+        void unindex(bb_t* bb) {
+            if (bb->start_rva.has_value()) {
+                if (const auto it = rva_lookup_.find(*bb->start_rva); it != std::end(rva_lookup_) && it->second == bb) {
+                    rva_lookup_.erase(it);
+                }
+            }
+
+            for (const auto& label_id : std::views::keys(bb->labels)) {
+                if (const auto it = label_lookup_.find(label_id); it != std::end(label_lookup_) && it->second == bb) {
+                    label_lookup_.erase(it);
+                }
+            }
+
+            refs_.erase(bb);
         }
 
-        std::vector<std::shared_ptr<bb_t>> basic_blocks = {};
+        /// \brief Object pools, note that the instructions should outlive the blocks, since the blocks are
+        /// unlinking them on destruction
+        util::ObjectPool<insn_t> insn_pool_ = {};
+        util::ObjectPool<label_t> label_pool_ = {};
+        util::ObjectPool<bb_t> bb_pool_ = {};
+
+        /// \brief Basic blocks
+        std::vector<bb_t*> basic_blocks_ = {};
+        /// \brief All the allocated basic blocks, index is the bb id
+        std::vector<bb_t*> by_id_ = {};
+
+        /// \brief Blocks that were marked as dirty, see `bb_t::mark_dirty`
+        std::vector<bb_t*> dirty_ = {};
+
+        /// \brief CFG edges
+        cfg_edges_t<bb_t> successors_ = {};
+        cfg_edges_t<bb_t> predecessors_ = {};
+
+        /// \brief Lookup tables, so that we wouldn't have to iterate over all blocks each time we emit a jcc/jmp
+        std::unordered_set<bb_t*> refs_ = {};
+        std::unordered_map<rva_t, bb_t*> rva_lookup_ = {};
+        std::unordered_map<zasm::Label::Id, bb_t*> label_lookup_ = {};
     };
+
+    inline insn_t* bb_t::new_insn() {
+        assert(storage != nullptr);
+        return storage->make_insn();
+    }
+
+    inline label_t* bb_t::new_label() {
+        assert(storage != nullptr);
+        return storage->make_label();
+    }
+
+    inline void insn_t::update_effects() {
+        assert(bb_ref != nullptr);
+        if (const auto res = ref->getDetail(bb_ref->machine_mode); res.hasValue()) {
+            effects = insn_effects_t::from(res.value(), bb_ref->machine_mode);
+        } else {
+            effects = {};
+        }
+
+        bb_ref->mark_dirty();
+    }
+
+    inline void bb_t::mark_dirty() {
+        /// Already queued
+        if (dirty.exchange(true) || storage == nullptr) {
+            return;
+        }
+
+        storage->dirty_.emplace_back(this);
+    }
+
+    inline std::span<bb_t* const> bb_t::successors() const {
+        assert(storage != nullptr);
+        return storage->successors_.at(id);
+    }
+
+    inline std::span<bb_t* const> bb_t::predecessors() const {
+        assert(storage != nullptr);
+        return storage->predecessors_.at(id);
+    }
+
+    inline void bb_t::push_successor(bb_t* value) {
+        assert(storage != nullptr && value->storage == storage);
+        storage->successors_.push(id, value->id, value);
+    }
+
+    inline void bb_t::push_predecessor(bb_t* value) {
+        assert(storage != nullptr && value->storage == storage);
+        storage->predecessors_.push(id, value->id, value);
+    }
+
+    inline void bb_t::clear_successors() {
+        assert(storage != nullptr);
+        storage->successors_.erase(id);
+    }
+
+    inline void bb_t::clear_predecessors() {
+        assert(storage != nullptr);
+        storage->predecessors_.erase(id);
+    }
+
+    inline void bb_t::on_label_pushed(const zasm::Label::Id label_id) {
+        if (storage == nullptr) {
+            return;
+        }
+
+        storage->label_lookup_[label_id] = this;
+    }
+
+    inline void bb_t::on_start_rva_changed(const std::optional<rva_t>& previous_start_rva) {
+        if (storage == nullptr || previous_start_rva == start_rva) {
+            return;
+        }
+
+        /// Drop the outdated entry, but only if it was pointing to us
+        if (previous_start_rva.has_value()) {
+            if (const auto it = storage->rva_lookup_.find(*previous_start_rva); it != std::end(storage->rva_lookup_) && it->second == this) {
+                storage->rva_lookup_.erase(it);
+            }
+        }
+
+        /// Cleared blocks shouldn't be discoverable
+        if (start_rva.has_value() && flags.valid) {
+            storage->rva_lookup_.try_emplace(*start_rva, this);
+        }
+    }
 } // namespace analysis
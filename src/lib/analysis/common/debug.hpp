@@ -28,11 +28,11 @@ namespace analysis::debug {
                << ZydisMnemonicGetString(static_cast<ZydisMnemonic>(instruction->ref->getMnemonic().value())) << '\n';
         }
 
-        for (auto& successor : basic_block.successors) {
+        for (const auto* successor : basic_block.successors()) {
             ss << "successor:" << std::hex << successor->start_rva.value_or(0).inner() << '\n';
         }
 
-        for (auto& predecessor : basic_block.predecessors) {
+        for (const auto* predecessor : basic_block.predecessors()) {
             ss << "predecessor:" << std::hex << predecessor->start_rva.value_or(0).inner() << '\n';
         }
 
@@ -79,18 +79,18 @@ namespace analysis::debug {
             }
         }
 
-        if (!bb.successors.empty()) {
+        if (!bb.successors().empty()) {
             logger::info<1>("Successors:");
 
-            for (const auto& successor : bb.successors) {
+            for (const auto* successor : bb.successors()) {
                 logger::info<2>("{:#x}", successor->start_rva.value_or(0));
             }
         }
 
-        if (!bb.predecessors.empty()) {
+        if (!bb.predecessors().empty()) {
             logger::info<1>("Predecessors:");
 
-            for (const auto& predecessor : bb.predecessors) {
+            for (const auto* predecessor : bb.predecessors()) {
                 logger::info<2>("{:#x}", predecessor->start_rva.value_or(0));
             }
         }
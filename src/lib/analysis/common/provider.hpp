@@ -6,7 +6,7 @@ namespace analysis {
     private:
         template <typename Ty>
         using FuncTy = std::optional<std::function<Ty>>;
-        using ResultTy = std::optional<std::shared_ptr<bb_t>>;
+        using ResultTy = std::optional<bb_t*>;
 
     public:
         /// \brief Find bb by start VA
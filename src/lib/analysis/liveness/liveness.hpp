@@ -0,0 +1,156 @@
+#pragma once
+#include "analysis/common/common.hpp"
+
+#include <vector>
+
+/// \note A classic backward dataflow register/status flags liveness analysis over the bb storage CFG.
+/// All the blocks are computed once after the bb decomp, after that only the blocks from the storage dirty list
+/// (instructions were inserted/removed, this is done by `push_insn` and the observer) are recomputed, and the changes
+/// are propagated to their predecessors. The sets could shrink as well as grow during the updates, but since we're starting
+/// from the previous solution rather than from scratch, the registers that are keeping each other alive around a loop
+/// could stay live after their last use is removed. So the result could be slightly conservative after the updates,
+/// which is fine since we only use it to find the registers/flags that we could clobber.
+namespace analysis::liveness {
+    namespace detail {
+        /// \brief Get the registers/flags that the instruction reads, with some conservative assumptions
+        /// \param insn instruction
+        /// \return live set
+        [[nodiscard]] inline live_t read(const insn_t& insn) {
+            /// We don't know where it goes, or who's gonna read our registers/flags there (callee, caller)
+            if ((insn.flags & UNABLE_TO_ESTIMATE_JCC) != 0 || easm::is_ret(*insn.ref) || insn.ref->getMnemonic().value() == ZYDIS_MNEMONIC_CALL) {
+                return kAllLive;
+            }
+
+            return insn.effects.read;
+        }
+
+        /// \brief Transfer function, get the live registers/flags before the instruction
+        /// \param live registers/flags that are live after the instruction
+        /// \param insn instruction
+        /// \return registers/flags that are live before the instruction
+        [[nodiscard]] inline live_t step(const live_t& live, const insn_t& insn) {
+            return read(insn) | live.without(insn.effects.written);
+        }
+
+        /// \brief Get the registers/flags that are live at the bb exit
+        /// \param bb basic block
+        /// \return live set
+        [[nodiscard]] inline live_t live_out(const bb_t& bb) {
+            /// Leaving the function, or going somewhere we don't know about
+            const auto successors = bb.successors();
+            if (successors.empty()) {
+                return kAllLive;
+            }
+
+            if (!bb.instructions.empty() && std::ranges::any_of(bb.instructions.back()->cf, [](const cf_direction_t& cf) -> bool {
+                    return cf.bb == nullptr || cf.rescheduled; //
+                })) {
+                return kAllLive;
+            }
+
+            live_t result = {};
+            for (const auto* successor : successors) {
+                result = result | (successor->liveness.valid ? successor->liveness.in : kAllLive);
+            }
+            return result;
+        }
+
+        /// \brief Recompute gen/kill sets of the block
+        /// \param bb basic block
+        /// \return true if something has changed
+        inline bool summarize(bb_t& bb) {
+            live_t gen = {};
+            live_t kill = {};
+
+            for (auto it = bb.instructions.rbegin(); it != bb.instructions.rend(); ++it) {
+                gen = step(gen, **it);
+                kill = kill | (*it)->effects.written;
+            }
+
+            const bool changed = !bb.liveness.valid || bb.liveness.gen != gen || bb.liveness.kill != kill;
+            bb.liveness.gen = gen;
+            bb.liveness.kill = kill;
+            return changed;
+        }
+    } // namespace detail
+
+    /// \brief Recompute the liveness info for the blocks that were changed
+    /// \param storage basic block storage
+    inline void update(bb_storage_t& storage) {
+        /// Collect the blocks that we should recompute, new blocks are in the dirty list too
+        std::vector<bb_t*> worklist = {};
+        for (auto* bb : storage.take_dirty()) {
+            bb->dirty = false;
+
+            /// Skip the blocks that were erased in the meantime
+            if (!storage.acquire_ref(bb).has_value()) {
+                continue;
+            }
+
+            if (detail::summarize(*bb)) {
+                worklist.emplace_back(bb);
+            }
+        }
+
+        /// Propagate the changes
+        while (!worklist.empty()) {
+            auto* bb = worklist.back();
+            worklist.pop_back();
+
+            const auto out = detail::live_out(*bb);
+            const auto in = bb->liveness.gen | out.without(bb->liveness.kill);
+
+            const bool changed = !bb->liveness.valid || bb->liveness.in != in;
+            bb->liveness.out = out;
+            bb->liveness.in = in;
+            bb->liveness.valid = true;
+
+            if (!changed) {
+                continue;
+            }
+
+            for (auto* predecessor : bb->predecessors()) {
+                worklist.emplace_back(predecessor);
+            }
+        }
+    }
+
+    /// \brief Get the registers/flags that are live right after the instruction
+    /// \param insn instruction
+    /// \return live set
+    [[nodiscard]] inline live_t live_after(const insn_t* insn) {
+        assert(insn != nullptr && insn->bb_ref != nullptr && insn->bb_ref->storage != nullptr);
+        update(*insn->bb_ref->storage);
+
+        /// Walking backwards from the block exit
+        auto live = insn->bb_ref->liveness.out;
+        for (auto it = insn->bb_ref->instructions.rbegin(); it != insn->bb_ref->instructions.rend() && *it != insn; ++it) {
+            live = detail::step(live, **it);
+        }
+
+        return live;
+    }
+
+    /// \brief Get the registers/flags that are live right before the instruction
+    /// \param insn instruction
+    /// \return live set
+    [[nodiscard]] inline live_t live_before(const insn_t* insn) {
+        return detail::step(live_after(insn), *insn);
+    }
+
+    /// \brief Get the registers that we could clobber after the instruction without saving them
+    /// \param insn instruction
+    /// \return register mask
+    [[nodiscard]] inline reg_mask_t dead_after(const insn_t* insn) {
+        return static_cast<reg_mask_t>(~live_after(insn).regs);
+    }
+
+    /// \brief Get the registers that we could clobber anywhere around the instruction (before, after, or instead of it)
+    /// without saving them
+    /// \param insn instruction
+    /// \return register mask
+    [[nodiscard]] inline reg_mask_t dead_around(const insn_t* insn) {
+        const auto after = live_after(insn);
+        return static_cast<reg_mask_t>(~(after | detail::step(after, *insn)).regs);
+    }
+} // namespace analysis::liveness
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <zasm/zasm.hpp>
+
+namespace analysis {
+    /// \brief A set of root GP registers, bit N stands for the `ZYDIS_REGISTER_RAX + N` register
+    /// \note x86 registers are mapped to their x64 roots, so that we could use the same masks for both archs
+    using reg_mask_t = std::uint16_t;
+
+    /// \brief All GP registers
+    constexpr reg_mask_t kAllRegs = std::numeric_limits<reg_mask_t>::max();
+
+    /// \brief A set of status flags
+    using flags_mask_t = std::uint8_t;
+
+    /// \brief Status flags that we're tracking, the system ones (IF, TF, etc) are never touched by our stubs
+    enum e_status_fl : flags_mask_t {
+        FL_CF = (1 << 0),
+        FL_PF = (1 << 1),
+        FL_AF = (1 << 2),
+        FL_ZF = (1 << 3),
+        FL_SF = (1 << 4),
+        FL_OF = (1 << 5),
+    };
+
+    /// \brief All status flags
+    constexpr flags_mask_t kAllFlags = FL_CF | FL_PF | FL_AF | FL_ZF | FL_SF | FL_OF;
+
+    /// \brief Convert the zasm cpu flags to the liveness mask
+    /// \param flags zasm cpu flags
+    /// \return flags mask
+    inline flags_mask_t flags_mask(const zasm::InstrCPUFlags flags) noexcept {
+        namespace CPUFlags = zasm::x86::CPUFlags;
+        auto test = [flags](const auto fl) -> bool {
+            return (flags & fl) != CPUFlags::None;
+        };
+
+        flags_mask_t result = 0;
+        result |= test(CPUFlags::CF) ? FL_CF : 0;
+        result |= test(CPUFlags::PF) ? FL_PF : 0;
+        result |= test(CPUFlags::AF) ? FL_AF : 0;
+        result |= test(CPUFlags::ZF) ? FL_ZF : 0;
+        result |= test(CPUFlags::SF) ? FL_SF : 0;
+        result |= test(CPUFlags::OF) ? FL_OF : 0;
+        return result;
+    }
+
+    /// \brief Convert the register to the liveness mask
+    /// \param reg any GP register (al, ax, eax, rax, ...)
+    /// \return mask with a single bit set, 0 for non-GP registers
+    inline reg_mask_t reg_mask(const zasm::Reg reg) noexcept {
+        if (!reg.isValid()) {
+            return 0;
+        }
+
+        const auto index = static_cast<int>(reg.getRoot(zasm::MachineMode::AMD64).getId()) - static_cast<int>(ZYDIS_REGISTER_RAX);
+        if (index < 0 || index >= std::numeric_limits<reg_mask_t>::digits) {
+            return 0;
+        }
+
+        return static_cast<reg_mask_t>(1U << index);
+    }
+
+    /// \brief A set of live registers and flags
+    struct live_t {
+        reg_mask_t regs = 0;
+        flags_mask_t flags = 0;
+
+        [[nodiscard]] bool operator==(const live_t&) const = default;
+
+        [[nodiscard]] live_t operator|(const live_t& other) const noexcept {
+            return {.regs = static_cast<reg_mask_t>(regs | other.regs), .flags = static_cast<flags_mask_t>(flags | other.flags)};
+        }
+
+        /// \brief Remove the items that are set in `other`
+        /// \param other killed items
+        /// \return result
+        [[nodiscard]] live_t without(const live_t& other) const noexcept {
+            return {.regs = static_cast<reg_mask_t>(regs & ~other.regs), .flags = static_cast<flags_mask_t>(flags & ~other.flags)};
+        }
+    };
+
+    /// \brief Everything is alive
+    constexpr live_t kAllLive = {.regs = kAllRegs, .flags = kAllFlags};
+
+    /// \brief Registers and flags that the instruction reads/writes
+    struct insn_effects_t {
+        /// \brief Read registers and tested flags, conservatively set to everything until we know better
+        live_t read = kAllLive;
+        /// \brief Registers that are fully overwritten and flags that are modified (or left undefined) by the instruction
+        live_t written = {};
+
+        /// \brief Collect registers from the instruction detail, implicit operands included
+        /// \param detail zasm instruction detail
+        /// \param machine_mode machine mode
+        /// \return collected info
+        [[nodiscard]] static insn_effects_t from(const zasm::InstructionDetail& detail, const zasm::MachineMode machine_mode) {
+            constexpr auto kRead = static_cast<std::uint8_t>(zasm::Operand::Access::Read) | static_cast<std::uint8_t>(zasm::Operand::Access::CondRead);
+            constexpr auto kWrite = static_cast<std::uint8_t>(zasm::Operand::Access::Write);
+
+            const auto [set1, set0, modified, tested, undefined] = detail.getCPUFlags();
+            insn_effects_t result = {
+                .read = {.regs = 0, .flags = flags_mask(tested)},
+                .written = {.regs = 0, .flags = static_cast<flags_mask_t>(flags_mask(modified) | flags_mask(set0) | flags_mask(set1) |
+                                                                          flags_mask(undefined))},
+            };
+            for (std::size_t i = 0; i < detail.getOperandCount(); ++i) {
+                const auto access = static_cast<std::uint8_t>(detail.getOperandAccess(i));
+                const auto& operand = detail.getOperand(i);
+
+                /// Memory operands are reading their base/index regardless of the access type
+                if (const auto* op_mem = operand.getIf<zasm::Mem>(); op_mem != nullptr) {
+                    result.read.regs |= reg_mask(op_mem->getBase()) | reg_mask(op_mem->getIndex());
+                    continue;
+                }
+
+                const auto* op_reg = operand.getIf<zasm::Reg>();
+                if (op_reg == nullptr) {
+                    continue;
+                }
+
+                if ((access & kRead) != 0) {
+                    result.read.regs |= reg_mask(*op_reg);
+                }
+
+                /// 8/16bit writes are keeping the upper part of the register, so they don't kill it.
+                /// Conditional writes (cmovcc) aren't killing anything either
+                if ((access & kWrite) != 0 && getBitSize(op_reg->getBitSize(machine_mode)) >= 32) {
+                    result.written.regs |= reg_mask(*op_reg);
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /// \brief Per basic block liveness state
+    struct bb_liveness_t {
+        /// \brief Registers/flags that are read before they're written within the block
+        live_t gen = {};
+        /// \brief Registers/flags that are written within the block
+        live_t kill = {};
+        /// \brief Registers/flags that are live at the block entry/exit
+        live_t in = {};
+        live_t out = {};
+        /// \brief Set to true once the block was processed at least once
+        bool valid = false;
+    };
+} // namespace analysis
@@ -0,0 +1,289 @@
+#pragma once
+#include "analysis/common/common.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// \note Dominator tree (Cooper, Harvey, Kennedy - "A Simple, Fast Dominance Algorithm") and natural loops over the
+/// bb storage CFG. The blocks without predecessors (entry, jump table targets that we couldn't link, etc) are connected to a
+/// virtual root, so that every reachable block gets its immediate dominator.
+namespace analysis::loops {
+    /// \brief Dominator tree
+    class Dominators {
+    public:
+        DEFAULT_DTOR(Dominators);
+        NON_COPYABLE(Dominators);
+
+        /// \brief Compute the dominator tree
+        /// \param storage bb storage
+        /// \param entry function entry block, could be null
+        explicit Dominators(bb_storage_t& storage, const bb_t* entry = nullptr) {
+            /// Index the blocks, the last index is reserved for the virtual root
+            storage.iter_bbs([this](bb_t& bb) -> void {
+                index_.emplace(&bb, blocks_.size());
+                blocks_.emplace_back(&bb);
+            });
+            root_ = blocks_.size();
+
+            /// Collect the root successors
+            std::vector<std::size_t> roots = {};
+            if (entry != nullptr && index_.contains(entry)) {
+                roots.emplace_back(index_.at(entry));
+            }
+            for (std::size_t i = 0; i < blocks_.size(); ++i) {
+                if (blocks_[i]->predecessors().empty() && blocks_[i] != entry) {
+                    roots.emplace_back(i);
+                }
+            }
+
+            /// Preds lists, the roots are preceded by the virtual root
+            preds_.resize(blocks_.size() + 1);
+            for (std::size_t i = 0; i < blocks_.size(); ++i) {
+                for (const auto* pred : blocks_[i]->predecessors()) {
+                    if (const auto it = index_.find(pred); it != index_.end()) {
+                        preds_[i].emplace_back(it->second);
+                    }
+                }
+            }
+            for (const auto root : roots) {
+                preds_[root].emplace_back(root_);
+            }
+
+            compute_order(roots);
+            compute_idoms();
+        }
+
+        /// \brief Get the immediate dominator
+        /// \param bb basic block
+        /// \return immediate dominator, null for the roots and unreachable blocks
+        [[nodiscard]] bb_t* idom(const bb_t* bb) const {
+            const auto it = index_.find(bb);
+            if (it == index_.end() || idom_[it->second] == kUndefined || idom_[it->second] == root_) {
+                return nullptr;
+            }
+
+            return blocks_[idom_[it->second]];
+        }
+
+        /// \brief Check whether `a` dominates `b`, every block dominates itself
+        /// \param a basic block
+        /// \param b basic block
+        /// \return true if dominates
+        [[nodiscard]] bool dominates(const bb_t* a, const bb_t* b) const {
+            const auto a_it = index_.find(a);
+            const auto b_it = index_.find(b);
+            if (a_it == index_.end() || b_it == index_.end() || idom_[b_it->second] == kUndefined) {
+                return false;
+            }
+
+            for (auto cur = b_it->second; cur != root_; cur = idom_[cur]) {
+                if (cur == a_it->second) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        static constexpr std::size_t kUndefined = std::numeric_limits<std::size_t>::max();
+
+        /// \brief Compute the post order numbers and reverse post order
+        void compute_order(const std::vector<std::size_t>& roots) {
+            post_order_.assign(blocks_.size() + 1, kUndefined);
+
+            std::vector<bool> visited(blocks_.size() + 1, false);
+            std::size_t counter = 0;
+
+            /// Iterative dfs, pair of (node, next successor index)
+            std::vector<std::pair<std::size_t, std::size_t>> stack = {{root_, 0}};
+            visited[root_] = true;
+            while (!stack.empty()) {
+                auto& [node, next] = stack.back();
+
+                const auto successors = successors_of(node, roots);
+                if (next >= successors.size()) {
+                    post_order_[node] = counter++;
+                    rpo_.emplace_back(node);
+                    stack.pop_back();
+                    continue;
+                }
+
+                const auto successor = successors[next++];
+                if (!visited[successor]) {
+                    visited[successor] = true;
+                    stack.emplace_back(successor, 0);
+                }
+            }
+
+            std::ranges::reverse(rpo_);
+        }
+
+        /// \brief Get the successors of the node by its index
+        [[nodiscard]] std::vector<std::size_t> successors_of(const std::size_t node, const std::vector<std::size_t>& roots) const {
+            if (node == root_) {
+                return roots;
+            }
+
+            std::vector<std::size_t> result = {};
+            for (const auto* successor : blocks_[node]->successors()) {
+                if (const auto it = index_.find(successor); it != index_.end()) {
+                    result.emplace_back(it->second);
+                }
+            }
+            return result;
+        }
+
+        /// \brief Iterate until the immediate dominators converge
+        void compute_idoms() {
+            idom_.assign(blocks_.size() + 1, kUndefined);
+            idom_[root_] = root_;
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+
+                for (const auto node : rpo_) {
+                    if (node == root_) {
+                        continue;
+                    }
+
+                    auto new_idom = kUndefined;
+                    for (const auto pred : preds_[node]) {
+                        if (idom_[pred] == kUndefined) {
+                            continue;
+                        }
+
+                        new_idom = new_idom == kUndefined ? pred : intersect(pred, new_idom);
+                    }
+
+                    if (new_idom != kUndefined && idom_[node] != new_idom) {
+                        idom_[node] = new_idom;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] std::size_t intersect(std::size_t a, std::size_t b) const {
+            while (a != b) {
+                while (post_order_[a] < post_order_[b]) {
+                    a = idom_[a];
+                }
+                while (post_order_[b] < post_order_[a]) {
+                    b = idom_[b];
+                }
+            }
+            return a;
+        }
+
+        std::vector<bb_t*> blocks_ = {};
+        std::unordered_map<const bb_t*, std::size_t> index_ = {};
+        std::vector<std::vector<std::size_t>> preds_ = {};
+        std::size_t root_ = 0;
+
+        std::vector<std::size_t> rpo_ = {};
+        std::vector<std::size_t> post_order_ = {};
+        std::vector<std::size_t> idom_ = {};
+    };
+
+    /// \brief Natural loop
+    struct loop_t {
+        /// \brief Loop header, dominates every block of the loop
+        bb_t* header = nullptr;
+        /// \brief Blocks of the loop, including the header and the nested loops
+        std::unordered_set<bb_t*> blocks = {};
+
+        /// \brief Get the loop preheader, the only block outside of the loop that leads to the header
+        /// \return preheader, null if there are multiple entries or if it could go somewhere else too
+        [[nodiscard]] bb_t* preheader() const {
+            bb_t* result = nullptr;
+            for (auto* pred : header->predecessors()) {
+                if (blocks.contains(pred)) {
+                    continue;
+                }
+
+                if (result != nullptr) {
+                    return nullptr;
+                }
+                result = pred;
+            }
+
+            if (result == nullptr || result->successors().size() != 1) {
+                return nullptr;
+            }
+            return result;
+        }
+    };
+
+    /// \brief Find the natural loops, back edges that go to the same header are forming the same loop
+    /// \param storage bb storage
+    /// \param entry function entry block, could be null
+    /// \return loops, outer loops go before the nested ones
+    [[nodiscard]] inline std::vector<loop_t> find(bb_storage_t& storage, const bb_t* entry = nullptr) {
+        const Dominators dominators(storage, entry);
+
+        /// Back edges are the ones that go to the dominator
+        std::unordered_map<bb_t*, std::vector<bb_t*>> latches = {};
+        storage.iter_bbs([&](bb_t& bb) -> void {
+            for (auto* successor : bb.successors()) {
+                if (dominators.dominates(successor, &bb)) {
+                    latches[successor].emplace_back(&bb);
+                }
+            }
+        });
+
+        std::vector<loop_t> result = {};
+        for (auto& [header, tails] : latches) {
+            /// Walk backwards from the latches until we hit the header
+            auto& loop = result.emplace_back(loop_t{.header = header, .blocks = {header}});
+            std::vector<bb_t*> worklist = {};
+            for (auto* tail : tails) {
+                if (loop.blocks.emplace(tail).second) {
+                    worklist.emplace_back(tail);
+                }
+            }
+
+            while (!worklist.empty()) {
+                auto* bb = worklist.back();
+                worklist.pop_back();
+
+                for (auto* pred : bb->predecessors()) {
+                    if (loop.blocks.emplace(pred).second) {
+                        worklist.emplace_back(pred);
+                    }
+                }
+            }
+        }
+
+        /// Nested loops are fully contained in the outer ones, the header id is there just to keep the order stable
+        std::ranges::sort(result, [](const loop_t& a, const loop_t& b) -> bool {
+            if (a.blocks.size() != b.blocks.size()) {
+                return a.blocks.size() > b.blocks.size();
+            }
+            return a.header->id < b.header->id;
+        });
+        return result;
+    }
+
+    /// \brief Find the natural loops and update the `loop_depth` of every block
+    /// \param storage bb storage
+    /// \param entry function entry block, could be null
+    /// \return number of loops
+    inline std::size_t update(bb_storage_t& storage, const bb_t* entry = nullptr) {
+        const auto loops = find(storage, entry);
+
+        /// The depth is just the number of loops that contain the block
+        storage.iter_bbs([](bb_t& bb) -> void { bb.loop_depth = 0; });
+        for (const auto& loop : loops) {
+            for (auto* bb : loop.blocks) {
+                ++bb->loop_depth;
+            }
+        }
+
+        return loops.size();
+    }
+} // namespace analysis::loops
@@ -1,10 +1,13 @@
 #pragma once
+#include "analysis/liveness/types.hpp"
 #include "easm/easm.hpp"
 #include "pe/pe.hpp"
 #include "util/random.hpp"
 
 #include <list>
+#include <optional>
 #include <unordered_set>
+#include <vector>
 
 namespace analysis {
     using RegID = zasm::Reg::Id;
@@ -57,6 +60,11 @@ namespace analysis {
                 return random();
             }
 
+            /// Try the preferred registers first
+            if (const auto preferred = find_preferred(false); preferred.has_value()) {
+                return *preferred;
+            }
+
             return filter([this]() -> RegID {
                 /// Get the last recently used item
                 const auto lru = items_.back();
@@ -71,6 +79,11 @@ namespace analysis {
         /// \brief Get a random register across least used registers cache
         /// \return Register id
         [[nodiscard]] RegID random() {
+            /// Try the preferred registers first
+            if (const auto preferred = find_preferred(true); preferred.has_value()) {
+                return *preferred;
+            }
+
             return filter([this]() -> RegID {
                 /// Get a random register
                 const auto lru = rnd::item(items_);
@@ -93,6 +106,12 @@ namespace analysis {
             blacklisted_.clear();
         }
 
+        /// \brief Set the registers that should be returned first, if there are any of them in the cache
+        /// \param mask register mask, 0 to disable
+        void prefer(const reg_mask_t mask) noexcept {
+            preferred_ = mask;
+        }
+
         /// \brief An object that will clear blacklist in its destructor
         struct blacklist_state_t {
             explicit blacklist_state_t(LRURegContainer* container): container(container) { }
@@ -110,6 +129,33 @@ namespace analysis {
         }
 
     private:
+        /// \brief Find the preferred register that isn't blacklisted, and mark it as recently used
+        /// \param return_random should we choose a random register across preferred registers?
+        /// \return Register id, nullopt if there are no such registers
+        [[nodiscard]] std::optional<RegID> find_preferred(const bool return_random) {
+            if (preferred_ == 0) {
+                return std::nullopt;
+            }
+
+            /// Collect the candidates, least recently used first
+            std::vector<RegID> candidates = {};
+            for (auto it = items_.rbegin(); it != items_.rend(); std::advance(it, 1)) {
+                if ((preferred_ & reg_mask(zasm::Reg{*it})) != 0 && !blacklisted_.contains(*it)) {
+                    candidates.emplace_back(*it);
+                }
+            }
+
+            if (candidates.empty()) {
+                return std::nullopt;
+            }
+
+            /// Mark as recently used
+            const auto result = return_random ? rnd::item(candidates) : candidates.front();
+            items_.remove(result);
+            items_.push_front(result);
+            return result;
+        }
+
         /// \brief Filter out blacklisted values
         /// \param callback callback that should return RegID
         /// \return filtered RegID that isn't blacklisted
@@ -125,6 +171,8 @@ namespace analysis {
 
         /// \brief Temporary blacklisted registers
         std::unordered_set<RegID> blacklisted_ = {};
+        /// \brief Registers that should be returned first
+        reg_mask_t preferred_ = 0;
         /// \brief Items storage itself
         std::list<RegID> items_ = {};
         /// \brief Unordered set for a bit faster contains checks
@@ -173,6 +221,12 @@ namespace analysis {
             storage_.clear_blacklist();
         }
 
+        /// \brief Set the registers that should be returned first
+        /// \param mask register mask, 0 to disable
+        void prefer(const reg_mask_t mask) noexcept {
+            storage_.prefer(mask);
+        }
+
         /// \brief Create a raii auto blacklist cleaner
         /// \return RAII object that will clear the blacklist in dctor
         [[nodiscard]] LRURegContainer::blacklist_state_t auto_cleaner() noexcept {
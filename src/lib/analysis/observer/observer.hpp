@@ -11,6 +11,12 @@ namespace analysis {
     public:
         NON_COPYABLE(Observer);
 
+        /// \brief Number of instructions that were inserted/destroyed since the observer was attached
+        struct counters_t {
+            std::size_t inserted = 0;
+            std::size_t destroyed = 0;
+        };
+
         /// \brief Init the observer
         /// \param program zasm program that it should be attached to
         /// \param bb_storage already analysed basic block storage
@@ -31,6 +37,9 @@ namespace analysis {
         /// </summary>
         /// <param name="node">The node which will be destroyed</param>
         void onNodeDestroy(zasm::Node* node) override {
+            /// Count it, even if we're stopped
+            counters_.destroyed += node->holds<zasm::Instruction>() ? 1 : 0;
+
             /// Return if stopped
             if (stopped_) {
                 return;
@@ -44,7 +53,7 @@ namespace analysis {
 
             /// Erase the node
             pair->first->instructions.erase(pair->second);
-            pair->first->dirty = true;
+            pair->first->mark_dirty();
         }
 
         /// <summary>
@@ -52,6 +61,9 @@ namespace analysis {
         /// </summary>
         /// <param name="node">The node which was inserted</param>
         void onNodeInserted(zasm::Node* node) override {
+            /// Count it, even if we're stopped
+            counters_.inserted += node->holds<zasm::Instruction>() ? 1 : 0;
+
             /// Return if stopped
             if (stopped_) {
                 return;
@@ -90,7 +102,7 @@ namespace analysis {
                 if (auto [bb, insn] = *prev_pair; //
                     ((*insn)->is_jump() && !(*insn)->is_conditional_jump()) || //
                     !next_pair.has_value()) {
-                    return insert_to(bb, insn + 1); // +1 because we want to insert it **after** the prev item
+                    return insert_to(bb, std::next(insn)); // next because we want to insert it **after** the prev item
                 }
             }
 
@@ -129,6 +141,11 @@ namespace analysis {
             return stopped_;
         }
 
+        /// \brief Get the inserted/destroyed instruction counters
+        [[nodiscard]] const counters_t& counters() const {
+            return counters_;
+        }
+
     private:
         /// \brief
         /// \param node
@@ -156,14 +173,9 @@ namespace analysis {
                 return std::nullopt;
             }
 
-            /// Return info
-            auto iter = std::ranges::find_if(insn_info->bb_ref->instructions, [&](const auto& ptr) -> bool {
-                return ptr.get() == insn_info; //
-            });
-            assert(iter != std::end(insn_info->bb_ref->instructions));
-
-            /// Not found
-            return std::make_optional(std::make_pair(insn_info->bb_ref, iter));
+            /// Instructions know their position within the bb, so there's no need to look it up
+            assert(insn_info->bb_ref->instructions.contains(insn_info));
+            return std::make_optional(std::make_pair(insn_info->bb_ref, insn_info->bb_ref->instructions.iterator_to(insn_info)));
         }
 
         /// \brief Zasm program instance that we're gonna analyze each time
@@ -175,5 +187,7 @@ namespace analysis {
         std::shared_ptr<functional_bb_provider_t> bb_provider_ = {};
         /// \brief Start/stop
         bool stopped_ = false;
+        /// \brief Inserted/destroyed instructions
+        counters_t counters_ = {};
     };
 } // namespace analysis
@@ -0,0 +1,18 @@
+#pragma once
+#include "analysis/analysis.hpp"
+#include "analysis/liveness/liveness.hpp"
+#include "util/structs.hpp"
+
+namespace analysis::passes {
+    template <pe::any_image_t Img>
+    struct liveness_t {
+        DEFAULT_CTOR_DTOR(liveness_t);
+        NON_COPYABLE(liveness_t);
+
+        static bool apply(Function<Img>* function, Img*) {
+            /// Compute the initial state, this should be the last pass as the other ones could change the instructions
+            liveness::update(*function->bb_storage);
+            return true;
+        }
+    };
+} // namespace analysis::passes
@@ -0,0 +1,22 @@
+#pragma once
+#include "analysis/analysis.hpp"
+#include "analysis/loops/loops.hpp"
+#include "util/logger.hpp"
+#include "util/structs.hpp"
+
+namespace analysis::passes {
+    template <pe::any_image_t Img>
+    struct loops_t {
+        DEFAULT_CTOR_DTOR(loops_t);
+        NON_COPYABLE(loops_t);
+
+        static bool apply(Function<Img>* function, Img*) {
+            const auto entry = function->bb_storage->find_by_start_rva(function->parsed_func.rva);
+            const auto loops_count = loops::update(*function->bb_storage, entry.value_or(nullptr));
+            if (loops_count > 0) {
+                logger::debug("analysis: found {} loop(s) in {}", loops_count, function->parsed_func.name);
+            }
+            return true;
+        }
+    };
+} // namespace analysis::passes
@@ -8,7 +8,7 @@ namespace analysis::passes {
         DEFAULT_CTOR_DTOR(reloc_marker_t);
         NON_COPYABLE(reloc_marker_t);
 
-        static bool apply_insn(Function<Img>* function [[maybe_unused]], insn_t& instruction, Img* image) {
+        static bool apply_insn(Function<Img>* function, insn_t& instruction, Img* image) {
             // Would be set to true if instruction contains imm/ip operands
             //
             const zasm::Imm* imm = instruction.find_operand_if<zasm::Imm>();
@@ -62,9 +62,10 @@ namespace analysis::passes {
                         .offset = std::make_optional<std::uint8_t>(static_cast<std::uint8_t>(offset)),
                     };
 
-                    // Erase the stored reloc info
+                    // Remember the consumed reloc info, it would be erased from the image once all the functions
+                    // are analysed, as the image is shared between the analysis workers
                     //
-                    image->relocations.erase(iter);
+                    function->consumed_relocations.emplace_back(iter->first);
 
                     return true;
                 }
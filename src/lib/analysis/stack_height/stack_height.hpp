@@ -0,0 +1,160 @@
+#pragma once
+#include "analysis/common/common.hpp"
+#include "analysis/liveness/types.hpp"
+#include "easm/misc/misc.hpp"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/// \note Stack pointer tracking, the height is an offset of sp relative to its value at the function entry (so it's
+/// negative within the function body). We're tracking only the simple stuff (push/pop, add/sub with imm, etc), as soon as sp
+/// (or an address derived from it) gets copied somewhere or modified in some other way we're giving up, because we can't reason
+/// about such code anymore.
+namespace analysis::stack_height {
+    /// \brief Heights before every instruction
+    using heights_t = std::unordered_map<const insn_t*, std::int64_t>;
+
+    /// \brief Get the stack pointer delta of the instruction
+    /// \param machine_mode machine mode
+    /// \param insn instruction
+    /// \return delta in bytes, nullopt if we don't know what the instruction does with sp
+    [[nodiscard]] inline std::optional<std::int64_t> delta(const zasm::MachineMode machine_mode, const insn_t& insn) {
+        const auto ptr_size = static_cast<std::int64_t>(machine_mode == zasm::MachineMode::AMD64 ? sizeof(std::uint64_t) : sizeof(std::uint32_t));
+        const auto& ref = *insn.ref;
+
+        /// Size of the pushed/popped operand, imms are always pushed as uintptr
+        auto operand_size = [&]() -> std::int64_t {
+            if (ref.getOperandCount() == 0 || ref.getOperandIf<zasm::Imm>(0) != nullptr) {
+                return ptr_size;
+            }
+            return static_cast<std::int64_t>(getBitSize(easm::get_operand_size(machine_mode, &ref, 0).value_or(zasm::BitSize::_0)) / CHAR_BIT);
+        };
+
+        switch (static_cast<ZydisMnemonic>(ref.getMnemonic().value())) {
+        case ZYDIS_MNEMONIC_PUSH:
+            /// `push rsp` copies sp to the stack
+            if (const auto* op_reg = ref.getOperandIf<zasm::Reg>(0); op_reg != nullptr && easm::is_sp(machine_mode, *op_reg)) {
+                return std::nullopt;
+            }
+            return -operand_size();
+        case ZYDIS_MNEMONIC_POP:
+            /// `pop rsp` is a thing too
+            if (const auto* op_reg = ref.getOperandIf<zasm::Reg>(0); op_reg != nullptr && easm::is_sp(machine_mode, *op_reg)) {
+                return std::nullopt;
+            }
+            return operand_size();
+        case ZYDIS_MNEMONIC_PUSHFD:
+        case ZYDIS_MNEMONIC_PUSHFQ:
+            return -ptr_size;
+        case ZYDIS_MNEMONIC_POPFD:
+        case ZYDIS_MNEMONIC_POPFQ:
+            return ptr_size;
+        case ZYDIS_MNEMONIC_RET:
+            return 0; // we're leaving the function anyway
+        case ZYDIS_MNEMONIC_CALL:
+            /// x86 callees could release their args (stdcall, thiscall, etc), we don't know how much they're taking
+            if (machine_mode != zasm::MachineMode::AMD64) {
+                return std::nullopt;
+            }
+            return 0;
+        default:
+            break;
+        }
+
+        /// sp shouldn't be copied anywhere, we won't be able to track it after that
+        for (std::size_t i = 1; i < ref.getOperandCount(); ++i) {
+            if (const auto* op_reg = ref.getOperandIf<zasm::Reg>(i); op_reg != nullptr && easm::is_sp(machine_mode, *op_reg)) {
+                return std::nullopt;
+            }
+        }
+
+        /// Everything else shouldn't touch sp, except for the `add/sub/lea sp, ...`
+        const auto* dst = ref.getOperandCount() > 0 ? ref.getOperandIf<zasm::Reg>(0) : nullptr;
+
+        /// Loads/stores through sp are fine, but the address itself shouldn't escape anywhere (`lea rbp, [rsp+X]`)
+        if (ref.getMnemonic().value() == ZYDIS_MNEMONIC_LEA && (dst == nullptr || !easm::is_sp(machine_mode, *dst))) {
+            for (std::size_t i = 0; i < ref.getOperandCount(); ++i) {
+                const auto* mem = ref.getOperandIf<zasm::Mem>(i);
+                if (mem != nullptr && (easm::is_sp(machine_mode, mem->getBase()) || easm::is_sp(machine_mode, mem->getIndex()))) {
+                    return std::nullopt;
+                }
+            }
+        }
+        if (dst == nullptr || !easm::is_sp(machine_mode, *dst)) {
+            /// Implicit modifications (enter, leave, etc)
+            if ((insn.effects.written.regs & reg_mask(zasm::Reg(ZYDIS_REGISTER_RSP))) != 0) {
+                return std::nullopt;
+            }
+            return 0;
+        }
+
+        /// add/sub sp, imm
+        if (const auto* imm = ref.getOperandIf<zasm::Imm>(1); imm != nullptr) {
+            switch (static_cast<ZydisMnemonic>(ref.getMnemonic().value())) {
+            case ZYDIS_MNEMONIC_ADD:
+                return imm->value<std::int64_t>();
+            case ZYDIS_MNEMONIC_SUB:
+                return -imm->value<std::int64_t>();
+            default:
+                return std::nullopt;
+            }
+        }
+
+        /// lea sp, [sp + disp]
+        if (const auto* mem = ref.getOperandIf<zasm::Mem>(1); mem != nullptr && ref.getMnemonic().value() == ZYDIS_MNEMONIC_LEA) {
+            if (easm::is_sp(machine_mode, mem->getBase()) && !mem->getIndex().isValid()) {
+                return mem->getDisplacement();
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    /// \brief Compute the stack heights for every instruction that is reachable from the entry
+    /// \param entry function entry block
+    /// \return heights, nullopt if the height is unknown somewhere or if the paths are disagreeing on it
+    [[nodiscard]] inline std::optional<heights_t> compute(const bb_t* entry) {
+        if (entry == nullptr) {
+            return std::nullopt;
+        }
+
+        heights_t result = {};
+        std::unordered_map<const bb_t*, std::int64_t> bb_heights = {{entry, 0}};
+        std::vector<const bb_t*> worklist = {entry};
+        while (!worklist.empty()) {
+            const auto* bb = worklist.back();
+            worklist.pop_back();
+
+            auto height = bb_heights.at(bb);
+            for (const auto* insn : bb->instructions) {
+                /// We don't know where it's going to, so we can't propagate anything
+                if ((insn->flags & UNABLE_TO_ESTIMATE_JCC) != 0) {
+                    return std::nullopt;
+                }
+
+                const auto insn_delta = delta(bb->machine_mode, *insn);
+                if (!insn_delta.has_value()) {
+                    return std::nullopt;
+                }
+
+                result[insn] = height;
+                height += *insn_delta;
+            }
+
+            for (const auto* successor : bb->successors()) {
+                const auto [it, inserted] = bb_heights.try_emplace(successor, height);
+                if (inserted) {
+                    worklist.emplace_back(successor);
+                    continue;
+                }
+
+                if (it->second != height) {
+                    return std::nullopt;
+                }
+            }
+        }
+
+        return result;
+    }
+} // namespace analysis::stack_height
@@ -10,7 +10,7 @@ namespace analysis {
         zasm::Reg root_reg;
         /// Variable bitsize
         zasm::BitSize bit_size;
-        /// Stack space that this variable takes (in bytes)
+        /// Stack space that this variable takes (in bytes), 0 if the register was dead and we don't need to save it
         std::size_t stack_space;
 
         /// Implicit conversion to Gp so that we can pass this to the assembler methods
@@ -35,12 +35,23 @@ namespace analysis {
         }
     };
 
+    /// Registers that were saved on stack, accumulated across the allocators of a function
+    struct spills_t {
+        std::size_t registers = 0;
+        std::size_t bytes = 0;
+    };
+
     template <pe::any_image_t Img>
     class VarAlloc {
     public:
         DEFAULT_CTOR_DTOR(VarAlloc);
         DEFAULT_COPY(VarAlloc);
-        explicit VarAlloc(LRUReg<Img>* lru_reg): lru_reg_(lru_reg) { }
+        /// \param lru_reg LRU registers storage
+        /// \param dead_regs registers that are dead where the variables are used, they're allocated first and aren't saved on stack
+        /// \param live_flags status flags that are alive where the variables are used, flags are saved only if there are any
+        /// \param spills optional spills accumulator, every register that we actually save on stack is accounted there
+        explicit VarAlloc(LRUReg<Img>* lru_reg, const reg_mask_t dead_regs = 0, const flags_mask_t live_flags = kAllFlags, spills_t* spills = nullptr)
+            : lru_reg_(lru_reg), dead_regs_(dead_regs), live_flags_(live_flags), spills_(spills) { }
 
         /// \brief Get least recently used register as Gp8
         /// \param random should we choose a random register across least recently used registers?
@@ -85,10 +96,13 @@ namespace analysis {
             return filter([this, bit_size, random]() -> zasm::Reg { return lru_reg_->get_for_bits(bit_size, random); });
         }
 
-        /// \brief Push flags to stack
+        /// \brief Push flags to stack, if any of them are alive
         /// \param assembler zasm assembler ptr
-        static void push_flags(zasm::x86::Assembler* assembler) {
-            /// \fixme @es3n1n: we should track the instructions that affect CF instead
+        void push_flags(zasm::x86::Assembler* assembler) const {
+            if (live_flags_ == 0) {
+                return;
+            }
+
             if constexpr (pe::is_x64_v<Img>) {
                 assembler->pushfq();
             } else {
@@ -96,17 +110,26 @@ namespace analysis {
             }
         }
 
-        /// \brief Push all used variables on stack
+        /// \brief Push all used variables that we should save on stack, the saves are accounted in the spills accumulator
         /// \param assembler zasm assembler ptr
         void push(zasm::x86::Assembler* assembler) const {
-            for (const auto& reg_id : registers_in_use_) {
+            for (const auto& reg_id : registers_to_save_) {
                 assembler->push(zasm::x86::Gp(reg_id));
             }
+
+            if (spills_ != nullptr) {
+                spills_->registers += registers_to_save_.size();
+                spills_->bytes += stack_space_used_;
+            }
         }
 
-        /// \brief Pop flags from stack
+        /// \brief Pop flags from stack, if we saved them
         /// \param assembler zasm assembler ptr
-        static void pop_flags(zasm::x86::Assembler* assembler) {
+        void pop_flags(zasm::x86::Assembler* assembler) const {
+            if (live_flags_ == 0) {
+                return;
+            }
+
             if constexpr (pe::is_x64_v<Img>) {
                 assembler->popfq();
             } else {
@@ -114,10 +137,10 @@ namespace analysis {
             }
         }
 
-        /// \brief Pop all used variables from stack
+        /// \brief Pop all used variables that we saved from stack
         /// \param assembler zasm assembler ptr
         void pop(zasm::x86::Assembler* assembler) const {
-            for (auto it = registers_in_use_.rbegin(); it != registers_in_use_.rend(); std::advance(it, 1)) {
+            for (auto it = registers_to_save_.rbegin(); it != registers_to_save_.rend(); std::advance(it, 1)) {
                 assembler->pop(zasm::x86::Gp(*it));
             }
         }
@@ -126,6 +149,7 @@ namespace analysis {
         void clear() {
             stack_space_used_ = 0;
             registers_in_use_.clear();
+            registers_to_save_.clear();
         }
 
         /// \brief Estimate how many bytes would we need for storing all the symbolic vars
@@ -139,22 +163,34 @@ namespace analysis {
         /// \param callback callback that should return allocated reg
         /// \return sym var
         [[nodiscard]] SymVar filter(const std::function<zasm::Reg()>& callback) {
+            /// Prefer the dead registers that we didn't allocate yet, so that we wouldn't have to save them
+            reg_mask_t allocated = 0;
+            for (const auto reg_id : registers_in_use_) {
+                allocated |= reg_mask(zasm::Reg(reg_id));
+            }
+            lru_reg_->prefer(static_cast<reg_mask_t>(dead_regs_ & ~allocated));
+
             zasm::Reg result;
             RegID gp_ptr_id;
             do {
                 result = callback();
                 gp_ptr_id = lru_reg_->to_gp_ptr(result.getId());
             } while (std::ranges::find(registers_in_use_, gp_ptr_id) != std::end(registers_in_use_));
+            lru_reg_->prefer(0);
 
-            /// Save the gp ptr as register in use
+            /// Save the gp ptr as register in use, and remember that we should save it if it's alive
+            const bool is_dead = (dead_regs_ & reg_mask(zasm::Reg(gp_ptr_id))) != 0;
             registers_in_use_.emplace_back(gp_ptr_id);
+            if (!is_dead) {
+                registers_to_save_.emplace_back(gp_ptr_id);
+            }
 
             /// Construct the symbolic var
             const auto result_var = SymVar{
                 .reg = result,
                 .root_reg = zasm::Reg(gp_ptr_id),
                 .bit_size = result.getBitSize(lru_reg_->machine_mode()),
-                .stack_space = getBitSize(zasm::Reg(gp_ptr_id).getBitSize(lru_reg_->machine_mode())) / CHAR_BIT,
+                .stack_space = is_dead ? 0 : getBitSize(zasm::Reg(gp_ptr_id).getBitSize(lru_reg_->machine_mode())) / CHAR_BIT,
             };
 
             /// Update the stack space
@@ -165,9 +201,17 @@ namespace analysis {
 
         /// \brief A list of gp64 registers that we are already using
         std::list<RegID> registers_in_use_ = {};
+        /// \brief A list of gp64 registers that are alive, so we should save them on stack
+        std::list<RegID> registers_to_save_ = {};
         /// \brief How many bytes would we need for storing all allocated vars
         std::size_t stack_space_used_ = 0;
         /// \brief LRU registers storage
         LRUReg<Img>* lru_reg_ = nullptr;
+        /// \brief Registers that are dead at the point where the variables are used
+        reg_mask_t dead_regs_ = 0;
+        /// \brief Status flags that are alive at the point where the variables are used
+        flags_mask_t live_flags_ = kAllFlags;
+        /// \brief Spills accumulator
+        spills_t* spills_ = nullptr;
     };
 } // namespace analysis
\ No newline at end of file
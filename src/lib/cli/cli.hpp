@@ -8,9 +8,15 @@ namespace cli {
         /// { { name, arg1, arg2 }, description }
         constexpr auto kCLIOptionsHelp = std::to_array<std::pair<std::array<std::string_view, 3>, std::string_view>>({
             {{"-h, --help", "", ""}, "This message"},
+            {{"--verbose", "", ""}, "Collect and log the per-function/per-block cost reports"},
             {{"-pdb", "[path]", ""}, "Set custom .pdb file location"},
             {{"-map", "[path]", ""}, "Set custom .map file location"},
+            {{"-j, --jobs", "[count]", ""}, "Set the number of worker threads (0 - all cores)"},
+            {{"-profile", "[path]", ""}, "Set the execution profile (rva/hits pairs), hot blocks are obfuscated less"},
+            {{"--trace", "[path]", ""}, "Save the Chrome trace json (chrome://tracing, ui.perfetto.dev)"},
+            {{"--stats", "[path]", ""}, "Save the per-function/per-transform stats json"},
             {{"-f", "[name]", ""}, "Start new function configuration"},
+            {{"-max-overhead", "[value]", ""}, "Set the function overhead budget (`30%` of cycles, or `4096` bytes)"},
             {{"-t", "[name]", ""}, "Start new transform configuration"},
             {{"-g", "[name]", ""}, "Start new transform global configuration"},
             {{"-v", "[name]", "[value]"}, "Push value"},
@@ -56,7 +62,7 @@ namespace cli {
 
             /// Dump all vars + their defaults
             for (const auto& name : obfuscator::detail::kSharedConfigsVariableNames) {
-                logger::info<1>("{:<12} -- default: {}", name, shared_cfg.stringify_var(name));
+                logger::info<1>("{:<16} -- default: {}", name, shared_cfg.stringify_var(name));
             }
         }
     } // namespace detail
@@ -1,6 +1,7 @@
 #include "config_parser/config_parser.hpp"
 #include "cli/cli.hpp"
 #include "obfuscator/transforms/configs.hpp"
+#include "util/string_parser.hpp"
 
 namespace config_parser {
     Config from_argv(std::size_t argc, char* argv[]) {
@@ -17,14 +18,14 @@ namespace config_parser {
 
         /// Allocate result
         Config result = {};
-        auto& [binary_path_value] = result.obfuscator_config();
+        auto& obfuscator_config = result.obfuscator_config();
         auto& func_parser_config = result.func_parser_config();
 
         /// Get some stuff for transforms resolving
         auto& shared_config_storage = obfuscator::TransformSharedConfigStorage::get();
 
         /// Save the binary path
-        binary_path_value = binary_path;
+        obfuscator_config.binary_path = binary_path;
 
         /// Some state stuff for parser
         struct {
@@ -68,6 +69,12 @@ namespace config_parser {
                 continue;
             }
 
+            /// Cost reports
+            if (arg_ == "--verbose") {
+                obfuscator_config.verbose = true;
+                continue;
+            }
+
             /// PDB path
             if (arg_ == "-pdb") {
                 func_parser_config.pdb_enabled = true;
@@ -84,6 +91,34 @@ namespace config_parser {
                 continue;
             }
 
+            /// Number of worker threads
+            if ((arg_ == "-j" || arg_ == "--jobs") && next_arg_.has_value()) {
+                obfuscator_config.jobs = util::string::parse_uint32(next_arg_.value());
+                skip(1);
+                continue;
+            }
+
+            /// Execution profile path
+            if (arg_ == "-profile" && next_arg_.has_value()) {
+                obfuscator_config.profile_path = next_arg_;
+                skip(1);
+                continue;
+            }
+
+            /// Chrome trace output path
+            if ((arg_ == "-trace" || arg_ == "--trace") && next_arg_.has_value()) {
+                obfuscator_config.trace_path = next_arg_;
+                skip(1);
+                continue;
+            }
+
+            /// Per-transform stats output path
+            if ((arg_ == "-stats" || arg_ == "--stats") && next_arg_.has_value()) {
+                obfuscator_config.stats_path = next_arg_;
+                skip(1);
+                continue;
+            }
+
             /// Function start
             if (arg_ == "-f" && next_arg_.has_value()) {
                 state.current_function = &result.create_function_config();
@@ -92,6 +127,19 @@ namespace config_parser {
                 continue;
             }
 
+            /// Function overhead budget, either `30%` or `4096` (bytes)
+            if (arg_ == "-max-overhead" && next_arg_.has_value() && state.busy()) {
+                const auto& value = next_arg_.value();
+                const bool is_percent = value.ends_with('%');
+
+                state.current_function->max_overhead = overhead_budget_t{
+                    .kind = is_percent ? overhead_budget_t::e_kind::PERCENT : overhead_budget_t::e_kind::BYTES,
+                    .value = util::string::parse_uint32(is_percent ? value.substr(0, value.size() - 1) : value),
+                };
+                skip(1);
+                continue;
+            }
+
             /// Transform configuration start
             if (arg_ == "-t" && next_arg_.has_value() && state.busy()) {
                 state.current_transform = &state.current_function->transform_configurations.emplace_back();
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <unordered_map>
@@ -10,13 +11,30 @@ namespace config_parser {
         std::unordered_map<std::string, std::string> values = {};
     };
 
+    /// \brief Max overhead that transforms are allowed to add, either in percents of the estimated cycles or in added bytes
+    struct overhead_budget_t {
+        enum class e_kind : std::uint8_t {
+            PERCENT = 0,
+            BYTES,
+        };
+
+        e_kind kind = e_kind::PERCENT;
+        std::size_t value = 0;
+    };
+
     struct function_configuration_t {
         std::string function_name = {};
         std::vector<transform_configuration_t> transform_configurations = {};
+        std::optional<overhead_budget_t> max_overhead = std::nullopt;
     };
 
     struct obfuscator_config_t {
         std::filesystem::path binary_path = "";
+        std::size_t jobs = 0; // 0 - use all the available hardware threads
+        std::optional<std::filesystem::path> profile_path = std::nullopt;
+        std::optional<std::filesystem::path> trace_path = std::nullopt;
+        std::optional<std::filesystem::path> stats_path = std::nullopt;
+        bool verbose = false; // collect and log the per-function cost reports
     };
 
     struct func_parser_config_t {
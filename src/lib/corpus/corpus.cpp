@@ -0,0 +1,294 @@
+#include "corpus/corpus.hpp"
+#include "easm/assembler/assembler.hpp"
+#include "util/files.hpp"
+#include "util/memory/casts.hpp"
+#include "util/sections.hpp"
+
+#include <algorithm>
+#include <format>
+#include <memory>
+
+namespace corpus {
+    namespace {
+        constexpr std::uint32_t kSectionAlignment = 0x1000;
+        constexpr std::uint32_t kFileAlignment = 0x200;
+        constexpr std::uint32_t kHeadersSize = 0x400;
+        constexpr std::uint32_t kCodeRva = kSectionAlignment;
+        constexpr std::uint8_t kPaddingByte = 0xCC; // int3
+
+        /// \brief Data section layout, the relocated immediates are pointing to the first slot, jump tables go after it
+        constexpr std::uint32_t kDataSlotSize = 0x10;
+        constexpr win::section_characteristics_t kDataCharacteristics = {.flags = 0x40000040}; // read, init
+
+        /// \brief The data section address is unknown until the code is assembled, so we're assembling it with this placeholder
+        /// first. It's big enough to be encoded as disp32/imm32, so it doesn't affect the code size
+        constexpr std::uint32_t kPlaceholderRva = 0x7FFF0000;
+
+        template <pe::any_raw_image_t Img>
+        constexpr bool kIsX64 = std::is_same_v<Img, win::image_x64_t>;
+
+        template <pe::any_raw_image_t Img>
+        constexpr std::uint64_t kImageBase = kIsX64<Img> ? 0x140000000ULL : 0x400000ULL;
+
+        /// \brief Generated code and the labels that we need to link it
+        struct code_t {
+            std::unique_ptr<zasm::Program> program = nullptr;
+            /// \brief Function entries
+            std::vector<zasm::Label> functions = {};
+            /// \brief Jump table entries, every table has `jump_table_fanout` of them
+            std::vector<zasm::Label> jump_table_entries = {};
+            /// \brief Labels that are bound right after the instructions with relocated immediates, the immediates are
+            /// always the last bytes of these instructions
+            std::vector<zasm::Label> relocations = {};
+            std::size_t instructions = 0;
+        };
+
+        /// \brief Check whether the function gets a jump table
+        [[nodiscard]] bool has_jump_table(const config_t& config) {
+            return config.jump_table_fanout > 0 && config.blocks >= 3;
+        }
+
+        /// \brief Get the jump table rva
+        [[nodiscard]] std::uint32_t jump_table_rva(const config_t& config, const std::uint32_t data_rva, const std::size_t index) {
+            /// Tables are terminated with a zero, so that the bb_decomp doesn't treat the next table as a part of this one
+            const auto table_size = (config.jump_table_fanout + 1) * sizeof(std::uint32_t);
+            return static_cast<std::uint32_t>(data_rva + kDataSlotSize + index * table_size);
+        }
+
+        /// \brief Emit the function code
+        /// \param config configuration
+        /// \param data_rva data section rva
+        template <pe::any_raw_image_t Img>
+        [[nodiscard]] code_t emit(const config_t& config, const std::uint32_t data_rva) {
+            using namespace zasm::x86;
+            constexpr auto kImgBase = kImageBase<Img>;
+            const auto machine_mode = kIsX64<Img> ? zasm::MachineMode::AMD64 : zasm::MachineMode::I386;
+
+            code_t result = {.program = std::make_unique<zasm::Program>(machine_mode)};
+            Assembler as(*result.program);
+
+            /// Jump tables are using eax/ecx/edx, the blocks are using the rest
+            const std::array regs = {ebx, esi, edi};
+            const auto ptr_a = kIsX64<Img> ? Gp(rax) : Gp(eax);
+            const auto ptr_c = kIsX64<Img> ? Gp(rcx) : Gp(ecx);
+            const auto ptr_d = kIsX64<Img> ? Gp(rdx) : Gp(edx);
+            const auto ptr_size = kIsX64<Img> ? zasm::BitSize::_64 : zasm::BitSize::_32;
+
+            auto relocated = [&]() -> void {
+                const auto label = as.createLabel();
+                as.bind(label);
+                result.relocations.emplace_back(label);
+            };
+
+            for (std::size_t func = 0; func < config.functions; ++func) {
+                std::vector<zasm::Label> blocks(config.blocks);
+                std::ranges::generate(blocks, [&as]() -> zasm::Label { return as.createLabel(); });
+                result.functions.emplace_back(blocks.front());
+
+                for (std::size_t block = 0; block < config.blocks; ++block) {
+                    as.bind(blocks[block]);
+
+                    /// MSVC-like jump table
+                    /// cmp ecx, N - 1; ja default; mov eax, ecx; lea rdx, [__ImageBase]; mov ecx, [rdx+rax*4+table]; add rcx, rdx; jmp rcx
+                    if (block == 0 && has_jump_table(config)) {
+                        as.cmp(ecx, zasm::Imm(static_cast<std::int32_t>(config.jump_table_fanout - 1)));
+                        as.ja(blocks.back());
+                        as.mov(eax, ecx);
+                        if constexpr (kIsX64<Img>) {
+                            as.lea(rdx, zasm::Mem(ptr_size, zasm::Reg{}, rip, zasm::Reg{}, 0, static_cast<std::int64_t>(kImgBase)));
+                        } else {
+                            as.lea(edx, zasm::Mem(ptr_size, zasm::Reg{}, zasm::Reg{}, zasm::Reg{}, 0, static_cast<std::int64_t>(kImgBase)));
+                            relocated();
+                        }
+                        as.mov(ecx, dword_ptr(ptr_d, ptr_a, 4, jump_table_rva(config, data_rva, func)));
+                        as.add(ptr_c, ptr_d);
+                        as.jmp(ptr_c);
+                        result.instructions += 7;
+
+                        /// Spread the entries over the rest of the blocks
+                        for (std::size_t i = 0; i < config.jump_table_fanout; ++i) {
+                            result.jump_table_entries.emplace_back(blocks[1 + i * (config.blocks - 1) / config.jump_table_fanout]);
+                        }
+                        continue;
+                    }
+
+                    const auto& dst = regs[(func + block) % regs.size()];
+                    const auto& src = regs[(func + block + 1) % regs.size()];
+                    as.mov(dst, zasm::Imm(static_cast<std::int32_t>(block * 0x1337 + func)));
+                    as.add(dst, src);
+                    as.xor_(dst, zasm::Imm(static_cast<std::int32_t>(func * 0x11 ^ block)));
+                    result.instructions += 3;
+
+                    /// Relocated immediates are spread evenly over the blocks
+                    const auto relocations = (block + 1) * config.relocated_immediates / config.blocks - block * config.relocated_immediates / config.blocks;
+                    for (std::size_t i = 0; i < relocations; ++i) {
+                        as.mov(ptr_a, zasm::Imm(static_cast<std::int64_t>(kImgBase + data_rva)));
+                        relocated();
+                        as.add(dst, dword_ptr(ptr_a));
+                        result.instructions += 2;
+                    }
+
+                    /// The last block is the exit one, the rest of them are skipping their successors sometimes
+                    if (block + 1 == config.blocks) {
+                        as.ret();
+                        result.instructions += 1;
+                        continue;
+                    }
+
+                    as.cmp(dst, zasm::Imm(static_cast<std::int32_t>(block)));
+                    as.jnz(blocks[std::min(block + 2, config.blocks - 1)]);
+                    result.instructions += 2;
+                }
+            }
+
+            return result;
+        }
+
+        /// \brief Assemble the image headers
+        template <pe::any_raw_image_t Img>
+        [[nodiscard]] std::vector<std::uint8_t> make_headers(const std::size_t code_size) {
+            std::vector<std::uint8_t> result(kHeadersSize, 0);
+            auto* image = memory::cast<Img*>(result.data());
+
+            image->dos_header.e_magic = win::DOS_HDR_MAGIC;
+            image->dos_header.e_lfanew = sizeof(win::dos_header_t);
+
+            auto* nt_headers = image->get_nt_headers();
+            nt_headers->signature = win::NT_HDR_MAGIC;
+
+            auto& file_header = nt_headers->file_header;
+            file_header.machine = kIsX64<Img> ? win::machine_id::amd64 : win::machine_id::i386;
+            file_header.size_optional_header = sizeof(nt_headers->optional_header);
+            file_header.characteristics.flags = kIsX64<Img> ? 0x0022 : 0x0102; // executable, large address aware/32bit machine
+
+            auto& optional_header = nt_headers->optional_header;
+            optional_header.magic = kIsX64<Img> ? win::OPT_HDR64_MAGIC : win::OPT_HDR32_MAGIC;
+            optional_header.size_code = memory::address{code_size}.align_up(kFileAlignment).template as<std::uint32_t>();
+            optional_header.entry_point = kCodeRva;
+            optional_header.base_of_code = kCodeRva;
+            optional_header.image_base = kImageBase<Img>;
+            optional_header.section_alignment = kSectionAlignment;
+            optional_header.file_alignment = kFileAlignment;
+            optional_header.os_version.major = 6;
+            optional_header.subsystem_version.major = 6;
+            optional_header.size_headers = kHeadersSize;
+            optional_header.subsystem = win::subsystem_id::windows_cui;
+            optional_header.characteristics.flags = kIsX64<Img> ? 0x0160 : 0x0140; // (high entropy va), dynamic base, nx compat
+            optional_header.size_stack_reserve = 0x100000;
+            optional_header.size_stack_commit = 0x1000;
+            optional_header.size_heap_reserve = 0x100000;
+            optional_header.size_heap_commit = 0x1000;
+            optional_header.num_data_directories = static_cast<std::uint32_t>(std::size(optional_header.data_directories.entries));
+
+            return result;
+        }
+
+        /// \brief Resolve the label addresses as rvas
+        template <pe::any_raw_image_t Img>
+        [[nodiscard]] std::vector<std::uint32_t> to_rvas(const std::vector<memory::address>& addresses) {
+            std::vector<std::uint32_t> result(addresses.size());
+            std::ranges::transform(addresses, result.begin(), [](const memory::address address) -> std::uint32_t { //
+                return static_cast<std::uint32_t>(address.as<std::uint64_t>() - kImageBase<Img>);
+            });
+            return result;
+        }
+    } // namespace
+
+    template <pe::any_raw_image_t Img>
+    output_t generate(const config_t& config) {
+        if (config.functions == 0 || config.blocks == 0) {
+            throw std::runtime_error("corpus: there should be at least one function with one block");
+        }
+
+        /// Assemble the code with a placeholder first, so that we'd know where the data section is going to be
+        const auto code_size = easm::assemble_program(kImageBase<Img> + kCodeRva, *emit<Img>(config, kPlaceholderRva).program).data.size();
+        const auto data_rva = memory::address{kCodeRva + code_size}.align_up(kSectionAlignment).template as<std::uint32_t>();
+
+        /// Now we can assemble it for real
+        const auto code = emit<Img>(config, data_rva);
+        std::vector<zasm::Label> labels = {};
+        labels.insert(labels.end(), code.functions.begin(), code.functions.end());
+        labels.insert(labels.end(), code.jump_table_entries.begin(), code.jump_table_entries.end());
+        labels.insert(labels.end(), code.relocations.begin(), code.relocations.end());
+
+        std::vector<memory::address> addresses = {};
+        auto assembled = easm::assemble_program(kImageBase<Img> + kCodeRva, *code.program, labels, addresses);
+        if (assembled.data.size() != code_size) {
+            throw std::runtime_error(std::format("corpus: code size mismatch ({:#x} != {:#x})", assembled.data.size(), code_size));
+        }
+
+        const auto rvas = to_rvas<Img>(addresses);
+        const auto functions = std::span{rvas}.subspan(0, code.functions.size());
+        const auto entries = std::span{rvas}.subspan(functions.size(), code.jump_table_entries.size());
+        const auto relocations = std::span{rvas}.subspan(functions.size() + entries.size());
+
+        /// Init the image, we don't have any sections at this point
+        auto headers = make_headers<Img>(code_size);
+        pe::Image<Img> image(memory::cast<Img*>(headers.data()));
+
+        /// Code section goes right after the headers, `new_section` needs at least one section to be present
+        auto& text = image.sections.emplace_back();
+        std::ranges::copy(std::string_view{".text"}, text.name.begin());
+        text.virtual_address = kCodeRva;
+        text.virtual_size = static_cast<std::uint32_t>(code_size);
+        text.ptr_raw_data = kHeadersSize;
+        text.size_raw_data = memory::address{code_size}.align_up(kFileAlignment).template as<std::uint32_t>();
+        text.characteristics = sections::characteristics(sections::e_section_t::CODE);
+        text.raw_data = std::move(assembled.data);
+        text.raw_data.resize(text.size_raw_data, kPaddingByte);
+
+        /// Data section with the jump tables
+        const auto tables_count = has_jump_table(config) ? config.functions : 0;
+        const auto data_size = jump_table_rva(config, 0, tables_count);
+        auto& data = image.new_section(".rdata", data_size, kDataCharacteristics);
+        if (data.virtual_address != data_rva) {
+            throw std::runtime_error(std::format("corpus: data section rva mismatch ({:#x} != {:#x})", data.virtual_address, data_rva));
+        }
+
+        for (std::size_t i = 0; i < tables_count; ++i) {
+            auto* table = memory::cast<std::uint32_t*>(data.raw_data.mutable_data() + jump_table_rva(config, 0, i));
+            std::ranges::copy(entries.subspan(i * config.jump_table_fanout, config.jump_table_fanout), table);
+        }
+
+        /// Relocations, the rebuilder would assemble the `.reloc` section out of them
+        const auto ptr_size = image.template get_ptr_size<std::uint8_t>();
+        for (const auto end_rva : relocations) {
+            const auto rva = memory::address{end_rva - ptr_size};
+            image.relocations[rva] = pe::relocation_t{
+                .rva = rva,
+                .size = ptr_size,
+                .type = kIsX64<Img> ? win::reloc_type_id::rel_based_dir64 : win::reloc_type_id::rel_based_high_low,
+            };
+        }
+
+        /// Assemble the map and function list, function sizes are the distances between them
+        output_t result = {.image = image.rebuild_pe_image(), .instructions = code.instructions};
+        result.map = std::format(" corpus\n\n Preferred load address is {:016x}\n\n"
+                                 "  Address         Publics by Value              Rva+Base               Lib:Object\n\n",
+                                 kImageBase<Img>);
+        for (std::size_t i = 0; i < functions.size(); ++i) {
+            auto& function = result.functions.emplace_back();
+            function.valid = true;
+            function.name = std::format("fn_{}", i);
+            function.rva = functions[i];
+            function.size = (i + 1 < functions.size() ? functions[i + 1] : kCodeRva + code_size) - functions[i];
+
+            result.map += std::format(" 0001:{:08x}       {:<26} {:016x} f   corpus.obj\n", function.rva - kCodeRva, function.name,
+                                      kImageBase<Img> + function.rva);
+        }
+        result.map += std::format("\n entry point at        0001:{:08x}\n", 0);
+
+        return result;
+    }
+
+    void save(const output_t& output, const std::filesystem::path& path) {
+        util::write_file(path, output.image.data(), output.image.size());
+
+        auto map_path = path;
+        map_path.replace_extension(".map");
+        util::write_file(map_path, memory::cast<const std::uint8_t*>(output.map.data()), output.map.size());
+    }
+
+    template output_t generate<win::image_x64_t>(const config_t& config);
+    template output_t generate<win::image_x86_t>(const config_t& config);
+} // namespace corpus
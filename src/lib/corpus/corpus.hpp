@@ -0,0 +1,50 @@
+#pragma once
+#include "func_parser/common/common.hpp"
+#include "pe/pe.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/// \note Synthetic PE images generator, used for the scaling benchmarks/tests so that we don't have to ship
+/// huge binaries. The images consist of the `.text` section with the generated functions, `.rdata` with the jump tables
+/// and `.reloc`. Every function is a chain of blocks that are conditionally skipping their successors, with an optional
+/// MSVC-like jump table at the function entry and some relocated immediates in between.
+namespace corpus {
+    /// \brief Generator configuration
+    struct config_t {
+        /// \brief Number of functions
+        std::size_t functions = 16;
+        /// \brief Number of basic blocks per function
+        std::size_t blocks = 8;
+        /// \brief Number of jump table entries, 0 disables jump tables. The table is placed at the function entry
+        /// and it needs at least 3 blocks (the table, its targets and the default case)
+        std::size_t jump_table_fanout = 0;
+        /// \brief Number of relocated immediates per function
+        std::size_t relocated_immediates = 0;
+    };
+
+    /// \brief Generated image
+    struct output_t {
+        /// \brief PE image
+        std::vector<std::uint8_t> image = {};
+        /// \brief MSVC-like map file
+        std::string map = {};
+        /// \brief Functions with their sizes
+        func_parser::function_list_t functions = {};
+        /// \brief Total number of instructions
+        std::size_t instructions = 0;
+    };
+
+    /// \brief Generate the image
+    /// \tparam Img Raw image type, either x64 or x86
+    /// \param config configuration
+    /// \return image, map and function list
+    template <pe::any_raw_image_t Img>
+    [[nodiscard]] output_t generate(const config_t& config);
+
+    /// \brief Save the image and the map next to it (`path` with the `.map` extension)
+    /// \param output generated image
+    /// \param path image path
+    void save(const output_t& output, const std::filesystem::path& path);
+} // namespace corpus
@@ -43,28 +43,61 @@ namespace easm {
         return result;
     }
 
+    namespace {
+        void serialize(zasm::Serializer& serializer, const memory::address base_address, const zasm::Program& program) {
+            if (const auto err = serializer.serialize(program, base_address.as<std::int64_t>()); err != zasm::Error::None) {
+                throw std::runtime_error(std::format("Unable to serialize program: {}", getErrorName(err)));
+            }
+        }
+
+        assembled_t export_assembled(const zasm::Serializer& serializer) {
+            // Copying the result buffer
+            //
+            assembled_t result = {};
+            result.data.resize(serializer.getCodeSize());
+            std::memcpy(result.data.data(), serializer.getCode(), result.data.size());
+
+            // Store relocations
+            //
+            for (std::size_t i = 0; i < serializer.getRelocationCount(); ++i) {
+                result.relocations.emplace_back(*serializer.getRelocation(i));
+            }
+
+            return result;
+        }
+    } // namespace
+
     assembled_t assemble_program(const memory::address base_address, const zasm::Program& program) {
         zasm::Serializer serializer = {};
 
         // Serializing program
         //
-        if (const auto err = serializer.serialize(program, base_address.as<std::int64_t>()); err != zasm::Error::None) {
-            throw std::runtime_error(std::format("Unable to serialize program: {}", getErrorName(err)));
-        }
+        serialize(serializer, base_address, program);
+        return export_assembled(serializer);
+    }
+
+    assembled_t assemble_program(const memory::address base_address, const zasm::Program& program, const std::span<const zasm::Label> labels,
+                                 std::vector<memory::address>& label_addresses) {
+        zasm::Serializer serializer = {};
 
-        // Copying the result buffer
+        // Serializing program
         //
-        assembled_t result = {};
-        result.data.resize(serializer.getCodeSize());
-        std::memcpy(result.data.data(), serializer.getCode(), result.data.size());
+        serialize(serializer, base_address, program);
 
-        // Store relocations
+        // Resolving labels, they're bound to their final addresses at this point
         //
-        for (std::size_t i = 0; i < serializer.getRelocationCount(); ++i) {
-            result.relocations.emplace_back(*serializer.getRelocation(i));
+        label_addresses.clear();
+        label_addresses.reserve(labels.size());
+        for (const auto& label : labels) {
+            const auto address = serializer.getLabelAddress(label.getId());
+            if (address == -1) {
+                throw std::runtime_error(std::format("Unable to serialize program: label {} is not bound", static_cast<std::int32_t>(label.getId())));
+            }
+
+            label_addresses.emplace_back(static_cast<std::uintptr_t>(address));
         }
 
-        return result;
+        return export_assembled(serializer);
     }
 
     std::expected<std::vector<std::uint8_t>, zasm::Error> encode_jmp(const zasm::MachineMode machine_mode, const memory::address source,
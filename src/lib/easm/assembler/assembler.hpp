@@ -2,6 +2,7 @@
 #include "util/memory/address.hpp"
 #include <expected>
 #include <list>
+#include <span>
 #include <vector>
 #include <zasm/zasm.hpp>
 
@@ -13,5 +14,7 @@ namespace easm {
 
     std::size_t estimate_program_size(const zasm::Program& program);
     assembled_t assemble_program(memory::address base_address, const zasm::Program& program);
+    assembled_t assemble_program(memory::address base_address, const zasm::Program& program, std::span<const zasm::Label> labels,
+                                 std::vector<memory::address>& label_addresses);
     std::expected<std::vector<std::uint8_t>, zasm::Error> encode_jmp(zasm::MachineMode machine_mode, memory::address source, memory::address destination);
 } // namespace easm
@@ -193,4 +193,20 @@ namespace easm {
             return zasm::x86::dword_ptr(std::forward<TArgs>(args)...);
         }
     }
+
+    inline zasm::Mem ptr_for_bits(const zasm::BitSize bit_size, const zasm::x86::Gp base, const std::int64_t disp = 0) {
+        switch (getBitSize(bit_size)) {
+        case 8:
+            return zasm::x86::byte_ptr(base, disp);
+        case 16:
+            return zasm::x86::word_ptr(base, disp);
+        case 32:
+            return zasm::x86::dword_ptr(base, disp);
+        case 64:
+            return zasm::x86::qword_ptr(base, disp);
+        default:
+            break;
+        }
+        throw std::runtime_error("easm: unsupported memory operand size");
+    }
 } // namespace easm
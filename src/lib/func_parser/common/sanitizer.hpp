@@ -13,7 +13,7 @@ namespace func_parser::sanitizer {
 
         // Iterating over functions
         //
-        std::erase_if(items, [exec_sections](const function_t& item) -> bool {
+        std::erase_if(items, [&exec_sections](const function_t& item) -> bool {
             // Erasing invalid functions
             //
             if (!item.valid) {
@@ -24,8 +24,8 @@ namespace func_parser::sanitizer {
             // Checking whether function is in an executable section or not
             //
             bool in_exec_mem = false;
-            for (auto& sec : exec_sections) {
-                in_exec_mem = item.rva >= sec.virtual_address && item.rva <= (sec.virtual_address + sec.virtual_size);
+            for (const auto* sec : exec_sections) {
+                in_exec_mem = item.rva >= sec->virtual_address && item.rva <= (sec->virtual_address + sec->virtual_size);
 
                 if (in_exec_mem) {
                     break;
@@ -3,10 +3,13 @@
 #include "func_parser/map/map.hpp"
 #include "func_parser/pdb/pdb.hpp"
 #include "util/logger.hpp"
+#include "util/trace.hpp"
 
 namespace func_parser {
     template <pe::any_image_t Img>
     void Instance<Img>::collect_functions() {
+        const util::trace::Span _("func_parser: collect functions");
+
         // Parsing from all sources possible
         //
         parse();
@@ -45,6 +48,8 @@ namespace func_parser {
             return;
         }
 
+        const util::trace::Span _("func_parser: pdb");
+
         // Obtaining base of code
         //
         const auto base_of_code = image_->raw_image->get_nt_headers()->optional_header.base_of_code;
@@ -78,6 +83,8 @@ namespace func_parser {
             return;
         }
 
+        const util::trace::Span _("func_parser: map");
+
         // Trying to parse from a custom path first
         //
         if (config_.map_path.has_value()) {
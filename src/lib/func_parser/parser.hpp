@@ -29,6 +29,10 @@ namespace func_parser {
             return std::make_optional<function_t>(*iter);
         }
 
+        [[nodiscard]] const function_list_t& functions() const {
+            return function_list_;
+        }
+
     private:
         void parse();
         void parse_pdb();
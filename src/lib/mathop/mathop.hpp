@@ -3,6 +3,7 @@
 #include "util/random.hpp"
 #include "util/types.hpp"
 
+#include <optional>
 #include <vector>
 
 namespace mathop {
@@ -72,6 +73,18 @@ namespace mathop {
             return size_;
         }
 
+        /// \brief Estimate the cost of the revert operation
+        /// \return cost
+        [[nodiscard]] cost_t cost() const {
+            return operation_->cost(size_).value();
+        }
+
+        /// \brief Get the operation kind
+        /// \return kind
+        [[nodiscard]] Kind kind() const {
+            return operation_->kind();
+        }
+
     private:
         /// \brief Operation ptr
         Operation* operation_ = nullptr;
@@ -120,6 +133,18 @@ namespace mathop {
             }
         }
 
+        /// \brief Estimate the cost of the lifted reversion
+        /// \return cost
+        [[nodiscard]] cost_t cost() const {
+            cost_t result = {};
+
+            for (auto& operation : operations_) {
+                result += operation.cost();
+            }
+
+            return result;
+        }
+
         /// \brief Iterator begin
         /// \return operations begin
         [[nodiscard]] auto begin() {
@@ -149,6 +174,16 @@ namespace mathop {
         std::vector<OperationValue> operations_ = {};
     };
 
+    /// \brief Cost budget of the generated expression
+    struct budget_t {
+        /// \brief Latency budget in cycles
+        std::size_t cycles = 0;
+        /// \brief Encoded size budget in bytes, zero means unlimited
+        std::size_t bytes = 0;
+        /// \brief Don't put the operations of the same kind next to each other
+        bool avoid_chains = true;
+    };
+
     /// \brief Expression generator
     class ExpressionGenerator : public types::Singleton<ExpressionGenerator> {
     public:
@@ -164,6 +199,10 @@ namespace mathop {
             operations_.emplace_back(std::make_unique<operations::Xor>());
             operations_.emplace_back(std::make_unique<operations::Neg>());
             operations_.emplace_back(std::make_unique<operations::Not>());
+            operations_.emplace_back(std::make_unique<operations::LeaAdd>());
+            operations_.emplace_back(std::make_unique<operations::Rol>());
+            operations_.emplace_back(std::make_unique<operations::Ror>());
+            operations_.emplace_back(std::make_unique<operations::Bswap>());
         }
 
         /// \brief Generate a random math expression
@@ -172,17 +211,75 @@ namespace mathop {
         /// \return Expression
         [[nodiscard]] Expression generate(const zasm::BitSize bit_size, const std::size_t num_operations) {
             Expression result;
+            const auto operations = supported(bit_size);
 
             /// Generate the random expressions
             for (std::size_t i = 0; i < num_operations; ++i) {
-                auto& operation = rnd::item(operations_);
-                result.emplace_operation(operation.get(), bit_size);
+                result.emplace_operation(rnd::item(operations), bit_size);
+            }
+
+            return result;
+        }
+
+        /// \brief Generate a random math expression that fits into the cost budget
+        /// \note Every operation depends on the result of the previous one, so the latencies are just summed up.
+        /// The operations of the same kind are folding into a single one (add+sub, rol+ror, not+not, etc), chains of them
+        /// are serializing the execution without making the expression any stronger, thus the `avoid_chains` option.
+        /// \param bit_size Operands bit size
+        /// \param budget Cost budget
+        /// \return Expression
+        [[nodiscard]] Expression generate(const zasm::BitSize bit_size, const budget_t& budget) {
+            Expression result;
+            const auto operations = supported(bit_size);
+
+            cost_t spent = {};
+            std::optional<Kind> prev_kind = std::nullopt;
+            std::vector<Operation*> candidates = {};
+            while (true) {
+                /// Collect the operations that still fit into the budget
+                candidates.clear();
+                for (auto* operation : operations) {
+                    const auto cost = operation->cost(bit_size).value();
+                    if (spent.latency + cost.latency > budget.cycles) {
+                        continue;
+                    }
+                    if (budget.bytes != 0 && spent.size + cost.size > budget.bytes) {
+                        continue;
+                    }
+                    if (budget.avoid_chains && prev_kind == operation->kind()) {
+                        continue;
+                    }
+
+                    candidates.emplace_back(operation);
+                }
+
+                if (candidates.empty()) {
+                    break;
+                }
+
+                auto* operation = rnd::item(candidates);
+                spent += operation->cost(bit_size).value();
+                prev_kind = operation->kind();
+                result.emplace_operation(operation, bit_size);
             }
 
             return result;
         }
 
     private:
+        /// \brief Get the operations that are encodable with the operands size
+        /// \param bit_size Operands bit size
+        /// \return Operations
+        [[nodiscard]] std::vector<Operation*> supported(const zasm::BitSize bit_size) const {
+            std::vector<Operation*> result = {};
+            for (const auto& operation : operations_) {
+                if (operation->cost(bit_size).has_value()) {
+                    result.emplace_back(operation.get());
+                }
+            }
+            return result;
+        }
+
         /// \brief List of supported operations
         std::vector<std::unique_ptr<Operation>> operations_ = {};
     };
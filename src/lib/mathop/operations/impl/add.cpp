@@ -37,4 +37,17 @@ namespace mathop::operations {
     ArgumentImm Add::generate_rhs(const ArgumentImm lhs) const {
         return detail::generate_random_argument_in_range(lhs);
     }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost
+    std::optional<cost_t> Add::cost(const zasm::BitSize bit_size) const {
+        return cost_t{.latency = 1, .throughput = 0.25, .size = detail::encoded_size(bit_size, 2, detail::random_argument_size(bit_size))}; // sub r, imm
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Add::kind() const {
+        return Kind::ADDITIVE;
+    }
 } // namespace mathop::operations
\ No newline at end of file
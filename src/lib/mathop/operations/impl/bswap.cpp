@@ -0,0 +1,50 @@
+#include "mathop/operations/impl/util.hpp"
+
+namespace mathop::operations {
+    /// \brief Emulate the math operation under the two operands
+    /// \param op1 lhs
+    /// \return emulated result
+    ArgumentImm Bswap::emulate(ArgumentImm op1, std::optional<ArgumentImm>) const {
+        ArgumentImm result;
+        std::visit(
+            [&]<typename Ty>(Ty&& op1_value) -> void { //
+                using Decay = std::decay_t<Ty>;
+
+                /// bswap with 16bit operands is undefined
+                if constexpr (sizeof(Decay) < sizeof(std::uint32_t)) {
+                    throw std::runtime_error("bswap: unsupported operand size");
+                } else {
+                    result.emplace<Decay>(std::byteswap(op1_value));
+                }
+            },
+            op1);
+        return result;
+    }
+
+    /// \brief Lift the revert operation for this math operation
+    /// \param assembler zasm assembler
+    /// \param operand dst operand
+    void Bswap::lift_revert(zasm::x86::Assembler* assembler, const zasm::x86::Gp operand, std::optional<Argument>) const {
+        assembler->bswap(operand);
+    }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost, nullopt for 8/16bit operands
+    std::optional<cost_t> Bswap::cost(const zasm::BitSize bit_size) const {
+        switch (getBitSize(bit_size)) {
+        case 32:
+            return cost_t{.latency = 1, .throughput = 0.5, .size = detail::encoded_size(bit_size, 2)};
+        case 64:
+            return cost_t{.latency = 2, .throughput = 1., .size = detail::encoded_size(bit_size, 2)};
+        default:
+            return std::nullopt;
+        }
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Bswap::kind() const {
+        return Kind::BSWAP;
+    }
+} // namespace mathop::operations
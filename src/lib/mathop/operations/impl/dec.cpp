@@ -23,4 +23,17 @@ namespace mathop::operations {
     void Dec::lift_revert(zasm::x86::Assembler* assembler, const zasm::x86::Gp operand, std::optional<Argument> argument) const {
         assembler->inc(operand);
     }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost
+    std::optional<cost_t> Dec::cost(const zasm::BitSize bit_size) const {
+        return cost_t{.latency = 1, .throughput = 0.25, .size = detail::encoded_size(bit_size, 2)}; // inc r
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Dec::kind() const {
+        return Kind::ADDITIVE;
+    }
 } // namespace mathop::operations
\ No newline at end of file
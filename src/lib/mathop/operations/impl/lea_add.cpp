@@ -0,0 +1,68 @@
+#include "mathop/operations/impl/util.hpp"
+
+#include <limits>
+
+namespace mathop::operations {
+    /// \brief Emulate the math operation under the two operands
+    /// \param op1 lhs
+    /// \param op2 rhs
+    /// \return emulated result
+    ArgumentImm LeaAdd::emulate(ArgumentImm op1, std::optional<ArgumentImm> op2) const {
+        ArgumentImm result;
+        std::visit(
+            [&]<typename Ty>(Ty&& op1_value) -> void { //
+                using Decay = std::decay_t<Ty>;
+                result.emplace<Decay>(op1_value + std::get<Decay>(*op2));
+            },
+            op1);
+        return result;
+    }
+
+    /// \brief Lift the revert operation for this math operation
+    /// \param assembler zasm assembler
+    /// \param operand dst operand
+    /// \param argument optional rhs
+    void LeaAdd::lift_revert(zasm::x86::Assembler* assembler, zasm::x86::Gp operand, const std::optional<Argument> argument) const {
+        /// The rhs type is the same as the operand one, so we could pick the memory operand size from it
+        std::visit(detail::overloaded{
+                       [&](const zasm::Reg reg) -> void { assembler->sub(operand, zasm::x86::Gp(reg.getId())); },
+                       [&](const std::int64_t imm) -> void { assembler->lea(operand, zasm::x86::qword_ptr(operand, -imm)); },
+                       [&](const std::int32_t imm) -> void { assembler->lea(operand, zasm::x86::dword_ptr(operand, -static_cast<std::int64_t>(imm))); },
+                       [&](auto) -> void { throw std::runtime_error("lea_add: unsupported operand size"); },
+                   },
+                   argument.value());
+    }
+
+    /// \brief Generate a random second operand
+    /// \param lhs Operand 1
+    /// \return Generated operand
+    ArgumentImm LeaAdd::generate_rhs(const ArgumentImm lhs) const {
+        auto result = detail::generate_random_argument_in_range(lhs);
+
+        /// Displacement is negated when lifted, -INT32_MIN wouldn't fit into disp32
+        if (auto* value = std::get_if<std::int64_t>(&result); value != nullptr && *value == std::numeric_limits<std::int32_t>::min()) {
+            *value += 1;
+        }
+
+        return result;
+    }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost, nullopt for 8/16bit operands
+    std::optional<cost_t> LeaAdd::cost(const zasm::BitSize bit_size) const {
+        const auto bits = getBitSize(bit_size);
+        if (bits != 32 && bits != 64) {
+            return std::nullopt;
+        }
+
+        /// lea r, [r+disp], 32bit operands on x64 are getting an extra addr size prefix but whatever
+        return cost_t{.latency = 1, .throughput = 0.5, .size = detail::encoded_size(bit_size, 2, detail::random_argument_size(bit_size))};
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind LeaAdd::kind() const {
+        return Kind::ADDITIVE;
+    }
+} // namespace mathop::operations
@@ -21,4 +21,17 @@ namespace mathop::operations {
     void Not::lift_revert(zasm::x86::Assembler* assembler, const zasm::x86::Gp operand, std::optional<Argument>) const {
         assembler->not_(operand);
     }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost
+    std::optional<cost_t> Not::cost(const zasm::BitSize bit_size) const {
+        return cost_t{.latency = 1, .throughput = 0.25, .size = detail::encoded_size(bit_size, 2)}; // not r
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Not::kind() const {
+        return Kind::NOT;
+    }
 } // namespace mathop::operations
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "mathop/operations/impl/util.hpp"
+
+namespace mathop::operations {
+    /// \brief Emulate the math operation under the two operands
+    /// \param op1 lhs
+    /// \param op2 rhs
+    /// \return emulated result
+    ArgumentImm Rol::emulate(ArgumentImm op1, std::optional<ArgumentImm> op2) const {
+        ArgumentImm result;
+        std::visit(
+            [&]<typename Ty>(Ty&& op1_value) -> void { //
+                using Decay = std::decay_t<Ty>;
+                result.emplace<Decay>(detail::rotl(op1_value, static_cast<int>(std::get<Decay>(*op2))));
+            },
+            op1);
+        return result;
+    }
+
+    /// \brief Lift the revert operation for this math operation
+    /// \param assembler zasm assembler
+    /// \param operand dst operand
+    /// \param argument optional rhs
+    void Rol::lift_revert(zasm::x86::Assembler* assembler, zasm::x86::Gp operand, const std::optional<Argument> argument) const {
+        lift(
+            argument, detail::none,
+            [](const zasm::x86::Gp) -> void { //
+                throw std::runtime_error("rol: rotation by register is not supported");
+            },
+            [assembler, operand](const zasm::Imm imm) -> void { //
+                assembler->ror(operand, imm);
+            });
+    }
+
+    /// \brief Generate a random second operand
+    /// \param lhs Operand 1
+    /// \return Generated operand
+    ArgumentImm Rol::generate_rhs(const ArgumentImm lhs) const {
+        return detail::generate_random_rotation(lhs);
+    }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost
+    std::optional<cost_t> Rol::cost(const zasm::BitSize bit_size) const {
+        return cost_t{.latency = 1, .throughput = 0.5, .size = detail::encoded_size(bit_size, 2, 1)}; // ror r, imm8
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Rol::kind() const {
+        return Kind::ROTATE;
+    }
+} // namespace mathop::operations
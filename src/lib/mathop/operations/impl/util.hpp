@@ -2,6 +2,8 @@
 #include "mathop/operations/operations.hpp"
 #include "util/random.hpp"
 
+#include <bit>
+#include <climits>
 #include <functional>
 
 namespace mathop::detail {
@@ -53,6 +55,45 @@ namespace mathop::detail {
         return result;
     }
 
+    /// \brief Generate a random rotation count that wouldn't be a no-op
+    /// \param lhs Lhs
+    /// \return Generated operand
+    [[nodiscard]] inline ArgumentImm generate_random_rotation(const ArgumentImm lhs) {
+        return std::visit(
+            []<typename Ty>(Ty&&) -> ArgumentImm {
+                using Decay = std::decay_t<Ty>;
+                return ArgumentImm(static_cast<Decay>(rnd::number<std::uint8_t>(1, static_cast<std::uint8_t>(sizeof(Decay) * CHAR_BIT - 1))));
+            },
+            lhs);
+    }
+
+    /// \brief Rotate the signed value as if it was unsigned
+    /// \tparam Ty value type
+    /// \param value value
+    /// \param count rotation count, negative values are rotating it to the right
+    /// \return rotated value
+    template <typename Ty>
+    [[nodiscard]] Ty rotl(const Ty value, const int count) {
+        return static_cast<Ty>(std::rotl(static_cast<std::make_unsigned_t<Ty>>(value), count));
+    }
+
+    /// \brief Estimate the encoded size of the reg/imm instruction
+    /// \param bit_size operands bit size
+    /// \param opcode_size opcode + modrm size
+    /// \param imm_size imm size
+    /// \return size in bytes, operand size prefix/rex.w included
+    [[nodiscard]] inline std::size_t encoded_size(const zasm::BitSize bit_size, const std::size_t opcode_size, const std::size_t imm_size = 0) {
+        const auto bits = getBitSize(bit_size);
+        return opcode_size + imm_size + static_cast<std::size_t>(bits == 16 || bits == 64);
+    }
+
+    /// \brief Get the size of imm that `generate_random_argument_in_range` would produce
+    /// \param bit_size operands bit size
+    /// \return imm size in bytes
+    [[nodiscard]] inline std::size_t random_argument_size(const zasm::BitSize bit_size) {
+        return getBitSize(bit_size) <= 16 ? 1 : 4;
+    }
+
     /// \brief Empty callback
     inline auto none = [](auto...) -> void {
     };
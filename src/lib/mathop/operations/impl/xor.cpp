@@ -37,4 +37,17 @@ namespace mathop::operations {
     ArgumentImm Xor::generate_rhs(const ArgumentImm lhs) const {
         return detail::generate_random_argument_in_range(lhs);
     }
+
+    /// \brief Estimate the cost of the revert operation
+    /// \param bit_size operands bit size
+    /// \return cost
+    std::optional<cost_t> Xor::cost(const zasm::BitSize bit_size) const {
+        return cost_t{.latency = 1, .throughput = 0.25, .size = detail::encoded_size(bit_size, 2, detail::random_argument_size(bit_size))}; // xor r, imm
+    }
+
+    /// \brief Get the operation kind
+    /// \return kind
+    Kind Xor::kind() const {
+        return Kind::XOR;
+    }
 } // namespace mathop::operations
\ No newline at end of file
@@ -62,6 +62,34 @@ namespace mathop {
         return std::visit([&]<typename Ty>(Ty&&) -> ArgumentImm { return ArgumentImm(static_cast<Ty>(value)); }, lhs);
     }
 
+    /// \brief Estimated cost of the lifted revert operation
+    /// \note Numbers are for the reg/imm forms, latency and throughput are roughly based on the agner's tables
+    struct cost_t {
+        /// \brief Latency in cycles, every operation depends on the previous one so these are summed up
+        std::size_t latency = 0;
+        /// \brief Reciprocal throughput in cycles
+        double throughput = 0.;
+        /// \brief Encoded size in bytes
+        std::size_t size = 0;
+
+        cost_t& operator+=(const cost_t& other) noexcept {
+            latency += other.latency;
+            throughput += other.throughput;
+            size += other.size;
+            return *this;
+        }
+    };
+
+    /// \brief Operation kind, neighbouring operations of the same kind are foldable into a single one
+    enum class Kind : std::uint8_t {
+        ADDITIVE = 0, // add, sub, inc, dec, lea
+        XOR,
+        ROTATE,
+        BSWAP,
+        NEG,
+        NOT,
+    };
+
     /// \brief Math operation representation
     class Operation {
     public:
@@ -83,6 +111,15 @@ namespace mathop {
         /// \param argument optional rhs
         virtual void lift_revert(zasm::x86::Assembler* assembler, zasm::x86::Gp operand, std::optional<Argument> argument) const = 0;
 
+        /// \brief Estimate the cost of the revert operation
+        /// \param bit_size operands bit size
+        /// \return cost, nullopt if the operation is not encodable with this operand size
+        [[nodiscard]] virtual std::optional<cost_t> cost(zasm::BitSize bit_size) const = 0;
+
+        /// \brief Get the operation kind
+        /// \return kind
+        [[nodiscard]] virtual Kind kind() const = 0;
+
         /// \brief Generate a random second operand
         /// \param lhs Operand 1
         /// \return Generated operand
@@ -7,6 +7,8 @@
         ArgumentImm emulate(ArgumentImm op1, std::optional<ArgumentImm> op2) const override;                                       \
         void lift_revert(zasm::x86::Assembler* assembler, zasm::x86::Gp operand, std::optional<Argument> argument) const override; \
         ArgumentImm generate_rhs(ArgumentImm lhs) const override;                                                                  \
+        std::optional<cost_t> cost(zasm::BitSize bit_size) const override;                                                         \
+        Kind kind() const override;                                                                                                \
     }
 
 #define MATHOP_OPERATION_STUB_NO_RHS(name, base_name)                                                                              \
@@ -14,6 +16,8 @@
     public:                                                                                                                        \
         ArgumentImm emulate(ArgumentImm op1, std::optional<ArgumentImm> op2) const override;                                       \
         void lift_revert(zasm::x86::Assembler* assembler, zasm::x86::Gp operand, std::optional<Argument> argument) const override; \
+        std::optional<cost_t> cost(zasm::BitSize bit_size) const override;                                                         \
+        Kind kind() const override;                                                                                                \
     }
 
 #define MATHOP_OPERATION_ONE_OP(name) MATHOP_OPERATION_STUB_NO_RHS(name, mathop::OperationOneOperand)
@@ -24,6 +28,9 @@ namespace mathop::operations {
     MATHOP_OPERATION_TWO_OPS(Add);
     MATHOP_OPERATION_TWO_OPS(Sub);
 
+    /// + (lifted as lea, doesn't touch flags)
+    MATHOP_OPERATION_TWO_OPS(LeaAdd);
+
     /// ^
     MATHOP_OPERATION_TWO_OPS(Xor);
 
@@ -37,7 +44,14 @@ namespace mathop::operations {
     /// ~
     MATHOP_OPERATION_ONE_OP(Not);
 
-    /// \todo @es3n1n: rotl, rotr, nand, nor, and, or, mul, div, lshl, lshr
+    /// rotl rotr
+    MATHOP_OPERATION_TWO_OPS(Rol);
+    MATHOP_OPERATION_TWO_OPS(Ror);
+
+    /// byteswap
+    MATHOP_OPERATION_ONE_OP(Bswap);
+
+    /// \todo @es3n1n: nand, nor, and, or, mul, div, lshl, lshr
 } // namespace mathop::operations
 
 #undef MATHOP_OPERATION_TWO_OPS
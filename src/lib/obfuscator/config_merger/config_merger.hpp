@@ -78,31 +78,40 @@ namespace obfuscator::config_merger {
     /// \brief Apply transform global vars
     /// \tparam Img X64 or X86 image
     /// \param config config reference
+    /// \param scheduler transforms container that it should apply vars to
+    /// \param shared_configs shared configs storage that it should apply vars to
     template <pe::any_image_t Img>
-    void apply_global_vars(config_parser::Config& config) {
-        /// Get the scheduler
-        auto& scheduler = TransformScheduler::get().for_arch<Img>();
-
+    void apply_global_vars(config_parser::Config& config, TransformContainer<Img>& scheduler, TransformSharedConfigStorage& shared_configs) {
         /// Iterate over the global defined vars for the transform
         for (auto& [tag, values] : config.global_transforms_config()) {
             /// Get the transform, its shared config
             auto& transform = scheduler.transforms.at(tag);
-            auto& shared_config = TransformSharedConfigStorage::get().get_for(tag);
+            auto& shared_config = shared_configs.get_for(tag);
 
             /// Apply vars
             detail::apply_vars(transform.get(), TransformConfig::Var::Type::GLOBAL, values, shared_config);
         }
     }
 
+    /// \brief Apply transform global vars to the global transform instances
+    /// \tparam Img X64 or X86 image
+    /// \param config config reference
+    template <pe::any_image_t Img>
+    void apply_global_vars(config_parser::Config& config) {
+        apply_global_vars<Img>(config, TransformScheduler::get().for_arch<Img>(), TransformSharedConfigStorage::get());
+    }
+
     /// \brief Apply user-defined configuration for the transform
     /// \tparam Img X64 or X86 image
     /// \param transform_config user-defined options
+    /// \param scheduler transforms container that it should apply vars to
+    /// \param shared_configs shared configs storage that it should apply vars to
     template <pe::any_image_t Img>
-    void apply_config(const config_parser::transform_configuration_t& transform_config) {
+    void apply_config(const config_parser::transform_configuration_t& transform_config, TransformContainer<Img>& scheduler,
+                      TransformSharedConfigStorage& shared_configs) {
         /// Get all the needed stuff
-        auto& scheduler = TransformScheduler::get().for_arch<Img>();
         auto& transform = scheduler.transforms.at(transform_config.tag);
-        auto& shared_config = TransformSharedConfigStorage::get().get_for(transform_config.tag);
+        auto& shared_config = shared_configs.get_for(transform_config.tag);
 
         /// Reset all PER_FUNCTION vars
         transform->reset_config(TransformConfig::Var::PER_FUNCTION);
@@ -110,4 +119,12 @@ namespace obfuscator::config_merger {
         /// Apply vars
         detail::apply_vars(transform.get(), TransformConfig::Var::Type::PER_FUNCTION, transform_config.values, shared_config);
     }
+
+    /// \brief Apply user-defined configuration for the global transform instance
+    /// \tparam Img X64 or X86 image
+    /// \param transform_config user-defined options
+    template <pe::any_image_t Img>
+    void apply_config(const config_parser::transform_configuration_t& transform_config) {
+        apply_config<Img>(transform_config, TransformScheduler::get().for_arch<Img>(), TransformSharedConfigStorage::get());
+    }
 } // namespace obfuscator::config_merger
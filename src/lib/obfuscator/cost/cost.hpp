@@ -0,0 +1,279 @@
+#pragma once
+#include "analysis/common/common.hpp"
+#include "config_parser/structs.hpp"
+#include "easm/misc/misc.hpp"
+#include "util/structs.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <zasm/zasm.hpp>
+
+/// \note A static cost model of the generated code. The numbers are not even close to be precise, the point is to
+/// have something that we could compare between the original and obfuscated code. Latencies are roughly based on the
+/// agner's tables for the modern intel/amd cores.
+namespace obfuscator::cost {
+    /// \brief Estimated cost of a chunk of code
+    struct cost_t {
+        /// \brief Number of instructions
+        std::size_t instructions = 0;
+        /// \brief Number of memory operands (push/pop/pushf/popf included)
+        std::size_t mem_ops = 0;
+        /// \brief Number of branches, every jmp/jcc/call/ret is assumed to be taken
+        std::size_t branches = 0;
+        /// \brief Latency-weighted cycles
+        std::size_t cycles = 0;
+        /// \brief Encoded size
+        std::size_t bytes = 0;
+
+        cost_t& operator+=(const cost_t& other) noexcept {
+            instructions += other.instructions;
+            mem_ops += other.mem_ops;
+            branches += other.branches;
+            cycles += other.cycles;
+            bytes += other.bytes;
+            return *this;
+        }
+
+        cost_t& operator-=(const cost_t& other) noexcept {
+            instructions -= other.instructions;
+            mem_ops -= other.mem_ops;
+            branches -= other.branches;
+            cycles -= other.cycles;
+            bytes -= other.bytes;
+            return *this;
+        }
+
+        [[nodiscard]] bool operator==(const cost_t&) const = default;
+    };
+
+    namespace detail {
+        /// \brief Cycles that we add for the memory access
+        constexpr std::size_t kMemLatency = 4;
+        /// \brief Cycles that we add for the taken branch
+        constexpr std::size_t kBranchLatency = 2;
+
+        /// \brief Get the base latency of the instruction, without the memory accesses
+        /// \param mnemonic insn mnemonic
+        /// \return latency in cycles
+        [[nodiscard]] inline std::size_t latency(const ZydisMnemonic mnemonic) noexcept {
+            switch (mnemonic) {
+            case ZYDIS_MNEMONIC_MUL:
+            case ZYDIS_MNEMONIC_IMUL:
+                return 3;
+            case ZYDIS_MNEMONIC_DIV:
+            case ZYDIS_MNEMONIC_IDIV:
+                return 26;
+            case ZYDIS_MNEMONIC_PUSHFD:
+            case ZYDIS_MNEMONIC_PUSHFQ:
+                return 3;
+            case ZYDIS_MNEMONIC_POPFD:
+            case ZYDIS_MNEMONIC_POPFQ:
+                return 9;
+            case ZYDIS_MNEMONIC_ADC:
+            case ZYDIS_MNEMONIC_SBB:
+            case ZYDIS_MNEMONIC_RCL:
+            case ZYDIS_MNEMONIC_RCR:
+                return 2;
+            default:
+                return 1;
+            }
+        }
+    } // namespace detail
+
+    /// \brief Estimate the cost of a single instruction
+    /// \param machine_mode machine mode
+    /// \param insn zasm instruction
+    /// \return cost
+    [[nodiscard]] inline cost_t of(const zasm::MachineMode machine_mode, const zasm::Instruction& insn) {
+        const auto detail = insn.getDetail(machine_mode);
+        if (!detail.hasValue()) {
+            throw std::runtime_error("cost: unable to get insn detail");
+        }
+
+        const auto mnemonic = static_cast<ZydisMnemonic>(insn.getMnemonic().value());
+        cost_t result = {
+            .instructions = 1,
+            .cycles = detail::latency(mnemonic),
+            .bytes = detail->getLength(),
+        };
+
+        /// Implicit operands are included, so push/pop are counted as the memory accesses too
+        for (std::size_t i = 0; i < detail->getOperandCount(); ++i) {
+            if (!detail->getOperand(i).holds<zasm::Mem>() || mnemonic == ZYDIS_MNEMONIC_LEA) {
+                continue;
+            }
+
+            ++result.mem_ops;
+            result.cycles += detail::kMemLatency;
+        }
+
+        /// xchg with memory is implicitly locked
+        if (mnemonic == ZYDIS_MNEMONIC_XCHG && result.mem_ops > 0) {
+            result.cycles += 16;
+        }
+
+        if (easm::affects_ip(insn) || easm::is_ret(insn)) {
+            ++result.branches;
+            result.cycles += detail::kBranchLatency;
+        }
+
+        return result;
+    }
+
+    /// \brief Estimate the cost of the node, anything that isn't an instruction costs nothing (except for its size)
+    /// \param machine_mode machine mode
+    /// \param node zasm node
+    /// \return cost
+    [[nodiscard]] inline cost_t of(const zasm::MachineMode machine_mode, const zasm::Node* node) {
+        if (const auto* insn = node->getIf<zasm::Instruction>(); insn != nullptr) {
+            return of(machine_mode, *insn);
+        }
+
+        if (const auto* data = node->getIf<zasm::Data>(); data != nullptr) {
+            return {.bytes = data->getTotalSize()};
+        }
+
+        return {};
+    }
+
+    /// \brief Estimate the cost of the whole program
+    /// \param program zasm program
+    /// \return cost
+    [[nodiscard]] inline cost_t of(const zasm::Program& program) {
+        cost_t result = {};
+        for (const auto* node = program.getHead(); node != nullptr; node = node->getNext()) {
+            result += of(program.getMode(), node);
+        }
+        return result;
+    }
+
+    /// \brief Estimate the cost of the basic block
+    /// \param machine_mode machine mode
+    /// \param bb basic block
+    /// \return cost
+    [[nodiscard]] inline cost_t of(const zasm::MachineMode machine_mode, const analysis::bb_t& bb) {
+        cost_t result = {};
+        for (const auto* insn : bb.instructions) {
+            result += of(machine_mode, *insn->ref);
+        }
+        return result;
+    }
+
+    /// \brief Estimate the cost of every basic block in the storage
+    /// \param machine_mode machine mode
+    /// \param storage bb storage
+    /// \return bb id -> cost
+    [[nodiscard]] inline std::unordered_map<analysis::bb_id_t, cost_t> of_blocks(const zasm::MachineMode machine_mode,
+                                                                                 analysis::bb_storage_t& storage) {
+        std::unordered_map<analysis::bb_id_t, cost_t> result = {};
+        storage.iter_bbs([&](const analysis::bb_t& bb) -> void {
+            result[bb.id] = of(machine_mode, bb); //
+        });
+        return result;
+    }
+
+    /// \brief Cost of the function before and after the obfuscation
+    struct report_t {
+        struct bb_report_t {
+            analysis::bb_id_t id = 0;
+            std::optional<analysis::rva_t> start_rva = std::nullopt;
+            cost_t original = {};
+            cost_t current = {};
+        };
+
+        cost_t original = {};
+        cost_t current = {};
+        std::vector<bb_report_t> blocks = {};
+
+        /// \brief Get the overhead in percents of the estimated cycles
+        [[nodiscard]] double overhead() const noexcept {
+            if (original.cycles == 0) {
+                return 0.;
+            }
+
+            return (static_cast<double>(current.cycles) / static_cast<double>(original.cycles) - 1.) * 100.;
+        }
+    };
+
+    /// \brief Check whether the overhead budget is exhausted
+    /// \param budget budget from the function configuration
+    /// \param original cost of the original code
+    /// \param current cost of the current code
+    /// \return true if we shouldn't add anything else
+    [[nodiscard]] inline bool exhausted(const config_parser::overhead_budget_t& budget, const cost_t& original, const cost_t& current) noexcept {
+        if (budget.kind == config_parser::overhead_budget_t::e_kind::BYTES) {
+            return current.bytes >= original.bytes + budget.value;
+        }
+
+        return current.cycles * 100 >= original.cycles * (100 + budget.value);
+    }
+
+    /// \brief Zasm observer that keeps the program cost up to date as transforms insert/destroy nodes,
+    /// so that we wouldn't need to walk through the whole program after every transform
+    /// \note Operands that are modified in place are not tracked, the estimation of such insns stays the same
+    class Tracker final : public zasm::Observer {
+    public:
+        NON_COPYABLE(Tracker);
+
+        /// \brief Attach the tracker to the program
+        /// \param program zasm program
+        explicit Tracker(const std::shared_ptr<zasm::Program>& program): program_(program) {
+            for (const auto* node = program->getHead(); node != nullptr; node = node->getNext()) {
+                track(node);
+            }
+
+            original_ = current_;
+            program->addObserver(*this);
+        }
+
+        ~Tracker() override {
+            program_->removeObserver(*this);
+        }
+
+        void onNodeInserted(zasm::Node* node) override {
+            track(node);
+        }
+
+        void onNodeDetach(zasm::Node* node) override {
+            untrack(node);
+        }
+
+        void onNodeDestroy(zasm::Node* node) override {
+            untrack(node);
+        }
+
+        void onNodeCreated(zasm::Node*) override { }
+
+        /// \brief Cost of the program at the moment when the tracker was attached
+        [[nodiscard]] const cost_t& original() const noexcept {
+            return original_;
+        }
+
+        /// \brief Current cost of the program
+        [[nodiscard]] const cost_t& current() const noexcept {
+            return current_;
+        }
+
+    private:
+        void track(const zasm::Node* node) {
+            const auto cost = of(program_->getMode(), node);
+            if (nodes_.try_emplace(node, cost).second) {
+                current_ += cost;
+            }
+        }
+
+        void untrack(const zasm::Node* node) {
+            /// Detached nodes could be destroyed later, we should subtract them only once
+            if (const auto it = nodes_.find(node); it != nodes_.end()) {
+                current_ -= it->second;
+                nodes_.erase(it);
+            }
+        }
+
+        std::shared_ptr<zasm::Program> program_ = {};
+        /// \brief Nodes that are currently within the program, with the cost that we've added for them
+        std::unordered_map<const zasm::Node*, cost_t> nodes_ = {};
+        cost_t original_ = {};
+        cost_t current_ = {};
+    };
+} // namespace obfuscator::cost
@@ -1,4 +1,5 @@
 #pragma once
+#include "analysis/liveness/liveness.hpp"
 #include "analysis/var_alloc/var_alloc.hpp"
 #include "obfuscator/transforms/types.hpp"
 
@@ -17,7 +18,15 @@ namespace obfuscator {
         /// \brief Construct new var allocator
         /// \return varalloc instance
         auto var_alloc() {
-            return analysis::VarAlloc<Img>(&lru_reg);
+            return analysis::VarAlloc<Img>(&lru_reg, 0, analysis::kAllFlags, &spills);
+        }
+
+        /// \brief Construct new var allocator that would use the dead registers first
+        /// \param dead_regs registers that we could clobber without saving them (see `analysis::liveness`)
+        /// \param live_flags status flags that we should save if we're gonna clobber them
+        /// \return varalloc instance
+        auto var_alloc(const analysis::reg_mask_t dead_regs, const analysis::flags_mask_t live_flags = analysis::kAllFlags) {
+            return analysis::VarAlloc<Img>(&lru_reg, dead_regs, live_flags, &spills);
         }
 
         /// \brief Parsed information from PDB/MAP/etc
@@ -38,5 +47,7 @@ namespace obfuscator {
         std::shared_ptr<analysis::functional_bb_provider_t> bb_provider;
         /// \brief Zasm machine mode
         const zasm::MachineMode machine_mode;
+        /// \brief Registers that were saved on stack by the var allocators
+        analysis::spills_t spills = {};
     };
 } // namespace obfuscator
\ No newline at end of file
@@ -2,14 +2,22 @@
 #include "analysis/observer/observer.hpp"
 #include "easm/debug/debug.hpp"
 #include "obfuscator/config_merger/config_merger.hpp"
+#include "obfuscator/cost/cost.hpp"
 #include "obfuscator/function.hpp"
+#include "obfuscator/peephole/peephole.hpp"
 #include "obfuscator/transforms/scheduler.hpp"
 #include "util/logger.hpp"
 #include "util/progress.hpp"
 #include "util/random.hpp"
+#include "util/stopwatch.hpp"
+#include "util/trace.hpp"
+
+#include <numeric>
+#include <optional>
 
 namespace obfuscator {
     constexpr size_t kTextSectionAlignment = 0x10;
+    constexpr std::uint8_t kPaddingByte = 0xCC; // int3
 
     template <pe::any_image_t Img>
     void Instance<Img>::setup() {
@@ -21,12 +29,30 @@ namespace obfuscator {
         //
         func_parser_.collect_functions();
 
-        // Add functions from config, that we should protecc
+        // Resolve functions from config, that we should protecc. This is done before we spawn
+        // any workers, as the scheduler isn't thread-safe
         //
-        auto analysis_progress = util::Progress("obfuscator: setting up functions", config_.size());
+        std::vector<func_parser::function_t> function_infos = {};
+        function_infos.reserve(config_.size());
         for (auto& configuration : config_) {
-            add_function(configuration);
+            function_infos.emplace_back(resolve_function(configuration));
+        }
+
+        // Analyse functions in parallel, the image is read-only during the analysis so
+        // it's fine to share it between workers
+        //
+        std::vector<std::optional<analysis::Function<Img>>> analysed(function_infos.size());
+        auto analysis_progress = util::Progress("obfuscator: setting up functions", function_infos.size());
+        const util::trace::Span analysis_span("obfuscator: analysis");
+        pool_.for_each(function_infos.size(), [&](const std::size_t index, std::size_t) -> void {
+            analysed[index].emplace(analysis::analyse(image_, function_infos[index]));
             analysis_progress.step();
+        });
+
+        // Merge the results in the config order, so that the output doesn't depend on scheduling
+        //
+        for (std::size_t i = 0; const auto& configuration : config_) {
+            store_function(*analysed[i++], configuration);
         }
 
         // Enable transforms from global config
@@ -39,6 +65,12 @@ namespace obfuscator {
 
     template <pe::any_image_t Img>
     void Instance<Img>::add_function(const config_parser::function_configuration_t& configuration) {
+        const auto function_info = resolve_function(configuration);
+        store_function(analysis::analyse(image_, function_info), configuration);
+    }
+
+    template <pe::any_image_t Img>
+    func_parser::function_t Instance<Img>::resolve_function(const config_parser::function_configuration_t& configuration) {
         /// We don't want to obfuscate functions with 0 transforms
         // if (configuration.transform_configurations.empty()) {
         // logger::warn("collect: excluding function {} from obfuscation list", configuration.function_name);
@@ -58,9 +90,19 @@ namespace obfuscator {
             scheduler.enable_transform(tag);
         }
 
+        return function_info.value();
+    }
+
+    template <pe::any_image_t Img>
+    void Instance<Img>::store_function(const analysis::Function<Img>& analysed, const config_parser::function_configuration_t& configuration) {
+        /// Erase the relocations that were consumed by the function instructions
+        for (const auto rva : analysed.consumed_relocations) {
+            image_->relocations.erase(rva);
+        }
+
         /// Store function info
         functions_.emplace_back(function_t{
-            .analysed = analysis::analyse(image_, function_info.value()),
+            .analysed = analysed,
             .configuration = configuration,
         });
     }
@@ -69,139 +111,344 @@ namespace obfuscator {
     void Instance<Img>::obfuscate() {
         /// Debug log
         logger::info("obfuscator: got {} function(s) to obfuscate", functions_.size());
+        const util::trace::Span _("obfuscator: obfuscate");
 
         if (functions_.empty()) {
             throw std::runtime_error("obfuscator: got 0 functions to protect");
         }
 
-        /// Obtain transform scheduler for the platform
-        auto& scheduler = TransformScheduler::get().for_arch<Img>();
-        config_merger::apply_global_vars<Img>(config_);
-
-        /// Iterate over functions that we need to obfuscate
-        for (const auto& func : functions_) {
-            /// Init the `obfuscator::Function` that is going to be used within
-            /// transforms
-            auto obf_func = obfuscator::Function<Img>(func.analysed, image_);
-
-            /// Export tags that this function would need
-            auto tags = std::views::all(func.configuration.transform_configurations) |
-                        std::views::transform([](const config_parser::transform_configuration_t& it) -> TransformTag { return it.tag; }) |
-                        std::ranges::to<std::vector>();
-
-            /// Export transforms
-            auto transforms = scheduler.select_transforms(tags);
-
-            /// Init the progress bar
-            auto progress = util::Progress(std::format("obfuscator: obfuscating {}", obf_func.parsed_func.name), transforms.size());
-
-            /// An util that would check the chances and all this other crap, that would be
-            /// needed for like  every possible function/transform
-            auto execute_transform = [func](const TransformTag tag, const std::function<void(TransformContext&)>& callback,
-                                            const bool check_chances = true) -> void {
-                auto preset = std::ranges::find_if(func.configuration.transform_configurations, [tag](auto&& it) -> bool {
-                    return it.tag == tag; //
-                });
-                if (preset == std::end(func.configuration.transform_configurations)) {
-                    throw std::runtime_error(std::format("obfuscate: unable to find configuration for transform {}", tag));
-                }
+        /// Scale the transform chances according to the execution profile
+        apply_profile();
+
+        /// Init the worker states, each of them gets its own copy of transforms for the platform
+        std::vector<std::unique_ptr<worker_t>> workers = {};
+        for (std::size_t i = 0; i < std::min(pool_.size(), functions_.size()); ++i) {
+            auto& worker = workers.emplace_back(std::make_unique<worker_t>(TransformScheduler::get().for_arch<Img>()));
+            config_merger::apply_global_vars<Img>(config_, *worker->scheduler, worker->shared_configs);
+        }
 
-                /// Apply the preset
-                config_merger::apply_config<Img>(*preset);
+        /// Estimate the obfuscation cost for every function, which is the number of instructions
+        /// times the number of transforms that we would need to apply
+        std::vector<std::size_t> costs(functions_.size());
+        std::ranges::transform(functions_, costs.begin(), [](const function_t& func) -> std::size_t {
+            std::size_t insns_count = 0;
+            func.analysed.bb_storage->iter_bbs([&insns_count](const analysis::bb_t& basic_block) -> void {
+                insns_count += basic_block.size(); //
+            });
+            return insns_count * std::max<std::size_t>(func.configuration.transform_configurations.size(), 1);
+        });
+
+        /// Schedule the most expensive functions first, so that the biggest one wouldn't end up
+        /// running alone at the very end
+        std::vector<std::size_t> order(functions_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, std::ranges::greater{}, [&costs](const std::size_t index) -> std::size_t { return costs[index]; });
 
-                /// Get the shared config and check the chance
-                auto& cfg = TransformSharedConfigStorage::get().get_for(tag);
+        /// Obfuscate functions
+        pool_.for_each(order, [this, &workers](const std::size_t index, const std::size_t worker) -> void {
+            obfuscate_function(functions_[index], *workers[worker]); //
+        });
+    }
 
-                /// Check the chance
-                /// \todo @es3n1n: Check for chance feature
-                if (check_chances && !rnd::chance(cfg.chance())) {
+    template <pe::any_image_t Img>
+    void Instance<Img>::apply_profile() {
+        const auto& profile_path = config_.obfuscator_config().profile_path;
+        if (!profile_path.has_value()) {
+            return;
+        }
+
+        const auto profile = profile::Profile::from_file(*profile_path);
+        logger::info("profile: loaded {} samples", profile.size());
+
+        /// Collect the hits of every block, the range of the block is [first insn; last insn + its length)
+        std::vector<std::pair<analysis::bb_t*, std::uint64_t>> blocks = {};
+        std::uint64_t max_hits = 0;
+        for (auto& func : functions_) {
+            func.analysed.bb_storage->iter_bbs([&](analysis::bb_t& bb) -> void {
+                if (!bb.start_rva.has_value() || bb.instructions.empty() || !bb.instructions.back()->rva.has_value()) {
                     return;
                 }
 
-                /// Otherwise run this method
-                for (std::size_t i = 0; i < cfg.repeat_times(); ++i) {
-                    /// Init context, run the task
-                    auto context = TransformContext(cfg);
+                const auto* last = bb.instructions.back();
+                const auto hits = profile.hits(*bb.start_rva, *last->rva + *last->length);
+                blocks.emplace_back(&bb, hits);
+                max_hits = std::max(max_hits, hits);
+            });
+        }
 
-                    do {
-                        context.rerun_me = false;
-                        callback(context);
-                    } while (context.rerun_me);
-                }
-            };
-            auto execute_transform_no_chances = [&](const TransformTag tag, const std::function<void(TransformContext&)>& callback) -> void {
-                return execute_transform(tag, callback, false);
-            };
-
-            /// \note @es3n1n: We can't iterate through the insns/bbs and execute transforms
-            /// from there as it would break the scheduling order
-            for (auto& [tag, transform] : transforms) {
-                /// Apply function transform
-                if (transform->feature(TransformFeaturesSet::HAS_FUNCTION_TRANSFORM)) {
-                    execute_transform_no_chances(tag, [&obf_func, &transform](auto& ctx) -> void {
-                        transform->run_on_function(ctx, &obf_func); //
-                    });
-                }
+        if (max_hits == 0) {
+            logger::warn("profile: none of the samples are within the obfuscated functions");
+            return;
+        }
 
-                /// Apply basic block transforms
-                if (transform->feature(TransformFeaturesSet::HAS_BB_TRANSFORM)) {
-                    for (auto& basic_block : obf_func.bb_storage->temp_copy()) {
-                        execute_transform(tag, [&obf_func, &transform, &basic_block](auto& ctx) -> void {
-                            transform->run_on_bb(ctx, &obf_func, basic_block.get()); //
-                        });
-                    }
+        /// The hottest blocks get no transforms at all, the ones that were never hit get them at their full strength
+        const auto block_hits = blocks | std::views::values | std::ranges::to<std::vector>();
+        const auto scales = profile::chance_scales(block_hits);
+        std::size_t hot_blocks = 0;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            blocks[i].first->chance_scale = scales[i];
+            hot_blocks += blocks[i].second > 0 ? 1 : 0;
+        }
+        logger::info("profile: {} out of {} blocks were hit", hot_blocks, blocks.size());
+    }
+
+    template <pe::any_image_t Img>
+    void Instance<Img>::obfuscate_function(function_t& func, worker_t& worker) {
+        const util::trace::Span _("obfuscate", func.analysed.parsed_func.name);
+        const util::Stopwatch function_stopwatch = {};
+
+        /// Init the `obfuscator::Function` that is going to be used within
+        /// transforms
+        auto obf_func = obfuscator::Function<Img>(func.analysed, image_);
+
+        /// Size estimation isn't free, so we're doing it only if someone's gonna read the stats
+        const bool estimate_sizes = config_.obfuscator_config().stats_path.has_value();
+        func.statistics.name = obf_func.parsed_func.name;
+        if (estimate_sizes) {
+            func.statistics.size_before = easm::estimate_program_size(*obf_func.program);
+        }
+        stats::transform_t* transform_stats = nullptr;
+
+        /// Export tags that this function would need
+        auto tags = std::views::all(func.configuration.transform_configurations) |
+                    std::views::transform([](const config_parser::transform_configuration_t& it) -> TransformTag { return it.tag; }) |
+                    std::ranges::to<std::vector>();
+
+        /// Export transforms
+        auto transforms = worker.scheduler->select_transforms(tags);
+
+        /// Init the progress bar
+        auto progress = util::Progress(std::format("obfuscator: obfuscating {}", obf_func.parsed_func.name), transforms.size());
+
+        /// Track the program cost, so that we could stop once the overhead budget is exhausted.
+        /// There's no point in observing every insert/destroy if there's no budget at all
+        std::optional<cost::Tracker> tracker = std::nullopt;
+        if (func.configuration.max_overhead.has_value()) {
+            tracker.emplace(obf_func.program);
+        }
+
+        /// The cost report isn't free, don't estimate anything unless it was requested
+        const bool report_cost = config_.obfuscator_config().verbose;
+        auto report = cost::report_t{};
+        std::unordered_map<analysis::bb_id_t, cost::cost_t> original_blocks = {};
+        if (report_cost) {
+            report.original = tracker.has_value() ? tracker->original() : cost::of(*obf_func.program);
+            original_blocks = cost::of_blocks(obf_func.machine_mode, *obf_func.bb_storage);
+        }
+
+        bool budget_exhausted = false;
+        auto check_budget = [&func, &obf_func, &tracker, &budget_exhausted]() -> bool {
+            if (budget_exhausted || !tracker.has_value()) {
+                return budget_exhausted;
+            }
+
+            budget_exhausted = cost::exhausted(*func.configuration.max_overhead, tracker->original(), tracker->current());
+            if (budget_exhausted) {
+                logger::warn("obfuscator: {}: overhead budget is exhausted, skipping the rest of transforms", obf_func.parsed_func.name);
+            }
+            return budget_exhausted;
+        };
+
+        /// An util that would check the chances and all this other crap, that would be
+        /// needed for like  every possible function/transform
+        auto execute_transform = [&](const TransformTag tag, const std::function<void(TransformContext&)>& callback, const bool check_chances = true,
+                                     const analysis::bb_t* bb = nullptr) -> void {
+            /// Nothing else could be added
+            if (check_budget()) {
+                return;
+            }
+
+            auto preset = std::ranges::find_if(func.configuration.transform_configurations, [tag](auto&& it) -> bool {
+                return it.tag == tag; //
+            });
+            if (preset == std::end(func.configuration.transform_configurations)) {
+                throw std::runtime_error(std::format("obfuscate: unable to find configuration for transform {}", tag));
+            }
+
+            /// Apply the preset
+            config_merger::apply_config<Img>(*preset, *worker.scheduler, worker.shared_configs);
+
+            /// Get the shared config and check the chance
+            auto& cfg = worker.shared_configs.get_for(tag);
+
+            /// Check the chance
+            /// \todo @es3n1n: Check for chance feature
+            if (check_chances) {
+                const bool hit = rnd::chance(scale_chance(cfg, bb));
+                ++(hit ? transform_stats->chance_hits : transform_stats->chance_misses);
+                if (!hit) {
+                    return;
                 }
+            }
 
-                /// Apply analysis insn transforms
-                if (transform->feature(TransformFeaturesSet::HAS_INSN_TRANSFORM)) {
-                    for (auto& basic_block : obf_func.bb_storage->temp_copy()) {
-                        for (auto& insn : basic_block->temp_insns_copy()) {
-                            execute_transform(tag, [&obf_func, &transform, &insn](auto& ctx) -> void {
-                                transform->run_on_insn(ctx, &obf_func, insn.get()); //
-                            });
-                        }
-                    }
+            /// Otherwise run this method
+            for (std::size_t i = 0; i < cfg.repeat_times() && !check_budget(); ++i) {
+                /// Init context, run the task
+                auto context = TransformContext(cfg);
+
+                do {
+                    context.rerun_me = false;
+                    ++transform_stats->invocations;
+                    callback(context);
+                } while (context.rerun_me);
+            }
+        };
+        auto execute_transform_no_chances = [&](const TransformTag tag, const std::function<void(TransformContext&)>& callback) -> void {
+            return execute_transform(tag, callback, false);
+        };
+
+        /// \note @es3n1n: We can't iterate through the insns/bbs and execute transforms
+        /// from there as it would break the scheduling order
+        for (std::size_t index = 0; auto& [tag, transform] : transforms) {
+            /// Every transform gets its own random stream, derived from the function name and transform tag
+            const rnd::Stream stream(obf_func.parsed_func.name, tag, index++);
+            const util::trace::Span span(worker.shared_configs.get_for(tag).name, obf_func.parsed_func.name);
+
+            /// Snapshot the counters, so that we could account the difference to this transform
+            transform_stats = &func.statistics.transforms.emplace_back(stats::transform_t{.name = worker.shared_configs.get_for(tag).name});
+            const auto counters = obf_func.observer->counters();
+            const auto spills = obf_func.spills;
+            const util::Stopwatch transform_stopwatch = {};
+
+            /// Apply function transform
+            if (transform->feature(TransformFeaturesSet::HAS_FUNCTION_TRANSFORM)) {
+                execute_transform_no_chances(tag, [&obf_func, &transform](auto& ctx) -> void {
+                    transform->run_on_function(ctx, &obf_func); //
+                });
+            }
+
+            /// Apply basic block transforms
+            if (transform->feature(TransformFeaturesSet::HAS_BB_TRANSFORM)) {
+                for (auto& basic_block : obf_func.bb_storage->temp_copy()) {
+                    execute_transform(tag, [&obf_func, &transform, &basic_block](auto& ctx) -> void {
+                        transform->run_on_bb(ctx, &obf_func, basic_block); //
+                    }, true, basic_block);
                 }
+            }
 
-                /// Apply program nodes transform
-                if (transform->feature(TransformFeaturesSet::HAS_NODE_TRANSFORM)) {
-                    for (auto* node = obf_func.program->getHead(); node != nullptr; node = node->getNext()) {
-                        /// Transform nodes
-                        execute_transform(tag, [&obf_func, &transform, &node](auto& ctx) -> void {
-                            transform->run_on_node(ctx, &obf_func, node); //
-                        });
+            /// Apply analysis insn transforms
+            if (transform->feature(TransformFeaturesSet::HAS_INSN_TRANSFORM)) {
+                for (auto& basic_block : obf_func.bb_storage->temp_copy()) {
+                    for (auto& insn : basic_block->temp_insns_copy()) {
+                        execute_transform(tag, [&obf_func, &transform, &insn](auto& ctx) -> void {
+                            transform->run_on_insn(ctx, &obf_func, insn); //
+                        }, true, basic_block);
                     }
                 }
+            }
 
-                /// Increment progress bar
-                progress.step();
+            /// Apply program nodes transform
+            if (transform->feature(TransformFeaturesSet::HAS_NODE_TRANSFORM)) {
+                for (auto* node = obf_func.program->getHead(); node != nullptr; node = node->getNext()) {
+                    /// Transform nodes
+                    execute_transform(tag, [&obf_func, &transform, &node](auto& ctx) -> void {
+                        transform->run_on_node(ctx, &obf_func, node); //
+                    });
+                }
             }
 
-            /// We are done here
+            /// Save the stats
+            transform_stats->insns_added = obf_func.observer->counters().inserted - counters.inserted;
+            transform_stats->insns_removed = obf_func.observer->counters().destroyed - counters.destroyed;
+            transform_stats->spilled_registers = obf_func.spills.registers - spills.registers;
+            transform_stats->spilled_bytes = obf_func.spills.bytes - spills.bytes;
+            transform_stats->wall_time = transform_stopwatch.duration();
+
+            /// Increment progress bar
+            progress.step();
+        }
+
+        /// Estimate the blocks cost before the peephole, as it doesn't update the bbs
+        if (report_cost) {
+            obf_func.bb_storage->iter_bbs([&](const analysis::bb_t& bb) -> void {
+                const auto original = original_blocks.find(bb.id);
+                report.blocks.emplace_back(cost::report_t::bb_report_t{
+                    .id = bb.id,
+                    .start_rva = bb.start_rva,
+                    .original = original != original_blocks.end() ? original->second : cost::cost_t{},
+                    .current = cost::of(obf_func.machine_mode, bb),
+                });
+            });
+        }
+
+        /// Clean up the glue between the transform stubs, we are done here
+        {
+            const util::trace::Span span("peephole", obf_func.parsed_func.name);
+            peephole::optimize(&obf_func);
+        }
+
+        if (estimate_sizes) {
+            func.statistics.size_after = easm::estimate_program_size(*obf_func.program);
+        }
+        func.statistics.wall_time = function_stopwatch.duration();
+
+        if (!report_cost) {
+            return;
+        }
+
+        report.current = tracker.has_value() ? tracker->current() : cost::of(*obf_func.program);
+        logger::debug("cost: {}: insns {} -> {}, mem ops {} -> {}, branches {} -> {}, bytes {} -> {}, cycles {} -> {} ({:+.1f}%)",
+                      obf_func.parsed_func.name, report.original.instructions, report.current.instructions, report.original.mem_ops,
+                      report.current.mem_ops, report.original.branches, report.current.branches, report.original.bytes, report.current.bytes,
+                      report.original.cycles, report.current.cycles, report.overhead());
+        for (const auto& block : report.blocks) {
+            logger::debug("cost: {}: bb {:#x}: insns {} -> {}, cycles {} -> {}", obf_func.parsed_func.name, block.start_rva.value_or(nullptr),
+                          block.original.instructions, block.current.instructions, block.original.cycles, block.current.cycles);
         }
     }
 
     template <pe::any_image_t Img>
     void Instance<Img>::assemble() {
-        /// Estimating section size
+        const util::trace::Span _("obfuscator: assemble");
+
+        /// Layout phase, every function gets a fixed slot in the new section, so that we
+        /// could serialize them independently from each other
         auto size_estimation_progress = util::Progress("obfuscator: estimating section size", functions_.size());
-        std::size_t section_size = 0;
-        for (auto& func : functions_) {
-            const auto program_size = easm::estimate_program_size(*func.analysed.program);
-            section_size += memory::address{program_size}.align_up(kTextSectionAlignment).as<std::size_t>();
+        std::vector<std::size_t> slot_sizes(functions_.size());
+        pool_.for_each(functions_.size(), [this, &slot_sizes, &size_estimation_progress](const std::size_t index, std::size_t) -> void {
+            const util::trace::Span span("estimate", functions_[index].analysed.parsed_func.name);
+            const auto program_size = easm::estimate_program_size(*functions_[index].analysed.program);
+            slot_sizes[index] = memory::address{program_size}.align_up(kTextSectionAlignment).as<std::size_t>();
             size_estimation_progress.step();
-        }
+        });
+
+        std::vector<std::size_t> slot_offsets(functions_.size());
+        std::exclusive_scan(slot_sizes.begin(), slot_sizes.end(), slot_offsets.begin(), static_cast<std::size_t>(0));
+        const auto section_size = slot_sizes.empty() ? 0 : slot_offsets.back() + slot_sizes.back();
         logger::debug("assemble: estimated new section size: {:#x}", section_size);
 
         /// Allocate new section
         auto img_base = image_->raw_image->get_nt_headers()->optional_header.image_base;
         auto& new_sec = image_->new_section(sections::e_section_t::CODE, section_size);
-        memory::address virt_address = new_sec.virtual_address;
+        const memory::address section_start = new_sec.virtual_address;
+
+        /// Serialization phase, functions are assembled in parallel at their final addresses
+        auto assemble_progress = util::Progress("obfuscator: assembling functions", functions_.size());
+        std::vector<easm::assembled_t> assembled(functions_.size());
+        pool_.for_each(functions_.size(), [&](const std::size_t index, std::size_t) -> void {
+            const auto& func = functions_[index].analysed;
+            const util::trace::Span span("assemble", func.parsed_func.name);
+            assembled[index] = easm::assemble_program(section_start.offset(slot_offsets[index]) + img_base, *func.program);
+
+            /// Make sure that the estimation was right, otherwise we would overlap with the next function
+            if (assembled[index].data.size() > slot_sizes[index]) {
+                throw std::runtime_error(std::format("assemble: function {} doesn't fit into its slot ({:#x} > {:#x})", func.parsed_func.name,
+                                                     assembled[index].data.size(), slot_sizes[index]));
+            }
+
+            assemble_progress.step();
+        });
 
-        /// Iterate over the obfuscated functions
+        /// Merge phase, iterate over the obfuscated functions and link them
         auto linking_progress = util::Progress("obfuscator: linking functions", functions_.size());
-        for (auto& [func, _] : functions_) {
-            /// \todo @es3n1n: perhaps i should split this monstrosity into a separate functions
+        for (std::size_t index = 0; index < functions_.size(); ++index) {
+            auto& func = functions_[index].analysed;
+            const util::trace::Span span("link", func.parsed_func.name);
+            const auto& [data, relocations] = assembled[index];
+            const auto virt_address = section_start.offset(slot_offsets[index]);
+
+            /// Random stream for the junk bytes
+            const rnd::Stream stream(func.parsed_func.name);
 
             /// Erase the original function code
             for (auto& basic_block : *func.bb_storage) {
@@ -215,7 +462,7 @@ namespace obfuscator {
                     const auto randomized = rnd::bytes(*insn->length);
 
                     /// Replace instruction with junk
-                    auto* insn_ptr = image_->rva_to_ptr(*insn->rva);
+                    auto* insn_ptr = image_->rva_to_mutable_ptr(*insn->rva);
                     std::memcpy(insn_ptr, randomized.data(), randomized.size());
 
                     /// Remove pe relocation, if there's any
@@ -226,27 +473,20 @@ namespace obfuscator {
             }
 
             /// Insert the jmp to obfuscated routine at the very beginning of the function
-            auto* func_start_ptr = image_->rva_to_ptr(func.range.start);
+            auto* func_start_ptr = image_->rva_to_mutable_ptr(func.range.start);
             auto jmp_data = easm::encode_jmp(image_->guess_machine_mode(), func.range.start + img_base, virt_address + img_base);
             if (!jmp_data.has_value()) {
                 throw std::runtime_error("assemble: unable to encode jmp");
             }
             std::memcpy(func_start_ptr, jmp_data->data(), jmp_data->size());
 
-            /// Assemble the obfuscated function
-            auto assemble_progress = util::Progress(std::format("obfuscator: assembling {}", func.parsed_func.name), 1);
-            const auto assembled = easm::assemble_program(virt_address + img_base, *func.program);
-            assemble_progress.step();
-
-            /// Copy fresh new assembled function
-            std::memcpy( //
-                new_sec.raw_data.data() + (virt_address - new_sec.virtual_address).template as<std::size_t>(), //
-                assembled.data.data(), //
-                assembled.data.size() //
-            );
+            /// Copy fresh new assembled function, and pad the rest of the slot with int3s
+            auto* slot_ptr = new_sec.raw_data.mutable_data() + slot_offsets[index];
+            std::memcpy(slot_ptr, data.data(), data.size());
+            std::memset(slot_ptr + data.size(), kPaddingByte, slot_sizes[index] - data.size());
 
             /// Save the new relocations
-            for (const zasm::RelocationInfo& relocation : assembled.relocations) {
+            for (const zasm::RelocationInfo& relocation : relocations) {
                 /// Map zasm relocation kind to windows relocation kind
                 win::reloc_type_id win_reloc_type;
                 switch (relocation.kind) {
@@ -268,9 +508,8 @@ namespace obfuscator {
                                      .type = win_reloc_type};
             }
 
-            /// Align size and increment offset
-            const auto aligned_size = memory::address{assembled.data.size()}.align_up(kTextSectionAlignment).as<std::size_t>();
-            virt_address = virt_address.offset(aligned_size);
+            /// The function is linked, release all of its analysis state at once
+            func.release();
 
             /// Increment progress bar
             linking_progress.step();
@@ -282,8 +521,7 @@ namespace obfuscator {
     template <pe::any_image_t Img>
     void Instance<Img>::save() {
         logger::info("obfuscator: saving..");
-        auto new_img = image_->rebuild_pe_image();
-
+        const util::trace::Span _("obfuscator: save");
         auto out_path = config_.obfuscator_config().binary_path;
 
         auto filename = out_path.filename();
@@ -293,9 +531,21 @@ namespace obfuscator {
         const auto new_filename = filename_no_ext + ".protected" + file_ext;
 
         out_path = out_path.replace_filename(new_filename);
-        util::write_file(out_path, new_img.data(), new_img.size());
+        image_->rebuild_pe_image(out_path);
 
         logger::info("obfuscator: saved output to {}", out_path.string());
+
+        /// Save the per-function/per-transform stats, if needed
+        if (const auto& stats_path = config_.obfuscator_config().stats_path; stats_path.has_value()) {
+            std::vector<stats::function_t> statistics = {};
+            statistics.reserve(functions_.size());
+            for (auto& func : functions_) {
+                statistics.emplace_back(std::move(func.statistics));
+            }
+
+            stats::save(*stats_path, statistics);
+            logger::info("obfuscator: saved stats to {}", stats_path->string());
+        }
     }
 
     PE_DECL_TEMPLATE_CLASSES(Instance);
@@ -2,14 +2,19 @@
 #include "analysis/analysis.hpp"
 #include "config_parser/config_parser.hpp"
 #include "func_parser/parser.hpp"
+#include "obfuscator/stats/stats.hpp"
+#include "obfuscator/transforms/scheduler.hpp"
 #include "pe/pe.hpp"
+#include "profile/profile.hpp"
 #include "util/structs.hpp"
+#include "util/thread_pool.hpp"
 
 namespace obfuscator {
     template <pe::any_image_t Img>
     class Instance {
     public:
-        Instance(Img* image, config_parser::Config& config): image_(image), config_(std::move(config)) { }
+        Instance(Img* image, config_parser::Config& config)
+            : image_(image), config_(std::move(config)), pool_(config_.obfuscator_config().jobs) { }
         DEFAULT_DTOR(Instance);
         NON_COPYABLE(Instance);
 
@@ -22,11 +27,28 @@ namespace obfuscator {
         struct function_t {
             analysis::Function<Img> analysed;
             config_parser::function_configuration_t configuration;
+            stats::function_t statistics = {};
         };
 
     private:
+        /// \brief Per-worker transform state, every worker gets its own transform instances and shared configs
+        /// so that the per-function vars wouldn't race between workers
+        struct worker_t {
+            explicit worker_t(const TransformContainer<Img>& container)
+                : scheduler(container.clone()), shared_configs(TransformSharedConfigStorage::get()) { }
+
+            std::unique_ptr<TransformContainer<Img>> scheduler;
+            TransformSharedConfigStorage shared_configs;
+        };
+
+        void apply_profile();
+        void obfuscate_function(function_t& func, worker_t& worker);
+        [[nodiscard]] func_parser::function_t resolve_function(const config_parser::function_configuration_t& configuration);
+        void store_function(const analysis::Function<Img>& analysed, const config_parser::function_configuration_t& configuration);
+
         Img* image_ = nullptr;
         config_parser::Config config_ = {};
+        util::ThreadPool pool_;
         func_parser::Instance<Img> func_parser_ = {};
         std::vector<function_t> functions_ = {};
     };
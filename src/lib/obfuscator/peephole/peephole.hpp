@@ -0,0 +1,278 @@
+#pragma once
+#include "obfuscator/function.hpp"
+#include "util/logger.hpp"
+
+/// \note A tiny peephole optimizer that cleans up the glue that transforms are leaving behind each other
+/// (spills/reloads of the neighbouring stubs, flag saves, jumps to the next node). It runs once after all the transforms
+/// and operates on the raw zasm nodes, so it doesn't care about the bbs.
+/// Every rewrite here is exact, we only drop stuff that has no observable effect except for the memory below the stack ptr.
+namespace obfuscator::peephole {
+    /// \brief Mark the node so that the optimizer wouldn't touch it (for the intentional junk, e.g. anti-decompiler tricks)
+    /// \param node zasm node, could be null
+    inline void preserve(zasm::Node* node) {
+        if (node == nullptr) {
+            return;
+        }
+
+        if (auto* insn = node->getUserData<analysis::insn_t>(); insn != nullptr) {
+            insn->flags |= analysis::PRESERVE;
+        }
+    }
+
+    namespace detail {
+        /// \brief Max number of instructions that we're gonna look through while searching for the flags restore
+        constexpr std::size_t kMaxFlagsLookup = 32;
+
+        /// \brief Get the instruction if the node is an instruction that we're allowed to touch
+        /// \param node zasm node
+        /// \return instruction ptr or null
+        inline zasm::Instruction* mutable_insn(zasm::Node* node) {
+            if (node == nullptr) {
+                return nullptr;
+            }
+
+            if (const auto* insn_info = node->getUserData<analysis::insn_t>(); insn_info != nullptr && (insn_info->flags & analysis::PRESERVE) != 0) {
+                return nullptr;
+            }
+
+            return node->getIf<zasm::Instruction>();
+        }
+
+        /// \brief Check the mnemonic
+        /// \param insn instruction, could be null
+        /// \param mnemonic expected mnemonic
+        /// \return true if matches
+        inline bool is(const zasm::Instruction* insn, const ZydisMnemonic mnemonic) {
+            return insn != nullptr && insn->getMnemonic().value() == mnemonic;
+        }
+
+        inline bool is_pushf(const zasm::Instruction* insn) {
+            return is(insn, ZYDIS_MNEMONIC_PUSHFQ) || is(insn, ZYDIS_MNEMONIC_PUSHFD);
+        }
+
+        inline bool is_popf(const zasm::Instruction* insn) {
+            return is(insn, ZYDIS_MNEMONIC_POPFQ) || is(insn, ZYDIS_MNEMONIC_POPFD);
+        }
+
+        /// \brief Get the GP register of the `push reg`/`pop reg` instruction
+        /// \param machine_mode machine mode
+        /// \param insn instruction
+        /// \param mnemonic push or pop
+        /// \return register, if matches. Stack pointer is never returned
+        inline std::optional<zasm::Reg> stack_op_reg(const zasm::MachineMode machine_mode, const zasm::Instruction* insn, const ZydisMnemonic mnemonic) {
+            if (!is(insn, mnemonic)) {
+                return std::nullopt;
+            }
+
+            const auto* reg = insn->getOperandIf<zasm::Reg>(0);
+            if (reg == nullptr || analysis::reg_mask(*reg) == 0 || easm::is_sp(machine_mode, *reg)) {
+                return std::nullopt;
+            }
+
+            return *reg;
+        }
+
+        /// \brief Check whether the instruction could be executed with different flags and a not yet pushed flags value,
+        /// without changing anything. It shouldn't read/write flags, write to the memory or access the stack pointer
+        /// \param machine_mode machine mode
+        /// \param insn instruction
+        /// \return true if neutral
+        inline bool is_flags_neutral(const zasm::MachineMode machine_mode, const zasm::Instruction& insn) {
+            if (easm::affects_ip(insn)) {
+                return false;
+            }
+
+            const auto detail = insn.getDetail(machine_mode);
+            if (!detail.hasValue()) {
+                return false;
+            }
+
+            /// Every single flag counts here, including the DF
+            const auto [set1, set0, modified, tested, undefined] = detail->getCPUFlags();
+            for (const auto flags : {set1, set0, modified, tested, undefined}) {
+                if (flags != zasm::x86::CPUFlags::None) {
+                    return false;
+                }
+            }
+
+            /// Implicit operands (push/pop/etc) are included in the detail.
+            /// The stack pointer is lower by the size of the flags within the range that we're folding, so the instructions
+            /// shouldn't even read it (`mov rax, rsp`, `lea rax, [rsp+8]`, `mov rcx, [rsp+0x30]`)
+            constexpr auto kWrite = static_cast<std::uint8_t>(zasm::Operand::Access::Write) | static_cast<std::uint8_t>(zasm::Operand::Access::CondWrite);
+            for (std::size_t i = 0; i < detail->getOperandCount(); ++i) {
+                const auto access = static_cast<std::uint8_t>(detail->getOperandAccess(i));
+                const auto& operand = detail->getOperand(i);
+
+                if (const auto* mem = operand.getIf<zasm::Mem>(); mem != nullptr) {
+                    if ((access & kWrite) != 0 || easm::is_sp(machine_mode, mem->getBase()) || easm::is_sp(machine_mode, mem->getIndex())) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                if (const auto* reg = operand.getIf<zasm::Reg>(); reg != nullptr && easm::is_sp(machine_mode, *reg)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// \brief Check whether the flags that are set after the node are going to be restored from stack with `popf`
+        /// before anyone could read them
+        /// \param machine_mode machine mode
+        /// \param node node after which the lookup starts
+        /// \return true if flags are dead
+        inline bool flags_restored_after(const zasm::MachineMode machine_mode, zasm::Node* node) {
+            std::size_t looked_up = 0;
+            for (auto* cur = node->getNext(); cur != nullptr && looked_up < kMaxFlagsLookup; cur = cur->getNext()) {
+                /// Labels are fine, we aren't changing anything for the other paths that are going through them
+                if (cur->holds<zasm::Label>()) {
+                    continue;
+                }
+
+                const auto* insn = cur->getIf<zasm::Instruction>();
+                if (insn == nullptr || easm::affects_ip(*insn) || is_pushf(insn)) {
+                    return false;
+                }
+
+                if (is_popf(insn)) {
+                    return true;
+                }
+
+                const auto detail = insn->getDetail(machine_mode);
+                if (!detail.hasValue() || detail->getCPUFlags().tested != zasm::x86::CPUFlags::None) {
+                    return false;
+                }
+
+                ++looked_up;
+            }
+
+            return false;
+        }
+    } // namespace detail
+
+    /// \brief Run the optimizer on the function program
+    /// \tparam Img X64 or X86 image
+    /// \param function function that was obfuscated
+    /// \return number of removed instructions
+    template <pe::any_image_t Img>
+    std::size_t optimize(Function<Img>* function) {
+        const auto machine_mode = function->machine_mode;
+        auto* program = function->program.get();
+
+        /// We're going to destroy nodes that the bbs are referencing, the bbs are no longer needed though
+        const bool observer_was_running = !function->observer->stopped();
+        function->observer->stop();
+
+        std::size_t removed = 0;
+        auto destroy = [&](zasm::Node* node) -> void {
+            program->destroy(node);
+            ++removed;
+        };
+
+        /// Removing stuff could make more stuff adjacent, so repeat until there's nothing left
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            for (auto* node = program->getHead(); node != nullptr;) {
+                auto* next = node->getNext();
+                auto* insn = detail::mutable_insn(node);
+                auto* next_insn = detail::mutable_insn(next);
+
+                if (insn == nullptr) {
+                    node = next;
+                    continue;
+                }
+
+                /// `push reg; pop reg` -> nothing
+                if (const auto reg = detail::stack_op_reg(machine_mode, insn, ZYDIS_MNEMONIC_PUSH); reg.has_value() && //
+                    detail::stack_op_reg(machine_mode, next_insn, ZYDIS_MNEMONIC_POP) == reg) {
+                    node = next->getNext();
+                    destroy(next->getPrev());
+                    destroy(next);
+                    changed = true;
+                    continue;
+                }
+
+                /// `pop reg; push reg` -> `mov reg, [sp]`, a reload of the previous stub followed by a spill of the next one
+                if (const auto reg = detail::stack_op_reg(machine_mode, insn, ZYDIS_MNEMONIC_POP); reg.has_value() && //
+                    reg->getBitSize(machine_mode) == easm::sp_for_arch<Img>().getBitSize(machine_mode) &&
+                    detail::stack_op_reg(machine_mode, next_insn, ZYDIS_MNEMONIC_PUSH) == reg) {
+                    auto* as = *function->cursor->after(next);
+                    as->mov(zasm::x86::Gp(reg->getId()), easm::ptr<Img>(easm::sp_for_arch<Img>()));
+
+                    node = as->getCursor()->getNext();
+                    destroy(next->getPrev());
+                    destroy(next);
+                    --removed; // one is replaced
+                    changed = true;
+                    continue;
+                }
+
+                /// `pushf; popf` -> nothing
+                if (detail::is_pushf(insn) && detail::is_popf(next_insn)) {
+                    node = next->getNext();
+                    destroy(next->getPrev());
+                    destroy(next);
+                    changed = true;
+                    continue;
+                }
+
+                /// `popf; (stuff that doesn't care about flags); pushf; (stuff that doesn't read flags); popf` -> drop the first popf/pushf
+                /// The saved flags value is still on stack, so the second popf would restore exactly the same thing
+                if (detail::is_popf(insn)) {
+                    auto* pushf = next;
+                    while (pushf != nullptr && pushf->holds<zasm::Instruction>() && !detail::is_pushf(pushf->getIf<zasm::Instruction>()) &&
+                           detail::is_flags_neutral(machine_mode, *pushf->getIf<zasm::Instruction>())) {
+                        pushf = pushf->getNext();
+                    }
+
+                    if (detail::is_pushf(detail::mutable_insn(pushf)) && detail::flags_restored_after(machine_mode, pushf)) {
+                        auto* resume = next == pushf ? pushf->getNext() : next;
+                        destroy(pushf);
+                        destroy(node);
+                        node = resume;
+                        changed = true;
+                        continue;
+                    }
+                }
+
+                /// `jmp label; label:` -> `label:`
+                if (detail::is(insn, ZYDIS_MNEMONIC_JMP)) {
+                    if (const auto* target = insn->getOperandIf<zasm::Label>(0); target != nullptr) {
+                        bool falls_through = false;
+                        for (auto* cur = next; cur != nullptr && !falls_through; cur = cur->getNext()) {
+                            const auto* label = cur->getIf<zasm::Label>();
+                            if (label == nullptr) {
+                                break;
+                            }
+
+                            falls_through = label->getId() == target->getId();
+                        }
+
+                        if (falls_through) {
+                            destroy(node);
+                            node = next;
+                            changed = true;
+                            continue;
+                        }
+                    }
+                }
+
+                node = next;
+            }
+        }
+
+        if (observer_was_running) {
+            function->observer->start();
+        }
+
+        if (removed > 0) {
+            logger::debug("peephole: removed {} instructions from {}", removed, function->parsed_func.name);
+        }
+
+        return removed;
+    }
+} // namespace obfuscator::peephole
@@ -0,0 +1,110 @@
+#pragma once
+#include "util/format.hpp"
+#include "util/memory/accounting.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// \note Per-function/per-transform statistics, they're collected only if the output path is set as the size
+/// estimation isn't free. The report is meant to be diffed between the obfuscator versions/configs, so the functions
+/// are stored in the config order and transforms are stored in the order they were applied.
+namespace obfuscator::stats {
+    /// \brief Transform statistics within a function
+    struct transform_t {
+        std::string name = {};
+        /// \brief Number of callback invocations, including repeats and reruns
+        std::size_t invocations = 0;
+        /// \brief Number of passed/failed chance checks
+        std::size_t chance_hits = 0;
+        std::size_t chance_misses = 0;
+        /// \brief Number of instructions that were inserted/destroyed (counted by the observer)
+        std::size_t insns_added = 0;
+        std::size_t insns_removed = 0;
+        /// \brief Registers that were saved on stack by the var allocators
+        std::size_t spilled_registers = 0;
+        std::size_t spilled_bytes = 0;
+        /// \brief Wall time
+        std::chrono::nanoseconds wall_time = {};
+    };
+
+    /// \brief Function statistics
+    struct function_t {
+        std::string name = {};
+        /// \brief Estimated program size before the transforms and after the peephole
+        std::size_t size_before = 0;
+        std::size_t size_after = 0;
+        /// \brief Wall time of the whole function obfuscation
+        std::chrono::nanoseconds wall_time = {};
+        std::vector<transform_t> transforms = {};
+    };
+
+    namespace detail {
+        [[nodiscard]] inline double to_ms(const std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        [[nodiscard]] inline std::string to_json(const transform_t& transform) {
+            return std::format(R"({{"name":{},"invocations":{},"chance_hits":{},"chance_misses":{},"insns_added":{},"insns_removed":{},)"
+                               R"("spilled_registers":{},"spilled_bytes":{},"wall_time_ms":{:.3f}}})",
+                               format::json(transform.name), transform.invocations, transform.chance_hits, transform.chance_misses,
+                               transform.insns_added, transform.insns_removed, transform.spilled_registers, transform.spilled_bytes,
+                               to_ms(transform.wall_time));
+        }
+
+        [[nodiscard]] inline std::string to_json(const function_t& function) {
+            std::string result = std::format(R"({{"name":{},"size_before":{},"size_after":{},"size_growth":{},"wall_time_ms":{:.3f},"transforms":[)",
+                                             format::json(function.name), function.size_before, function.size_after,
+                                             static_cast<std::int64_t>(function.size_after) - static_cast<std::int64_t>(function.size_before),
+                                             to_ms(function.wall_time));
+            for (std::size_t i = 0; i < function.transforms.size(); ++i) {
+                result += (i > 0 ? "," : "") + to_json(function.transforms[i]);
+            }
+            result += "]}";
+            return result;
+        }
+
+        [[nodiscard]] inline std::string to_json(const memory::accounting::usage_t& usage) {
+            return std::format(R"({{"name":{},"allocated":{},"allocations":{},"live":{},"peak":{},"retained":{}}})", format::json(usage.name),
+                               usage.allocated, usage.allocations, usage.live, usage.peak, usage.retained);
+        }
+
+        [[nodiscard]] inline std::string to_json(const std::vector<memory::accounting::usage_t>& usages) {
+            std::string result = "[";
+            for (std::size_t i = 0; i < usages.size(); ++i) {
+                result += (i > 0 ? "," : "") + to_json(usages[i]);
+            }
+            result += "]";
+            return result;
+        }
+    } // namespace detail
+
+    /// \brief Save the statistics as json
+    /// \param path output path
+    /// \param functions function statistics
+    inline void save(const std::filesystem::path& path, const std::vector<function_t>& functions) {
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error(std::format("stats: unable to open {}", path.string()));
+        }
+
+        file << R"({"functions":[)";
+        for (std::size_t i = 0; i < functions.size(); ++i) {
+            file << (i > 0 ? ",\n" : "\n") << detail::to_json(functions[i]);
+        }
+        file << "\n]";
+
+        /// Memory usage is available only if the accounting is compiled in
+        if (memory::accounting::enabled()) {
+            const auto report = memory::accounting::report();
+            file << std::format(R"(,{}"memory":{{"total":{},"stages":{},"functions":{}}})", '\n', detail::to_json(report.total),
+                                detail::to_json(report.stages), detail::to_json(report.functions));
+        }
+
+        file << "}\n";
+    }
+} // namespace obfuscator::stats
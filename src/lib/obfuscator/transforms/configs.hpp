@@ -9,14 +9,18 @@ namespace obfuscator {
         enum e_shared_config_variable_name_index {
             CHANCE = 0,
             REPEAT_TIMES = 1,
+            LOOP_DEPTH_DECAY = 2,
         };
-        inline std::array kSharedConfigsVariableNames = {"chance", "repeat"};
+        inline std::array kSharedConfigsVariableNames = {"chance", "repeat", "loop_depth_decay"};
     } // namespace detail
 
     /// \brief Configuration class that is used in scheduler for storing transform presets
     struct TransformSharedConfig {
         DEFAULT_DTOR(TransformSharedConfig);
-        NON_COPYABLE(TransformSharedConfig);
+        TransformSharedConfig(const TransformSharedConfig&) = default;
+        TransformSharedConfig& operator=(const TransformSharedConfig&) = delete;
+        TransformSharedConfig(TransformSharedConfig&&) = delete;
+        TransformSharedConfig& operator=(TransformSharedConfig&&) = delete;
         TransformSharedConfig(const std::string_view transform_name, const TransformTag transform_tag): name(transform_name), tag(transform_tag) { }
 
         /// \brief Set how many times we need to re-run the transform
@@ -55,6 +59,24 @@ namespace obfuscator {
             return chance_;
         }
 
+        /// \brief Set the chance decay per loop nesting level
+        /// \param decay decay (from 0 to 100)%, the chance within the loop of depth N is `chance * (1 - decay)^N`, 0 (default) disables it
+        /// \param override_default Should we override the default value too?
+        /// \return Config reference
+        TransformSharedConfig& loop_depth_decay(const std::uint8_t decay, const bool override_default = false) noexcept {
+            loop_depth_decay_ = std::clamp(decay, static_cast<std::uint8_t>(0), static_cast<std::uint8_t>(100));
+            if (override_default) {
+                loop_depth_decay_default_ = loop_depth_decay_;
+            }
+            return *this;
+        }
+
+        /// \brief Get the chance decay per loop nesting level
+        /// \return decay (from 0 to 100)%
+        [[nodiscard]] std::uint8_t loop_depth_decay() const noexcept {
+            return loop_depth_decay_;
+        }
+
         /// \brief Try to load the shared configuration var from string
         /// \param name Var name
         /// \param value Var stringified value
@@ -74,6 +96,11 @@ namespace obfuscator {
                                                                                           const auto override_default_) {
                     instance_->repeat_times(util::string::parse_uint8(value_), override_default_);
                 };
+
+                callbacks[detail::kSharedConfigsVariableNames[detail::LOOP_DEPTH_DECAY]] = [](auto* instance_, const auto value_,
+                                                                                              const auto override_default_) {
+                    instance_->loop_depth_decay(util::string::parse_uint8(value_), override_default_);
+                };
             });
 
             /// Try to find the loader, and load if found
@@ -96,6 +123,9 @@ namespace obfuscator {
             if (var_name == detail::kSharedConfigsVariableNames[detail::REPEAT_TIMES]) {
                 return std::to_string(repeat_times());
             }
+            if (var_name == detail::kSharedConfigsVariableNames[detail::LOOP_DEPTH_DECAY]) {
+                return std::to_string(loop_depth_decay());
+            }
             return "unknown var"; // maybe we should throw an exception?
         }
 
@@ -103,6 +133,7 @@ namespace obfuscator {
         void reset() {
             repeat_times_ = repeat_times_default_;
             chance_ = chance_default_;
+            loop_depth_decay_ = loop_depth_decay_default_;
         }
 
         /// \brief Transform human-readable name
@@ -119,13 +150,23 @@ namespace obfuscator {
         /// \brief Transform run chance in percents
         std::uint8_t chance_default_ = 30; // (from 0 to 100)%
         std::uint8_t chance_ = chance_default_;
+
+        /// \brief Chance decay per loop nesting level in percents
+        std::uint8_t loop_depth_decay_default_ = 0; // (from 0 to 100)%
+        std::uint8_t loop_depth_decay_ = loop_depth_decay_default_;
     };
 
     /// \brief Transform configuration storage
     class TransformSharedConfigStorage : public types::Singleton<TransformSharedConfigStorage> {
     public:
         DEFAULT_CTOR_DTOR(TransformSharedConfigStorage);
-        NON_COPYABLE(TransformSharedConfigStorage);
+        TransformSharedConfigStorage& operator=(const TransformSharedConfigStorage&) = delete;
+        TransformSharedConfigStorage(TransformSharedConfigStorage&&) = delete;
+        TransformSharedConfigStorage& operator=(TransformSharedConfigStorage&&) = delete;
+
+        /// \brief Snapshot the storage, used to give every obfuscation worker its own copy of the configs
+        /// \param other Storage that it should copy
+        TransformSharedConfigStorage(const TransformSharedConfigStorage& other): configurations_(other.configurations_) { }
 
         /// \brief Get transform config using the transform tag
         [[nodiscard]] TransformSharedConfig& get_for(const TransformTag tag, const std::optional<std::string_view>& name = std::nullopt) {
@@ -15,19 +15,23 @@ namespace obfuscator {
         NON_COPYABLE(TransformContainer);
         using T = Img;
         using TransformPtr = std::unique_ptr<Transform<Img>>;
+        using TransformFactory = std::function<TransformPtr()>;
         using PairPtr = std::pair<TransformTag, Transform<Img>*>;
 
         /// \brief Register a transform under its tag
         /// \tparam Ty Transform type
         template <template <pe::any_image_t> class Ty>
         TransformSharedConfig& register_transform() {
-            /// Init transform
+            /// Save the transform factory
             const auto tag = get_transform_tag<Ty>();
-            auto instance = std::make_unique<Ty<Img>>();
-            instance->init();
+            factories[tag] = []() -> TransformPtr {
+                auto instance = std::make_unique<Ty<Img>>();
+                instance->init();
+                return instance;
+            };
 
-            /// Save transform
-            transforms[tag] = std::move(instance);
+            /// Init transform
+            transforms[tag] = factories.at(tag)();
 
             /// Init the config and return it
             return TransformSharedConfigStorage::get().get_for<Ty>();
@@ -63,6 +67,21 @@ namespace obfuscator {
             return result;
         }
 
+        /// \brief Create a copy of this container with fresh transform instances, so that the copy
+        /// could be used from a different thread without racing on the transform vars
+        /// \return Container copy
+        [[nodiscard]] std::unique_ptr<TransformContainer> clone() const {
+            auto result = std::make_unique<TransformContainer>();
+            result->enabled = enabled;
+            result->factories = factories;
+
+            for (const auto& [tag, factory] : factories) {
+                result->transforms[tag] = factory();
+            }
+
+            return result;
+        }
+
         /// \brief Iterate over the enabled transforms using callback
         /// \param callback callback that should be invoked for every entry
         void iter_enabled_transforms(const std::function<void(Transform<Img>*)>& callback) {
@@ -106,6 +125,9 @@ namespace obfuscator {
 
         /// \brief A map that stores transforms under their tags
         std::unordered_map<TransformTag, TransformPtr> transforms;
+
+        /// \brief A map that stores transform factories under their tags
+        std::unordered_map<TransformTag, TransformFactory> factories;
     };
 
     /// \brief Transform scheduler that stores all the transforms and their schedule state
@@ -1,6 +1,8 @@
 #pragma once
 #include "obfuscator/function.hpp"
 
+#include <cmath>
+
 namespace obfuscator {
     /// \brief Feature set represents what features does this transform support.
     /// Can contain only bool values by design.
@@ -30,6 +32,20 @@ namespace obfuscator {
         std::unordered_map<Index, bool> values_ = {};
     };
 
+    /// \brief Scale the transform chance according to the basic block hotness and its loop depth
+    /// \param config Transform shared config
+    /// \param bb basic block, could be null
+    /// \return scaled chance (from 0 to 100)%
+    inline std::uint8_t scale_chance(const TransformSharedConfig& config, const analysis::bb_t* bb) {
+        if (bb == nullptr) {
+            return config.chance();
+        }
+
+        auto result = static_cast<double>(config.chance()) * std::clamp(static_cast<double>(bb->chance_scale), 0., 1.);
+        result *= std::pow(1. - static_cast<double>(config.loop_depth_decay()) / 100., static_cast<double>(bb->loop_depth));
+        return static_cast<std::uint8_t>(std::lround(result));
+    }
+
     /// \brief Transform context that gets passed to the transform callback
     class TransformContext {
     public:
@@ -37,6 +53,15 @@ namespace obfuscator {
         NON_COPYABLE(TransformContext);
         explicit TransformContext(TransformSharedConfig& shared_config_value): shared_config(shared_config_value) { }
 
+        /// \brief Get the transform chance for the basic block
+        /// \note Bb/insn transforms are already scaled by the obfuscator before they're invoked, this one is
+        /// for the function transforms that are picking the blocks on their own
+        /// \param bb basic block, could be null
+        /// \return chance (from 0 to 100)%
+        [[nodiscard]] std::uint8_t chance(const analysis::bb_t* bb) const {
+            return scale_chance(shared_config, bb);
+        }
+
         /// \brief Shared config reference
         TransformSharedConfig& shared_config;
 
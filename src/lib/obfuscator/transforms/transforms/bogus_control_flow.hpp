@@ -40,18 +40,18 @@ namespace obfuscator::transforms {
             /// Iterating over the basic blocks
             for (auto& bb : function->bb_storage->temp_copy()) {
                 /// We aren't modifying BBs with no successors
-                if (bb->successors.empty()) {
+                if (bb->successors().empty()) {
                     continue;
                 }
 
-                /// Check chance
-                if (!rnd::chance(ctx.shared_config.chance())) {
+                /// Check chance, hot blocks are getting less of it
+                if (!rnd::chance(ctx.chance(bb))) {
                     continue;
                 }
 
                 /// Generating a BCF stub
                 transform_util::generate_bogus_confrol_flow<Img>(
-                    function, bb.get(),
+                    function, bb,
                     [&](const analysis::bb_t* new_bb) -> void {
                         /// Tamper data if needed
                         switch (mode) { // NOLINT
@@ -1,19 +1,62 @@
 #pragma once
+#include "analysis/loops/loops.hpp"
+#include "analysis/stack_height/stack_height.hpp"
 #include "mathop/mathop.hpp"
 #include "obfuscator/transforms/scheduler.hpp"
 #include "obfuscator/transforms/transforms/util/anti_decompilers.hpp"
 
+#include <limits>
+#include <map>
+#include <unordered_map>
+
 namespace obfuscator::transforms {
     template <pe::any_image_t Img>
     class ConstantCrypt final : public BBTransform<Img> {
     public:
         enum Var {
-            EXPR_SIZE = 0
+            EXPR_SIZE = 0,
+            HOIST_LOOPS = 1,
+            MODE = 2,
+            EXPR_CYCLES = 3,
+        };
+        enum Mode {
+            PER_USE = 0,
+            POOL = 1,
         };
 
+        /// \brief Callback that initializes `features_set_`
+        void init_features() override {
+            BBTransform<Img>::init_features();
+            this->feature(TransformFeaturesSet::Index::HAS_FUNCTION_TRANSFORM, true);
+        }
+
         /// \brief Optional callback that initializes config variables
         void init_config() override {
             this->new_var(Var::EXPR_SIZE, "expr_size", false, TransformConfig::Var::Type::PER_FUNCTION, 5);
+
+            auto& hoist_loops = this->new_var(Var::HOIST_LOOPS, "hoist_loops", false, TransformConfig::Var::Type::PER_FUNCTION, false);
+            hoist_loops.short_description("decrypt the loop invariant constants once, in the loop preheader");
+
+            auto& mode = this->new_var(Var::MODE, "mode", false, TransformConfig::Var::Type::PER_FUNCTION, 0);
+            mode.short_description(std::format("decryption per use - {} || encrypted pool, decrypted at the function entry - {}",
+                                               static_cast<int>(Mode::PER_USE), static_cast<int>(Mode::POOL)));
+
+            auto& expr_cycles = this->new_var(Var::EXPR_CYCLES, "expr_cycles", false, TransformConfig::Var::Type::PER_FUNCTION, 0);
+            expr_cycles.short_description("latency budget of the decryption in cycles, overrides expr_size if set");
+        }
+
+        /// \brief Generate the decryption expression
+        /// \param bit_size operands bit size
+        /// \return expression
+        [[nodiscard]] mathop::Expression generate_expression(const zasm::BitSize bit_size) const {
+            /// Latency budget takes priority over the number of operations
+            if (const auto expr_cycles = this->template get_var_value<int>(Var::EXPR_CYCLES); expr_cycles > 0) {
+                return mathop::ExpressionGenerator::get().generate(bit_size, mathop::budget_t{.cycles = static_cast<std::size_t>(expr_cycles)});
+            }
+
+            const auto expr_size = this->template get_var_value<int>(Var::EXPR_SIZE);
+            assert(expr_size > 0);
+            return mathop::ExpressionGenerator::get().generate(bit_size, static_cast<std::size_t>(expr_size));
         }
 
         void transform_insn(const TransformContext& ctx, Function<Img>* function, analysis::insn_t* insn) const {
@@ -44,8 +87,8 @@ namespace obfuscator::transforms {
             }
             [[maybe_unused]] auto cleaner = function->lru_reg.auto_cleaner();
 
-            /// Alloc some variables
-            auto var_alloc = function->var_alloc();
+            /// Alloc some variables, the decryption clobbers flags so we should save them only if they're alive
+            auto var_alloc = function->var_alloc(analysis::liveness::dead_around(insn), analysis::liveness::live_before(insn).flags);
             auto var_1 = var_alloc.get_for_bits(imm_bitsize);
 
             /// Set cursor
@@ -68,7 +111,7 @@ namespace obfuscator::transforms {
                 }
             }
 
-            /// Check the chance
+            /// Check the chance, bb transforms are already scaled by the block hotness in the scheduler
             if (!rnd::chance(ctx.shared_config.chance())) {
                 return;
             }
@@ -78,9 +121,7 @@ namespace obfuscator::transforms {
             auto* pop_at = insn->node_ref;
 
             /// Generate decryption
-            const auto expr_size = this->template get_var_value<int>(Var::EXPR_SIZE);
-            assert(expr_size > 0);
-            auto expression = mathop::ExpressionGenerator::get().generate(imm_bitsize, expr_size);
+            auto expression = generate_expression(imm_bitsize);
             auto evaluated = expression.emulate(mathop::imm_for_bits(imm_bitsize, imm_value));
 
             /// Setup dst register and lift decryption
@@ -110,6 +151,7 @@ namespace obfuscator::transforms {
 
             /// Swap the operand
             insn->ref->setOperand(*imm_op_index, var_1);
+            insn->update_effects();
 
             /// Allocate vars on stack
             as = *function->cursor->after(push_at);
@@ -125,13 +167,398 @@ namespace obfuscator::transforms {
             var_alloc.pop(as);
         }
 
+        /// \brief Hoist the decryption of constants that are used within the loop to its preheader
+        /// \note The decrypted value is kept in a register that nobody touches within the loop. We can't
+        /// keep it on stack, pushing something in the preheader would shift every sp-relative access in the loop body.
+        /// \param ctx Transform context
+        /// \param function Routine that it should transform
+        /// \param loop Loop that it should transform
+        /// \return number of hoisted constants
+        std::size_t hoist_loop(const TransformContext& ctx, Function<Img>* function, const analysis::loops::loop_t& loop) const {
+            /// The observer inserts new nodes to the bb of the previous insn, so there should be something before the last one
+            auto* preheader = loop.preheader();
+            if (preheader == nullptr || preheader->instructions.size() < 2) {
+                return 0;
+            }
+            auto* anchor = preheader->instructions.back();
+
+            /// Stable order of the blocks, the random stream depends on it
+            std::vector<analysis::bb_t*> blocks(loop.blocks.begin(), loop.blocks.end());
+            std::ranges::sort(blocks, {}, &analysis::bb_t::id);
+
+            /// Collect registers that are used within the loop (and by the anchor, as we're putting stuff right before it),
+            /// calls could clobber anything and we don't know where the unestimated jumps are going to
+            auto used_regs = static_cast<analysis::reg_mask_t>(analysis::reg_mask(easm::sp_for_arch<Img>()) |
+                                                               analysis::reg_mask(zasm::Reg(ZYDIS_REGISTER_RBP)));
+            auto collect = [&used_regs](const analysis::insn_t* insn) -> void {
+                used_regs |= insn->effects.read.regs | insn->effects.written.regs;
+                for (const auto reg : easm::get_all_registers(*insn->ref)) {
+                    used_regs |= analysis::reg_mask(reg);
+                }
+            };
+
+            collect(anchor);
+            for (const auto* bb : blocks) {
+                for (const auto* insn : bb->instructions) {
+                    if (insn->ref->getMnemonic().value() == ZYDIS_MNEMONIC_CALL || (insn->flags & analysis::UNABLE_TO_ESTIMATE_JCC) != 0) {
+                        return 0;
+                    }
+
+                    collect(insn);
+                }
+            }
+
+            /// Registers that contain already decrypted values, (value, bitsize) -> register
+            std::map<std::pair<std::uint64_t, std::uint16_t>, zasm::Reg> decrypted = {};
+
+            std::size_t result = 0;
+            for (auto* bb : blocks) {
+                for (auto* insn : bb->temp_insns_copy()) {
+                    /// Same restrictions as for the regular path
+                    if (insn->reloc.type == analysis::insn_reloc_t::e_type::HEADER || easm::affects_ip(*insn->ref)) {
+                        continue;
+                    }
+
+                    auto imm_op_index = insn->find_operand_index_if<zasm::Imm>();
+                    if (!imm_op_index.has_value()) {
+                        continue;
+                    }
+                    const auto* imm_op = insn->ref->getOperandIf<zasm::Imm>(imm_op_index.value());
+
+                    const auto imm_value = imm_op->value<std::uint64_t>();
+                    const auto imm_bitsize = easm::get_operand_size(function->machine_mode, insn->ref, 0).value_or(imm_op->getBitSize());
+                    const auto key = std::make_pair(imm_value, static_cast<std::uint16_t>(getBitSize(imm_bitsize)));
+
+                    /// We've already decrypted the same value
+                    if (const auto it = decrypted.find(key); it != decrypted.end()) {
+                        result += static_cast<std::size_t>(swap_operand(function, insn, *imm_op_index, it->second));
+                        continue;
+                    }
+
+                    /// The hoisted code is executed only once, so the loop depth doesn't matter here
+                    if (!rnd::chance(ctx.shared_config.chance())) {
+                        continue;
+                    }
+
+                    result += static_cast<std::size_t>(hoist_insn(function, insn, *imm_op_index, anchor, used_regs, decrypted));
+                }
+            }
+
+            return result;
+        }
+
+        /// \brief Decrypt the constant before the anchor and use the decrypted value in the insn
+        /// \param function Routine that it should transform
+        /// \param insn Instruction that uses the constant
+        /// \param imm_op_index Index of the imm operand
+        /// \param anchor The last instruction of the preheader
+        /// \param used_regs Registers that are used within the loop
+        /// \param decrypted Registers with the decrypted values, the new one is inserted on success
+        /// \return true if hoisted
+        bool hoist_insn(Function<Img>* function, analysis::insn_t* insn, const std::size_t imm_op_index, const analysis::insn_t* anchor,
+                        const analysis::reg_mask_t used_regs, std::map<std::pair<std::uint64_t, std::uint16_t>, zasm::Reg>& decrypted) const {
+            const auto* imm_op = insn->ref->getOperandIf<zasm::Imm>(imm_op_index);
+            const auto imm_value = imm_op->value<std::uint64_t>();
+            const auto imm_bitsize = easm::get_operand_size(function->machine_mode, insn->ref, 0).value_or(imm_op->getBitSize());
+
+            /// The register should be dead at the end of the preheader, and since nobody touches it within the loop,
+            /// it would stay dead within the whole loop (except for our value)
+            auto candidates = static_cast<analysis::reg_mask_t>(analysis::liveness::dead_around(anchor) & ~used_regs);
+            if constexpr (!pe::is_x64_v<Img>) {
+                /// No r8-r15 on x86, and only a/b/c/d have the 8bit low parts
+                candidates &= getBitSize(imm_bitsize) == 8 ? 0x0F : 0xFF;
+            }
+            if (candidates == 0) {
+                return false;
+            }
+
+            /// The dead registers are allocated first, the other ones would need to be saved on stack which we can't do
+            auto var_alloc = function->var_alloc(candidates, analysis::liveness::live_before(anchor).flags);
+            auto var_1 = var_alloc.get_for_bits(imm_bitsize);
+            if (var_1.stack_space != 0) {
+                return false;
+            }
+
+            auto as_opt = function->cursor->before(anchor->node_ref);
+            if (!as_opt.has_value() || !swap_operand(function, insn, imm_op_index, var_1)) {
+                return false;
+            }
+            auto as = *as_opt;
+            auto* push_at = as->getCursor();
+
+            /// Generate decryption
+            auto expression = generate_expression(imm_bitsize);
+            auto evaluated = expression.emulate(mathop::imm_for_bits(imm_bitsize, imm_value));
+
+            /// Lift decryption
+            as->mov(var_1, mathop::imm_to_zasm(evaluated));
+            auto decryption_start_at = as->getCursor();
+            expression.lift_revert(as, var_1);
+            auto decryption_ends_at = as->getCursor();
+
+            /// Prevent symbolic execution, its temporary vars could be saved on stack as they aren't used after the stub
+            transform_util::anti_symbolic_execution(var_alloc, imm_bitsize, function->program.get(), as, decryption_start_at, decryption_ends_at);
+
+            /// Restore everything before the anchor
+            as = *function->cursor->before(anchor->node_ref);
+            var_alloc.pop_flags(as);
+            var_alloc.pop(as);
+
+            /// Save everything at the stub start
+            as = *function->cursor->after(push_at);
+            var_alloc.push(as);
+            var_alloc.push_flags(as);
+
+            decrypted.emplace(std::make_pair(imm_value, static_cast<std::uint16_t>(getBitSize(imm_bitsize))), var_1);
+            return true;
+        }
+
+        /// \brief Replace the imm operand with the register/memory, if the insn could be encoded this way
+        /// \param function Routine that it should transform
+        /// \param insn Instruction that it should modify
+        /// \param imm_op_index Index of the imm operand
+        /// \param operand Register or memory that holds the decrypted value
+        /// \return true on success
+        static bool swap_operand(Function<Img>* function, analysis::insn_t* insn, const std::size_t imm_op_index, const zasm::Operand& operand) {
+            const auto original = insn->ref->getOperand(imm_op_index);
+            insn->ref->setOperand(imm_op_index, operand);
+
+            /// Not every insn has the reg/mem form (shl r, imm; imul r, r, imm, etc)
+            if (!insn->ref->getDetail(function->machine_mode).hasValue()) {
+                insn->ref->setOperand(imm_op_index, original);
+                return false;
+            }
+
+            insn->update_effects();
+            return true;
+        }
+
+        /// \brief Move the constants to an encrypted pool that is decrypted on stack at the function entry, so that the uses
+        /// are just loading the decrypted values from there
+        /// \note The pool area is allocated at the very beginning of the function, which shifts everything that's
+        /// stored in the caller frame (return address, args, home space, etc). To fix the sp-relative accesses to it we need
+        /// to know the stack height at every insn, if we don't, the function just stays as is.
+        /// \param ctx Transform context
+        /// \param function Routine that it should transform
+        /// \return number of pooled constants
+        std::size_t build_pool(const TransformContext& ctx, Function<Img>* function) const {
+            using ptr_t = std::conditional_t<pe::is_x64_v<Img>, std::uint64_t, std::uint32_t>;
+            constexpr auto kPtrSize = static_cast<std::int64_t>(sizeof(ptr_t));
+            constexpr auto kPtrMask = static_cast<std::uint64_t>(std::numeric_limits<ptr_t>::max());
+            const auto sp = easm::sp_for_arch<Img>();
+
+            /// The prologue should be executed only once
+            const auto entry = function->bb_storage->find_by_start_rva(function->parsed_func.rva);
+            if (!entry.has_value() || *entry == nullptr || (*entry)->instructions.empty() || !(*entry)->predecessors().empty()) {
+                return 0;
+            }
+
+            const auto heights = analysis::stack_height::compute(*entry);
+            if (!heights.has_value()) {
+                logger::debug("constant_crypt: unable to track sp in {}, skipping the pool", function->parsed_func.name);
+                return 0;
+            }
+
+            /// The pool data goes to the program end, so we shouldn't fall through into it
+            const zasm::Instruction* tail = nullptr;
+            for (const auto* node = function->program->getTail(); node != nullptr && tail == nullptr; node = node->getPrev()) {
+                tail = node->getIf<zasm::Instruction>();
+            }
+            if (tail == nullptr || (!easm::is_ret(*tail) && tail->getMnemonic().value() != ZYDIS_MNEMONIC_JMP)) {
+                return 0;
+            }
+
+            /// Find the exits where the pool area should be released, and the accesses to the caller frame
+            std::vector<analysis::insn_t*> exits = {};
+            std::vector<zasm::Mem*> caller_frame_refs = {};
+            bool supported = true;
+            function->bb_storage->iter_bbs([&](analysis::bb_t& bb) -> void {
+                for (auto* insn : bb.instructions) {
+                    const auto height = heights->find(insn);
+                    if (height == heights->end()) {
+                        supported = false; // unreachable from the entry?
+                        return;
+                    }
+
+                    for (std::size_t i = 0; i < insn->ref->getOperandCount(); ++i) {
+                        auto* mem = insn->ref->getOperandIf<zasm::Mem>(i);
+                        if (mem != nullptr && easm::is_sp(function->machine_mode, mem->getBase()) && height->second + mem->getDisplacement() >= 0) {
+                            caller_frame_refs.emplace_back(mem);
+                        }
+                    }
+                }
+
+                if (bb.instructions.empty()) {
+                    return;
+                }
+
+                auto* last = bb.instructions.back();
+                if (easm::is_ret(*last->ref)) {
+                    exits.emplace_back(last);
+                    return;
+                }
+
+                /// Jumps that are leaving the function, conditional ones aren't supported
+                if (easm::is_jcc_or_jmp(*last->ref)) {
+                    const bool is_jmp = last->ref->getMnemonic().value() == ZYDIS_MNEMONIC_JMP;
+                    if (bb.successors().size() < (is_jmp ? 1U : 2U)) {
+                        supported = supported && is_jmp;
+                        exits.emplace_back(last);
+                    }
+                }
+            });
+            if (!supported) {
+                return 0;
+            }
+
+            /// Rewrite the uses, the slot address is `entry sp - pool size + slot offset`
+            std::vector<std::uint64_t> slots = {};
+            std::unordered_map<std::uint64_t, std::size_t> slot_indices = {};
+            std::size_t result = 0;
+            function->bb_storage->iter_bbs([&](analysis::bb_t& bb) -> void {
+                for (auto* insn : bb.temp_insns_copy()) {
+                    /// Same restrictions as for the regular path, plus the stuff that moves sp as its height would change
+                    if (insn->reloc.type == analysis::insn_reloc_t::e_type::HEADER || easm::affects_ip(*insn->ref) ||
+                        analysis::stack_height::delta(function->machine_mode, *insn).value_or(1) != 0) {
+                        continue;
+                    }
+
+                    auto imm_op_index = insn->find_operand_index_if<zasm::Imm>();
+                    if (!imm_op_index.has_value() || !rnd::chance(ctx.chance(&bb))) {
+                        continue;
+                    }
+                    const auto* imm_op = insn->ref->getOperandIf<zasm::Imm>(imm_op_index.value());
+
+                    const auto imm_value = imm_op->value<std::uint64_t>() & kPtrMask;
+                    const auto imm_bitsize = easm::get_operand_size(function->machine_mode, insn->ref, 0).value_or(imm_op->getBitSize());
+
+                    const auto it = slot_indices.find(imm_value);
+                    const auto index = it != slot_indices.end() ? it->second : slots.size();
+                    const auto displacement = static_cast<std::int64_t>(index) * kPtrSize - heights->at(insn);
+                    if (!swap_operand(function, insn, *imm_op_index, easm::ptr_for_bits(imm_bitsize, sp, displacement))) {
+                        continue;
+                    }
+                    ++result;
+
+                    if (it == slot_indices.end()) {
+                        slot_indices.emplace(imm_value, index);
+                        slots.emplace_back(imm_value);
+                    }
+                }
+            });
+            if (slots.empty()) {
+                return 0;
+            }
+
+            /// Keep the sp aligned, the function could rely on it
+            const auto pool_size = memory::address{slots.size() * static_cast<std::size_t>(kPtrSize)}.align_up(16).as<std::int64_t>();
+            for (auto* mem : caller_frame_refs) {
+                mem->setDisplacement(mem->getDisplacement() + pool_size);
+            }
+
+            /// Encrypt the pool with `seed + i * step` keystream
+            const auto seed = rnd::number<std::uint64_t>() & kPtrMask;
+            const auto step = rnd::number<std::int32_t>();
+            std::vector<std::uint8_t> data = {};
+            data.reserve(slots.size() * static_cast<std::size_t>(kPtrSize));
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                const auto key = (seed + static_cast<std::uint64_t>(static_cast<std::int64_t>(step)) * i) & kPtrMask;
+                const auto encrypted = slots[i] ^ key;
+                for (std::int64_t j = 0; j < kPtrSize; ++j) {
+                    data.emplace_back(static_cast<std::uint8_t>(encrypted >> (j * CHAR_BIT)));
+                }
+            }
+
+            /// The cursor needs something before the first insn
+            auto* first = (*entry)->instructions.front();
+            auto pool_label = function->program->createLabel();
+            if (first->node_ref->getPrev() == nullptr) {
+                function->observer->stop();
+                auto label_node = function->program->bindLabel(function->program->createLabel());
+                function->program->moveBefore(first->node_ref, *label_node);
+                function->observer->start();
+            }
+
+            /// Allocate the pool area and decrypt everything in there
+            const auto live = analysis::liveness::live_before(first);
+            auto var_alloc = function->var_alloc(static_cast<analysis::reg_mask_t>(~live.regs), live.flags);
+            auto as = *function->cursor->before(first->node_ref);
+            as->lea(sp, easm::ptr<Img>(sp, -pool_size));
+            auto* push_at = as->getCursor();
+
+            auto src = var_alloc.get();
+            auto key = var_alloc.get();
+            auto value = var_alloc.get();
+            const auto saved_size = static_cast<std::int64_t>(var_alloc.stack_size()) + (live.flags != 0 ? kPtrSize : 0);
+
+            as->lea(src, easm::ptr<Img>(pool_label));
+            as->mov(key, pe::is_x64_v<Img> ? zasm::Imm(seed) : zasm::Imm(static_cast<std::uint32_t>(seed)));
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                const auto offset = static_cast<std::int64_t>(i) * kPtrSize;
+                as->mov(value, easm::ptr<Img>(src, offset));
+                as->xor_(value, key);
+                as->mov(easm::ptr<Img>(sp, saved_size + offset), value);
+                if (i + 1 < slots.size()) {
+                    as->add(key, zasm::Imm(step));
+                }
+            }
+
+            var_alloc.pop_flags(as);
+            var_alloc.pop(as);
+
+            as = *function->cursor->after(push_at);
+            var_alloc.push(as);
+            var_alloc.push_flags(as);
+
+            /// Release the pool area before leaving the function
+            for (auto* exit : exits) {
+                as = *function->cursor->before(exit->node_ref);
+                as->lea(sp, easm::ptr<Img>(sp, pool_size));
+            }
+
+            /// Place the encrypted pool at the end of the program
+            function->observer->stop();
+            as = *function->cursor->program_tail();
+            as->bind(pool_label);
+            as->embed(data.data(), data.size());
+            function->observer->start();
+
+            return result;
+        }
+
+        /// \brief Transform function, builds the constant pool and hoists the decryption out of loops if enabled
+        /// \param ctx Transform context
+        /// \param function Routine that it should transform
+        void run_on_function(TransformContext& ctx, Function<Img>* function) override {
+            if (static_cast<Mode>(this->template get_var_value<int>(Var::MODE)) == Mode::POOL) {
+                if (const auto pooled = build_pool(ctx, function); pooled > 0) {
+                    logger::debug("constant_crypt: moved {} constant(s) to the pool in {}", pooled, function->parsed_func.name);
+                }
+            }
+
+            if (!this->template get_var_value<bool>(Var::HOIST_LOOPS)) {
+                return;
+            }
+
+            /// Outer loops go first, so that the constants are hoisted as far as possible
+            const auto entry = function->bb_storage->find_by_start_rva(function->parsed_func.rva);
+            std::size_t hoisted = 0;
+            for (const auto& loop : analysis::loops::find(*function->bb_storage, entry.value_or(nullptr))) {
+                hoisted += hoist_loop(ctx, function, loop);
+            }
+
+            if (hoisted > 0) {
+                logger::debug("constant_crypt: hoisted {} constant(s) out of loops in {}", hoisted, function->parsed_func.name);
+            }
+        }
+
         /// \brief Transform analysis insn
         /// \param ctx Transform context
         /// \param function Routine that it should transform
         /// \param bb BB that it should transform
         void run_on_bb(TransformContext& ctx, Function<Img>* function, analysis::bb_t* bb) override {
             for (auto& insn : bb->temp_insns_copy()) {
-                transform_insn(ctx, function, insn.get());
+                transform_insn(ctx, function, insn);
             }
         }
     };
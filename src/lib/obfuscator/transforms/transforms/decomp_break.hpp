@@ -30,7 +30,7 @@ namespace obfuscator::transforms {
         /// \param bb BB that it should transform
         void run_on_bb(TransformContext&, Function<Img>* function, analysis::bb_t* bb) override {
             /// No successors?
-            if (bb->successors.empty()) {
+            if (bb->successors().empty()) {
                 return;
             }
 
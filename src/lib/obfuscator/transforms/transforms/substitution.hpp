@@ -70,8 +70,8 @@ namespace obfuscator::transforms {
                 auto op1 = insn->ref->getOperand<zasm::Operand>(0);
                 auto op2 = insn->ref->getOperand<zasm::Operand>(1);
 
+                auto var_alloc = func->var_alloc(analysis::liveness::dead_around(insn));
                 auto* as = *func->cursor->instead_of(insn->node_ref);
-                auto var_alloc = func->var_alloc();
                 auto op2_wrap = tmp_op_holder_t(as, var_alloc, insn, op2, op1);
 
                 // x - (-y)
@@ -84,8 +84,8 @@ namespace obfuscator::transforms {
                 auto op1 = insn->ref->getOperand<zasm::Operand>(0);
                 auto op2 = insn->ref->getOperand<zasm::Operand>(1);
 
+                auto var_alloc = func->var_alloc(analysis::liveness::dead_around(insn));
                 auto* as = *func->cursor->instead_of(insn->node_ref);
-                auto var_alloc = func->var_alloc();
                 auto op2_wrap = tmp_op_holder_t(as, var_alloc, insn, op2, op1);
 
                 // x + (-y)
@@ -98,8 +98,8 @@ namespace obfuscator::transforms {
                 auto op1 = insn->ref->getOperand<zasm::Operand>(0);
                 auto op2 = insn->ref->getOperand<zasm::Operand>(1);
 
+                auto var_alloc = func->var_alloc(analysis::liveness::dead_around(insn));
                 auto* as = *func->cursor->instead_of(insn->node_ref);
-                auto var_alloc = func->var_alloc();
                 auto op2_wrap = tmp_op_holder_t(as, var_alloc, insn, op2, op1);
 
                 /// ~y
@@ -132,7 +132,7 @@ namespace obfuscator::transforms {
                 }
 
                 auto& cb = rnd::item(it->second);
-                cb(function, insn.get());
+                cb(function, insn);
             }
         }
     };
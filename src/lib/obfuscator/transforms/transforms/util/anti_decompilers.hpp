@@ -1,6 +1,7 @@
 #pragma once
 #include "analysis/analysis.hpp"
 #include "analysis/var_alloc/var_alloc.hpp"
+#include "obfuscator/peephole/peephole.hpp"
 
 namespace obfuscator::transform_util {
     /// \brief Prevent decompilers from symbolic execution of our stubs, also trigger a bug in
@@ -83,8 +84,10 @@ namespace obfuscator::transform_util {
                 /// Push encrypted constant
                 assembler->mov(xchg_enc_holder->root_gp(), zasm::Imm(imm->value<Ty>() - (adc_key + adc_cf_val)));
                 assembler->push(xchg_enc_holder->root_gp());
+                peephole::preserve(assembler->getCursor());
                 /// Pop the encrypted val
                 assembler->pop(xchg_enc_holder->root_gp());
+                peephole::preserve(assembler->getCursor());
                 /// Push it on stack with xchg operation
                 assembler->xchg(easm::ptr<Img>(easm::sp_for_arch<Img>()), xchg_enc_holder->root_gp());
                 /// Load to register
@@ -28,8 +28,8 @@ namespace obfuscator::transform_util {
         /// Crete the label that would be placed at the beginning of the "dead" branch
         auto dummy_bb_label = function->program->createLabel();
 
-        /// Get the var alloc
-        auto var_alloc = function->var_alloc();
+        /// Get the var alloc, the predicate is placed right after the last insn
+        auto var_alloc = function->var_alloc(analysis::liveness::dead_after(last_insn));
 
         /// Temporary disable oserver
         function->observer->stop();
@@ -40,11 +40,11 @@ namespace obfuscator::transform_util {
         auto label_node = as->getCursor();
 
         /// Create dead branch
-        auto new_bb = function->bb_storage->copy_bb(successor, as, function->program.get(), function->bb_provider.get());
+        auto* new_bb = function->bb_storage->copy_bb(successor, as, function->program.get(), function->bb_provider.get());
         new_bb->push_label(label_node, function->bb_provider.get());
 
         /// Tamper instructions, if needed
-        post_generation_callback(new_bb.get());
+        post_generation_callback(new_bb);
 
         /// Re-enable observer
         function->observer->start();
@@ -55,7 +55,7 @@ namespace obfuscator::transform_util {
 
         /// Update successors, predecessors
         /// \fixme @es3n1n: Temporary commented out, uncomment as soon as the fixme in observer is fixed
-        // bb->successors.emplace_back(new_bb);
-        // new_bb->predecessors.emplace_back(bb);
+        // bb->push_successor(new_bb);
+        // new_bb->push_predecessor(bb);
     }
 } // namespace obfuscator::transform_util
\ No newline at end of file
@@ -3,14 +3,18 @@
 #include "analysis/var_alloc/var_alloc.hpp"
 
 namespace obfuscator::transform_util {
+    /// \brief Number of the opaque predicates that we could generate
+    constexpr std::size_t kOpaquePredicatesCount = 67;
+
     /// \brief
     /// \param as Zasm assembler ptr
     /// \param successor_label Successor
     /// \param dead_branch_label Dead branch
     /// \param var_alloc_ptr Var allocator
+    /// \param index Predicate index, random one would be picked if unset
     template <pe::any_image_t Img>
     void generate_opaque_predicate(zasm::x86::Assembler* as, const zasm::Label successor_label, const zasm::Label dead_branch_label,
-                                   analysis::VarAlloc<Img>* var_alloc_ptr) {
+                                   analysis::VarAlloc<Img>* var_alloc_ptr, const std::optional<std::size_t> index = std::nullopt) {
         /// I don't feel like changing these stubs -- fixme
         auto& var_alloc = *var_alloc_ptr;
 
@@ -22,7 +26,7 @@ namespace obfuscator::transform_util {
         as->mov(x, zasm::x86::dword_ptr(easm::sp_for_arch<Img>(), rnd::number<uint32_t>(0, 0x250)));
 
         /// \note @es3n1n: Generated using `scripts/opaque_predicates_expr_gen`
-        switch (rnd::number<std::size_t>(0, 66)) {
+        switch (index.has_value() ? *index : rnd::number<std::size_t>(0, kOpaquePredicatesCount - 1)) {
         // ((x << 16) & 6) == 0
         case 0: {
             as->shl(x, zasm::Imm(16));
@@ -4,6 +4,9 @@
 #include "util/types.hpp"
 #include <linuxpe>
 #include <optional>
+#include <span>
+#include <variant>
+#include <vector>
 
 #define TOGGLE_DIR_IMPORTER(id, name) \
     case id:                          \
@@ -44,6 +47,73 @@ namespace pe {
         std::size_t size; // in bytes
     };
 
+    /// Section contents, either a view of the mapped image or its own copy. The view is materialized (copied) only
+    /// when the section is about to be modified, so that the untouched sections are never copied
+    class section_data_t {
+    public:
+        DEFAULT_CTOR_DTOR(section_data_t);
+        DEFAULT_COPY(section_data_t);
+
+        explicit section_data_t(const std::span<const std::uint8_t> view): storage_(view) { }
+        section_data_t(std::vector<std::uint8_t> data): storage_(std::move(data)) { } // NOLINT
+
+        /// Read-only access, never copies the data
+        [[nodiscard]] std::span<const std::uint8_t> view() const {
+            if (const auto* owned = std::get_if<std::vector<std::uint8_t>>(&storage_)) {
+                return *owned;
+            }
+
+            return std::get<std::span<const std::uint8_t>>(storage_);
+        }
+
+        [[nodiscard]] const std::uint8_t* data() const {
+            return view().data();
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return view().size();
+        }
+
+        [[nodiscard]] bool empty() const {
+            return view().empty();
+        }
+
+        [[nodiscard]] auto begin() const {
+            return view().begin();
+        }
+
+        [[nodiscard]] auto end() const {
+            return view().end();
+        }
+
+        /// Whether the data is still a view of the image
+        [[nodiscard]] bool is_view() const {
+            return std::holds_alternative<std::span<const std::uint8_t>>(storage_);
+        }
+
+        /// Copy the viewed data, if needed
+        /// \return owned data that could be modified
+        std::vector<std::uint8_t>& materialize() {
+            if (const auto* viewed = std::get_if<std::span<const std::uint8_t>>(&storage_)) {
+                storage_ = std::vector<std::uint8_t>(viewed->begin(), viewed->end());
+            }
+
+            return std::get<std::vector<std::uint8_t>>(storage_);
+        }
+
+        /// Write access, materializes the data
+        [[nodiscard]] std::uint8_t* mutable_data() {
+            return materialize().data();
+        }
+
+        void resize(const std::size_t size, const std::uint8_t value = 0) {
+            materialize().resize(size, value);
+        }
+
+    private:
+        std::variant<std::span<const std::uint8_t>, std::vector<std::uint8_t>> storage_ = {};
+    };
+
     struct section_t {
         DEFAULT_CTOR_DTOR(section_t);
         DEFAULT_COPY(section_t);
@@ -61,7 +131,7 @@ namespace pe {
         std::uint32_t ptr_raw_data = 0U;
         win::section_characteristics_t characteristics = {0U};
 
-        std::vector<std::uint8_t> raw_data = {};
+        section_data_t raw_data = {};
 
         /// This struct contains directory offsets within the section, i.e
         /// If a section contains import descriptors the value of iat would be set
@@ -21,15 +21,15 @@ namespace pe {
     }
 
     template <any_raw_image_t Img>
-    [[nodiscard]] std::vector<section_t> Image<Img>::find_sections_if(const std::function<bool(const section_t&)>& pred) const {
-        std::vector<section_t> result = {};
+    [[nodiscard]] std::vector<const section_t*> Image<Img>::find_sections_if(const std::function<bool(const section_t&)>& pred) const {
+        std::vector<const section_t*> result = {};
 
-        std::for_each(sections.begin(), sections.end(), [&result, pred](const section_t& section) -> void {
+        std::for_each(sections.begin(), sections.end(), [&result, &pred](const section_t& section) -> void {
             if (!pred(section)) {
                 return;
             }
 
-            result.emplace_back(section);
+            result.emplace_back(&section);
         });
 
         return result;
@@ -78,7 +78,7 @@ namespace pe {
 
         // Obtaining last section
         //
-        auto last_section = find_last_section();
+        const auto& last_section = find_last_section();
 
         // Obtaining section/file alignment values
         //
@@ -154,14 +154,13 @@ namespace pe {
                 continue;
             }
 
-            // Inserting a section to the result array
+            // Inserting a section to the result array, its data is just a view of the raw image until it's modified
             //
             auto& new_elem = sections.emplace_back(*section);
-            new_elem.raw_data.resize(new_elem.size_raw_data, 0);
 
             // NOLINTNEXTLINE
-            std::memcpy(new_elem.raw_data.data(), reinterpret_cast<std::uint8_t*>(reinterpret_cast<uintptr_t>(raw_image) + new_elem.ptr_raw_data), //
-                        new_elem.size_raw_data);
+            new_elem.raw_data = section_data_t{std::span{reinterpret_cast<const std::uint8_t*>(raw_image) + new_elem.ptr_raw_data, //
+                                                         new_elem.size_raw_data}};
         }
 
         // Signalising that we successfully parsed sections
@@ -250,6 +249,12 @@ namespace pe {
         return rebuild_pe(ctx);
     }
 
+    template <any_raw_image_t Img>
+    void Image<Img>::rebuild_pe_image(const std::filesystem::path& path) {
+        auto ctx = rebuilder_ctx_t<Image>{.image = this};
+        rebuild_pe(ctx, path);
+    }
+
     template class Image<win::image_x64_t>;
     template class Image<win::image_x86_t>;
 } // namespace pe
\ No newline at end of file
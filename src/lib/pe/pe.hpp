@@ -7,6 +7,7 @@
 
 #include "pe/common/types.hpp"
 
+#include <filesystem>
 #include <functional>
 #include <linuxpe>
 #include <unordered_map>
@@ -42,7 +43,7 @@ namespace pe {
 
         [[nodiscard]] bool is_valid() const;
 
-        [[nodiscard]] std::vector<section_t> find_sections_if(const std::function<bool(const section_t&)>& pred) const;
+        [[nodiscard]] std::vector<const section_t*> find_sections_if(const std::function<bool(const section_t&)>& pred) const;
 
         [[nodiscard]] win::cv_pdb70_t* find_codeview70() const;
 
@@ -58,15 +59,28 @@ namespace pe {
 
         [[nodiscard]] section_t* rva_to_section(std::uint32_t rva) const;
 
+        /// Read-only access to the section data, doesn't copy the section
         template <typename Ty = std::uint8_t>
-        [[nodiscard]] Ty* rva_to_ptr(const memory::address rva) const {
+        [[nodiscard]] const Ty* rva_to_ptr(const memory::address rva) const {
             const auto* section = rva_to_section(rva.as<std::uint32_t>());
             if (section == nullptr) {
                 return nullptr;
             }
 
             const auto offset = rva.inner() - section->virtual_address;
-            return memory::address{section->raw_data.data()}.offset(offset).template as<std::add_pointer_t<Ty>>();
+            return memory::address{section->raw_data.data()}.offset(offset).template as<std::add_pointer_t<const Ty>>();
+        }
+
+        /// Write access to the section data, materializes the section if it's still a view of the raw image
+        template <typename Ty = std::uint8_t>
+        [[nodiscard]] Ty* rva_to_mutable_ptr(const memory::address rva) const {
+            auto* section = rva_to_section(rva.as<std::uint32_t>());
+            if (section == nullptr) {
+                return nullptr;
+            }
+
+            const auto offset = rva.inner() - section->virtual_address;
+            return memory::address{section->raw_data.mutable_data()}.offset(offset).template as<std::add_pointer_t<Ty>>();
         }
 
         template <typename Ty = std::size_t>
@@ -84,6 +98,7 @@ namespace pe {
         }
 
         [[nodiscard]] std::vector<std::uint8_t> rebuild_pe_image();
+        void rebuild_pe_image(const std::filesystem::path& path);
 
     private:
         void update_sections();
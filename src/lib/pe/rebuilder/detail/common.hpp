@@ -1,5 +1,9 @@
 #pragma once
 #include "pe/pe.hpp"
+#include "util/files.hpp"
+
+#include <filesystem>
+#include <optional>
 #include <variant>
 
 // there are no other ways, it seems.
@@ -7,6 +11,62 @@
 #define UNWRAP_IMAGE(ty, fn) detail::visit_wrapped_image<ty>(image, &fn<pe::Image<win::image_x64_t>>, &fn<pe::Image<win::image_x86_t>>, data)
 
 namespace pe::detail {
+    /// Rebuilder output, the steps are writing the image directly into it
+    class Output {
+    public:
+        DEFAULT_CTOR(Output);
+        NON_COPYABLE(Output);
+        virtual ~Output() = default;
+
+        /// \brief Allocate the output, should be called only once
+        /// \param size image size, all the bytes are zero-initialized
+        virtual void resize(std::size_t size) = 0;
+
+        [[nodiscard]] virtual std::uint8_t* data() = 0;
+        [[nodiscard]] virtual std::size_t size() const = 0;
+    };
+
+    /// In-memory output
+    class BufferOutput final : public Output {
+    public:
+        void resize(const std::size_t size) override {
+            buffer.resize(size, 0);
+        }
+
+        [[nodiscard]] std::uint8_t* data() override {
+            return buffer.data();
+        }
+
+        [[nodiscard]] std::size_t size() const override {
+            return buffer.size();
+        }
+
+        std::vector<std::uint8_t> buffer = {};
+    };
+
+    /// Output that is written right into the memory-mapped output file, so that we don't hold the image twice
+    class FileOutput final : public Output {
+    public:
+        explicit FileOutput(std::filesystem::path path): path_(std::move(path)) { }
+
+        void resize(const std::size_t size) override {
+            file_.reset();
+            file_.emplace(path_, size);
+        }
+
+        [[nodiscard]] std::uint8_t* data() override {
+            return file_.has_value() ? file_->data() : nullptr;
+        }
+
+        [[nodiscard]] std::size_t size() const override {
+            return file_.has_value() ? file_->size() : 0;
+        }
+
+    private:
+        std::filesystem::path path_ = {};
+        std::optional<util::MappedOutputFile> file_ = std::nullopt;
+    };
+
     template <typename T>
     struct BasePtrWrapper {
         T* ptr;
@@ -25,9 +85,9 @@ namespace pe::detail {
 
     template <typename RetTy = void>
     RetTy visit_wrapped_image(ImgWrapped image_wrapped, //
-                              std::function<RetTy(Image<win::image_x64_t>*, std::vector<std::uint8_t>&)> x64_visitor,
-                              std::function<RetTy(Image<win::image_x86_t>*, std::vector<std::uint8_t>&)> x86_visitor, //
-                              std::vector<std::uint8_t>& data) {
+                              std::function<RetTy(Image<win::image_x64_t>*, Output&)> x64_visitor,
+                              std::function<RetTy(Image<win::image_x86_t>*, Output&)> x86_visitor, //
+                              Output& data) {
         return std::visit<RetTy>(
             [&]<typename Ty>(Ty&& inst) -> RetTy {
                 if constexpr (std::is_same_v<std::decay_t<decltype(inst)>, X64PtrWrapper>) {
@@ -40,7 +100,7 @@ namespace pe::detail {
     }
 
     template <typename Ty>
-    [[nodiscard]] Ty* buffer_pointer(std::vector<std::uint8_t>& data) {
+    [[nodiscard]] Ty* buffer_pointer(Output& data) {
         return memory::cast<Ty*>(data.data());
     }
 } // namespace pe::detail
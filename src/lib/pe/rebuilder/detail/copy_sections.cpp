@@ -7,7 +7,7 @@ namespace pe::detail {
         }
 
         template <any_image_t Img>
-        void copy_sections_(Img* image, std::vector<std::uint8_t>& data) {
+        void copy_sections_(Img* image, Output& data) {
             /// Casting our buffer as the raw image
             auto* out_img = detail::buffer_pointer<to_raw_img_t<Img>>(data);
             auto* nt_headers = out_img->get_nt_headers();
@@ -70,7 +70,7 @@ namespace pe::detail {
         }
     } // namespace
 
-    void copy_sections(const ImgWrapped image, std::vector<std::uint8_t>& data) {
+    void copy_sections(const ImgWrapped image, Output& data) {
         return UNWRAP_IMAGE(void, copy_sections_);
     }
 } // namespace pe::detail
\ No newline at end of file
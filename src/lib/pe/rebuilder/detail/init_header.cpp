@@ -3,7 +3,7 @@
 namespace pe::detail {
     namespace {
         template <any_image_t Img>
-        void init_header_(Img* image, std::vector<std::uint8_t>& data) {
+        void init_header_(Img* image, Output& data) {
             // Obtaining header structs
             //
             auto* nt_headers = image->raw_image->get_nt_headers();
@@ -34,7 +34,7 @@ namespace pe::detail {
         }
     } // namespace
 
-    void init_header(const ImgWrapped image, std::vector<std::uint8_t>& data) {
+    void init_header(const ImgWrapped image, Output& data) {
         return UNWRAP_IMAGE(void, init_header_);
     }
 } // namespace pe::detail
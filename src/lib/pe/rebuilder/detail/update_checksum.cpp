@@ -3,7 +3,7 @@
 namespace pe::detail {
     namespace {
         template <any_image_t Img>
-        void update_checksum_(Img*, std::vector<std::uint8_t>& data) {
+        void update_checksum_(Img*, Output& data) {
             /// Get the headers
             auto* out_img = detail::buffer_pointer<to_raw_img_t<Img>>(data);
 
@@ -12,7 +12,7 @@ namespace pe::detail {
         }
     } // namespace
 
-    void update_checksum(const ImgWrapped image, std::vector<std::uint8_t>& data) {
+    void update_checksum(const ImgWrapped image, Output& data) {
         return UNWRAP_IMAGE(void, update_checksum_);
     }
 } // namespace pe::detail
@@ -30,7 +30,7 @@ namespace pe::detail {
 
             // Obtaining reloc directory and iterating over blocks in order to get the last block
             //
-            auto* dir = memory::cast<win::reloc_directory_t*>(reloc_section->raw_data.data() + reloc_offset);
+            auto* dir = memory::cast<win::reloc_directory_t*>(reloc_section->raw_data.mutable_data() + reloc_offset);
             auto* block = &dir->first_block;
             for (; block && block->size_block != 0U; block = block->next()) {
                 // do nothing
@@ -113,7 +113,7 @@ namespace pe::detail {
             // Inserting the new section with our relocations
             //
             auto& new_section = image->new_section(sections::e_section_t::RELOC, section_size);
-            auto section_data = memory::address{new_section.raw_data.data()};
+            auto section_data = memory::address{new_section.raw_data.mutable_data()};
             auto section_end = section_data.offset(new_section.raw_data.size());
 
             // Serializing reloc entries
@@ -155,13 +155,13 @@ namespace pe::detail {
         }
 
         template <any_image_t Img>
-        void update_relocations_(Img* image, std::vector<std::uint8_t>& data [[maybe_unused]]) {
+        void update_relocations_(Img* image, Output& data [[maybe_unused]]) {
             erase_relocations(image);
             assemble_relocations(image);
         }
     } // namespace
 
-    void update_relocations(const ImgWrapped image, std::vector<std::uint8_t>& data) {
+    void update_relocations(const ImgWrapped image, Output& data) {
         return UNWRAP_IMAGE(void, update_relocations_);
     }
 } // namespace pe::detail
\ No newline at end of file
@@ -1,13 +1,14 @@
 #pragma once
 #include "pe/rebuilder/detail/common.hpp"
 #include "util/progress.hpp"
+#include "util/trace.hpp"
 
 namespace pe {
     namespace detail {
-        void update_relocations(ImgWrapped, std::vector<std::uint8_t>& data);
-        void init_header(ImgWrapped image, std::vector<std::uint8_t>& data);
-        void copy_sections(ImgWrapped image, std::vector<std::uint8_t>& data);
-        void update_checksum(ImgWrapped image, std::vector<std::uint8_t>& data);
+        void update_relocations(ImgWrapped, Output& data);
+        void init_header(ImgWrapped image, Output& data);
+        void copy_sections(ImgWrapped image, Output& data);
+        void update_checksum(ImgWrapped image, Output& data);
     } // namespace detail
 
     template <any_image_t Img>
@@ -19,35 +20,57 @@ namespace pe {
         }
     };
 
+    /// Rebuild the image into the output, the steps are writing directly into it
     template <any_image_t Img>
-    [[nodiscard]] std::vector<std::uint8_t> rebuild_pe(rebuilder_ctx_t<Img> ctx) {
-        // Init result data
-        //
-        std::vector<std::uint8_t> result = {};
+    void rebuild_pe(rebuilder_ctx_t<Img> ctx, detail::Output& result) {
         auto progress = util::Progress("pe: rebuilding", 4);
+        const util::trace::Span _("pe: rebuild");
 
         // Updating .reloc section
         //
-        detail::update_relocations(ctx.wrap(), result);
-        progress.step();
+        {
+            const util::trace::Span step("pe: update relocations");
+            detail::update_relocations(ctx.wrap(), result);
+            progress.step();
+        }
 
         // Reserving and copying the original header first
         //
-        detail::init_header(ctx.wrap(), result);
-        progress.step();
+        {
+            const util::trace::Span step("pe: init header");
+            detail::init_header(ctx.wrap(), result);
+            progress.step();
+        }
 
         // Copying sections
         //
-        detail::copy_sections(ctx.wrap(), result);
-        progress.step();
+        {
+            const util::trace::Span step("pe: copy sections");
+            detail::copy_sections(ctx.wrap(), result);
+            progress.step();
+        }
 
         // Update checksum
         //
-        detail::update_checksum(ctx.wrap(), result);
-        progress.step();
+        {
+            const util::trace::Span step("pe: update checksum");
+            detail::update_checksum(ctx.wrap(), result);
+            progress.step();
+        }
+    }
 
-        // We are done here
-        //
-        return result;
+    /// Rebuild the image into a buffer
+    template <any_image_t Img>
+    [[nodiscard]] std::vector<std::uint8_t> rebuild_pe(rebuilder_ctx_t<Img> ctx) {
+        detail::BufferOutput output = {};
+        rebuild_pe(ctx, output);
+        return std::move(output.buffer);
+    }
+
+    /// Rebuild the image right into the output file, without holding the whole image in an intermediate buffer
+    template <any_image_t Img>
+    void rebuild_pe(rebuilder_ctx_t<Img> ctx, const std::filesystem::path& path) {
+        detail::FileOutput output(path);
+        rebuild_pe(ctx, output);
     }
 } // namespace pe
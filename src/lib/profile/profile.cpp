@@ -0,0 +1,170 @@
+#include "profile/profile.hpp"
+#include "util/files.hpp"
+#include "util/memory/casts.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+namespace profile {
+    namespace {
+        constexpr std::size_t kBinaryRecordSize = sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+        /// \brief Read the little-endian integer
+        template <typename Ty>
+        Ty read_le(const std::uint8_t* ptr) {
+            Ty result = 0;
+            for (std::size_t i = 0; i < sizeof(Ty); ++i) {
+                result |= static_cast<Ty>(ptr[i]) << (i * 8);
+            }
+            return result;
+        }
+
+        /// \brief Parse the whole string as an unsigned integer
+        /// \return nullopt if it's not a number, out of range, or there's something else after it
+        std::optional<std::uint64_t> parse_uint64(std::string_view value, const int base) {
+            if (base == 16 && (value.starts_with("0x") || value.starts_with("0X"))) {
+                value.remove_prefix(2);
+            }
+
+            std::uint64_t result = 0;
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result, base);
+            if (value.empty() || ec != std::errc{} || ptr != value.data() + value.size()) {
+                return std::nullopt;
+            }
+            return result;
+        }
+    } // namespace
+
+    Profile Profile::from_file(const std::filesystem::path& path) {
+        const auto content = util::read_file(path);
+        if (content.empty()) {
+            throw std::runtime_error(std::format("profile: unable to read {}", path.string()));
+        }
+
+        if (content.size() >= kBinaryMagic.size() && std::memcmp(content.data(), kBinaryMagic.data(), kBinaryMagic.size()) == 0) {
+            return from_binary(content);
+        }
+
+        return from_text(std::string_view{memory::cast<const char*>(content.data()), content.size()});
+    }
+
+    Profile Profile::from_text(const std::string_view content) {
+        Profile result = {};
+
+        std::istringstream stream{std::string{content}};
+        for (std::string line; std::getline(stream, line);) {
+            /// Strip the comments
+            if (const auto comment = line.find('#'); comment != std::string::npos) {
+                line.resize(comment);
+            }
+
+            std::istringstream line_stream(line);
+            std::string rva;
+            std::string hits;
+            if (!(line_stream >> rva)) {
+                continue; // empty line
+            }
+
+            std::string rest;
+            const auto rva_value = parse_uint64(rva, 16);
+            const auto hits_value = line_stream >> hits ? parse_uint64(hits, 10) : std::nullopt;
+            if (!rva_value.has_value() || !hits_value.has_value() || line_stream >> rest) {
+                throw std::runtime_error(std::format("profile: invalid line `{}`", line));
+            }
+
+            result.samples_.emplace_back(sample_t{
+                .rva = *rva_value,
+                .hits = *hits_value,
+            });
+        }
+
+        result.finalize();
+        return result;
+    }
+
+    Profile Profile::from_binary(const std::span<const std::uint8_t> content) {
+        if (content.size() < kBinaryMagic.size() || (content.size() - kBinaryMagic.size()) % kBinaryRecordSize != 0) {
+            throw std::runtime_error("profile: invalid binary profile size");
+        }
+
+        Profile result = {};
+        result.samples_.reserve((content.size() - kBinaryMagic.size()) / kBinaryRecordSize);
+        for (auto offset = kBinaryMagic.size(); offset < content.size(); offset += kBinaryRecordSize) {
+            result.samples_.emplace_back(sample_t{
+                .rva = read_le<std::uint32_t>(content.data() + offset),
+                .hits = read_le<std::uint64_t>(content.data() + offset + sizeof(std::uint32_t)),
+            });
+        }
+
+        result.finalize();
+        return result;
+    }
+
+    std::uint64_t Profile::hits(const types::rva_t start, const types::rva_t end) const {
+        const auto start_value = start.as<std::uint64_t>();
+        const auto end_value = end.as<std::uint64_t>();
+
+        std::uint64_t result = 0;
+        auto it = std::ranges::lower_bound(samples_, start_value, {}, &sample_t::rva);
+        for (; it != samples_.end() && it->rva < end_value; ++it) {
+            result += it->hits;
+        }
+        return result;
+    }
+
+    void Profile::finalize() {
+        std::ranges::sort(samples_, {}, &sample_t::rva);
+
+        /// Merge samples with the same rva
+        std::vector<sample_t> merged = {};
+        merged.reserve(samples_.size());
+        for (const auto& sample : samples_) {
+            if (!merged.empty() && merged.back().rva == sample.rva) {
+                merged.back().hits += sample.hits;
+                continue;
+            }
+
+            merged.emplace_back(sample);
+        }
+
+        samples_ = std::move(merged);
+    }
+
+    std::vector<float> chance_scales(const std::span<const std::uint64_t> hits) {
+        std::vector<float> result(hits.size(), 1.F);
+        if (hits.empty()) {
+            return result;
+        }
+
+        /// Hits of the least hot block within the top share
+        std::vector<std::uint64_t> sorted(hits.begin(), hits.end());
+        const auto hot_count = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(static_cast<double>(sorted.size()) * kHotBlocksShare)));
+        std::ranges::nth_element(sorted, sorted.begin() + static_cast<std::ptrdiff_t>(hot_count - 1), std::ranges::greater{});
+        const auto hot_threshold = sorted[hot_count - 1];
+        const auto max_hits = *std::ranges::max_element(hits);
+        if (max_hits == 0) {
+            return result;
+        }
+
+        const auto log_max = std::log1p(static_cast<double>(max_hits));
+        for (std::size_t i = 0; i < hits.size(); ++i) {
+            if (hits[i] == 0) {
+                continue;
+            }
+
+            if (hits[i] >= hot_threshold) {
+                result[i] = 0.F;
+                continue;
+            }
+
+            result[i] = static_cast<float>(1. - std::log1p(static_cast<double>(hits[i])) / log_max);
+        }
+        return result;
+    }
+} // namespace profile
@@ -0,0 +1,80 @@
+#pragma once
+#include "util/structs.hpp"
+#include "util/types.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/// \note Sample-based execution profiles (RVA -> hit count), e.g. exported from ETW/VTune/perf.
+/// Two formats are supported:
+/// - text, one `<rva> <hits>` pair per line, rva is in hex (with or without the `0x` prefix), `#` starts a comment
+/// - binary, `kBinaryMagic` followed by the packed little-endian `{u32 rva; u64 hits}` records
+namespace profile {
+    /// \brief Magic of the binary profiles
+    constexpr std::string_view kBinaryMagic = "OBFPROF1";
+
+    /// \brief A single sample
+    struct sample_t {
+        std::uint64_t rva = 0;
+        std::uint64_t hits = 0;
+    };
+
+    class Profile {
+    public:
+        DEFAULT_CTOR_DTOR(Profile);
+        DEFAULT_COPY(Profile);
+
+        /// \brief Load the profile from file, format is detected by its magic
+        /// \param path file path
+        /// \return parsed profile
+        [[nodiscard]] static Profile from_file(const std::filesystem::path& path);
+
+        /// \brief Parse the text profile
+        /// \param content file contents
+        /// \return parsed profile
+        [[nodiscard]] static Profile from_text(std::string_view content);
+
+        /// \brief Parse the binary profile
+        /// \param content file contents, including the magic
+        /// \return parsed profile
+        [[nodiscard]] static Profile from_binary(std::span<const std::uint8_t> content);
+
+        /// \brief Get the sum of hits within the range
+        /// \param start range start
+        /// \param end range end (exclusive)
+        /// \return number of hits
+        [[nodiscard]] std::uint64_t hits(types::rva_t start, types::rva_t end) const;
+
+        /// \brief Get the number of samples (with unique rvas)
+        [[nodiscard]] std::size_t size() const noexcept {
+            return samples_.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return samples_.empty();
+        }
+
+    private:
+        /// \brief Sort samples by rva and merge the duplicates, should be called after the parsing
+        void finalize();
+
+        /// \brief Samples sorted by rva
+        std::vector<sample_t> samples_ = {};
+    };
+
+    /// \brief Share of the hottest blocks (by rank) that are left untouched
+    constexpr double kHotBlocksShare = 0.01;
+
+    /// \brief Convert the hits of the blocks to the transform chance multipliers.
+    /// Sample profiles are heavily skewed, so the hits aren't compared linearly against the hottest block:
+    /// - the top `kHotBlocksShare` of the blocks (by rank, at least one block) get 0
+    /// - the other blocks get `1 - log(1 + hits) / log(1 + max_hits)`, so the blocks with a few hits keep most of the chance,
+    ///   while the ones that are within an order of magnitude or two of the hottest one get very little of it
+    /// - blocks that were never hit get 1
+    /// \param hits hits of every block
+    /// \return chance multipliers (from 0 to 1), in the same order
+    [[nodiscard]] std::vector<float> chance_scales(std::span<const std::uint64_t> hits);
+} // namespace profile
@@ -1,9 +1,21 @@
 #pragma once
+#include "util/platform.hpp"
+#include "util/structs.hpp"
+
 #include <cstdint>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
+#if PLATFORM_IS_UNIX
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace util {
     inline std::vector<std::uint8_t> read_file(const std::filesystem::path& path) {
         std::fstream file(path, std::ios::in | std::ios::binary);
@@ -29,4 +41,156 @@ namespace util {
         file.write(reinterpret_cast<const char*>(raw_buffer), buffer_size);
         file.close();
     }
+
+    /// \brief File that is mapped into memory as copy-on-write, so that the mapped data could be patched in place
+    /// without touching the file and only the patched pages are copied. The mapping is empty if the file can't be mapped
+    class MappedFile {
+    public:
+        NON_COPYABLE(MappedFile);
+
+        explicit MappedFile(const std::filesystem::path& path) {
+#if PLATFORM_IS_WIN
+            auto* const file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+
+            LARGE_INTEGER file_size = {};
+            if (GetFileSizeEx(file, &file_size) == FALSE || file_size.QuadPart <= 0) {
+                CloseHandle(file);
+                return;
+            }
+
+            /// The view keeps the mapping alive, so we can close the handles right away
+            auto* const mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr) {
+                return;
+            }
+
+            data_ = static_cast<std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+            CloseHandle(mapping);
+            size_ = data_ != nullptr ? static_cast<std::size_t>(file_size.QuadPart) : 0;
+#else
+            const auto fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+
+            struct stat info = {};
+            if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+                close(fd);
+                return;
+            }
+
+            /// The mapping holds its own reference to the file, so we can close it right away
+            auto* const mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapped == MAP_FAILED) {
+                return;
+            }
+
+            data_ = static_cast<std::uint8_t*>(mapped);
+            size_ = static_cast<std::size_t>(info.st_size);
+#endif
+        }
+
+        ~MappedFile() {
+            if (data_ == nullptr) {
+                return;
+            }
+
+#if PLATFORM_IS_WIN
+            UnmapViewOfFile(data_);
+#else
+            munmap(data_, size_);
+#endif
+        }
+
+        [[nodiscard]] std::uint8_t* data() const {
+            return data_;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return size_;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size_ == 0;
+        }
+
+    private:
+        std::uint8_t* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    /// \brief Output file that is mapped into memory, so that it could be written in place without an intermediate
+    /// buffer. The file is created (or truncated) and sized up front, all the bytes are zero-initialized
+    class MappedOutputFile {
+    public:
+        NON_COPYABLE(MappedOutputFile);
+
+        MappedOutputFile(const std::filesystem::path& path, const std::size_t size): size_(size) {
+            if (size == 0) {
+                throw std::runtime_error(std::format("files: unable to map an empty output file {}", path.string()));
+            }
+
+#if PLATFORM_IS_WIN
+            auto* const file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error(std::format("files: unable to create {}", path.string()));
+            }
+
+            /// Mapping extends the file to the mapping size
+            const auto large_size = static_cast<std::uint64_t>(size);
+            auto* const mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(large_size >> 32U),
+                                                     static_cast<DWORD>(large_size & 0xFFFFFFFFU), nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr) {
+                throw std::runtime_error(std::format("files: unable to size {}", path.string()));
+            }
+
+            data_ = static_cast<std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+            CloseHandle(mapping);
+#else
+            const auto fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                throw std::runtime_error(std::format("files: unable to create {}", path.string()));
+            }
+
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                close(fd);
+                throw std::runtime_error(std::format("files: unable to size {}", path.string()));
+            }
+
+            auto* const mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            data_ = mapped != MAP_FAILED ? static_cast<std::uint8_t*>(mapped) : nullptr;
+#endif
+            if (data_ == nullptr) {
+                throw std::runtime_error(std::format("files: unable to map {}", path.string()));
+            }
+        }
+
+        /// Written pages are flushed by the system once they're unmapped
+        ~MappedOutputFile() {
+#if PLATFORM_IS_WIN
+            UnmapViewOfFile(data_);
+#else
+            munmap(data_, size_);
+#endif
+        }
+
+        [[nodiscard]] std::uint8_t* data() const {
+            return data_;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return size_;
+        }
+
+    private:
+        std::uint8_t* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
 } // namespace util
\ No newline at end of file
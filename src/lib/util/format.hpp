@@ -2,6 +2,7 @@
 #include "util/sections.hpp"
 #include <format>
 #include <string>
+#include <string_view>
 
 namespace format {
     inline std::string loc(const std::int32_t rva) {
@@ -11,4 +12,31 @@ namespace format {
     inline std::string sec(const sections::e_section_t sec) {
         return name(sec);
     }
+
+    /// \brief Escape and quote the string for json
+    inline std::string json(const std::string_view value) {
+        std::string result = "\"";
+        result.reserve(value.size() + 2);
+
+        for (const char c : value) {
+            switch (c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+                    break;
+                }
+                result += c;
+                break;
+            }
+        }
+
+        result += '"';
+        return result;
+    }
 } // namespace format
@@ -0,0 +1,275 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace util {
+    template <typename Ty>
+    class IntrusiveList;
+
+    /// \brief A hook that should be inherited by the intrusive list nodes, the node knows its own position
+    /// within the list, so that it could be erased or used as an insertion point in O(1)
+    /// \tparam Ty Node type
+    template <typename Ty>
+    class IntrusiveListHook {
+    public:
+        DEFAULT_CTOR_DTOR(IntrusiveListHook);
+
+        /// \brief Nodes shouldn't inherit the position of other nodes
+        IntrusiveListHook(const IntrusiveListHook&) noexcept { }
+        IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept {
+            return *this;
+        }
+
+        /// \brief Check whether this node is stored in some list
+        /// \return true/false
+        [[nodiscard]] bool is_linked() const noexcept {
+            return owner_ != nullptr;
+        }
+
+    private:
+        friend class IntrusiveList<Ty>;
+
+        Ty* prev_ = nullptr;
+        Ty* next_ = nullptr;
+
+        /// \brief Pointer to the node itself, so that the iterators could return references
+        Ty* self_ = nullptr;
+        const IntrusiveList<Ty>* owner_ = nullptr;
+    };
+
+    /// \brief Doubly linked list where the links are stored within the nodes
+    /// \note The list doesn't own its nodes, they should outlive it
+    /// \tparam Ty Node type, should inherit the `IntrusiveListHook<Ty>`
+    template <typename Ty>
+    class IntrusiveList {
+        using Hook = IntrusiveListHook<Ty>;
+
+    public:
+        DEFAULT_CTOR(IntrusiveList);
+        NON_COPYABLE(IntrusiveList);
+
+        ~IntrusiveList() {
+            clear();
+        }
+
+        class iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using iterator_concept = std::bidirectional_iterator_tag;
+            using value_type = Ty*;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Ty* const*;
+            using reference = Ty* const&;
+
+            DEFAULT_CTOR_DTOR(iterator);
+            DEFAULT_COPY(iterator);
+            iterator(Ty* node, const IntrusiveList* list): node_(node), list_(list) { }
+
+            /// \note The reference points to the node itself rather than to the iterator, so it stays valid
+            /// even if the iterator goes away (`std::reverse_iterator` relies on this)
+            reference operator*() const {
+                assert(node_ != nullptr);
+                return hook(node_)->self_;
+            }
+
+            pointer operator->() const {
+                return &**this;
+            }
+
+            iterator& operator++() {
+                assert(node_ != nullptr);
+                node_ = hook(node_)->next_;
+                return *this;
+            }
+
+            iterator operator++(int) {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            iterator& operator--() {
+                assert(list_ != nullptr);
+                node_ = node_ == nullptr ? list_->tail_ : hook(node_)->prev_;
+                return *this;
+            }
+
+            iterator operator--(int) {
+                auto result = *this;
+                --*this;
+                return result;
+            }
+
+            bool operator==(const iterator& other) const noexcept {
+                return node_ == other.node_;
+            }
+
+            /// \brief Get the raw node pointer
+            /// \return node ptr, nullptr for the end iterator
+            [[nodiscard]] Ty* get() const noexcept {
+                return node_;
+            }
+
+        private:
+            Ty* node_ = nullptr;
+            const IntrusiveList* list_ = nullptr;
+        };
+
+        using const_iterator = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using value_type = Ty*;
+
+        /// \brief Insert the node before the `pos`
+        /// \param pos insertion point
+        /// \param node node that it should insert, shouldn't be linked anywhere
+        /// \return iterator to the inserted node
+        iterator insert(const iterator pos, Ty* node) {
+            auto* node_hook = hook(node);
+            assert(node != nullptr && !node_hook->is_linked());
+
+            auto* next = pos.get();
+            auto* prev = next != nullptr ? hook(next)->prev_ : tail_;
+
+            node_hook->prev_ = prev;
+            node_hook->next_ = next;
+            node_hook->self_ = node;
+            node_hook->owner_ = this;
+
+            (prev != nullptr ? hook(prev)->next_ : head_) = node;
+            (next != nullptr ? hook(next)->prev_ : tail_) = node;
+
+            ++size_;
+            return iterator(node, this);
+        }
+
+        /// \brief Insert the node at the end of the list
+        /// \param node node
+        /// \return node ptr
+        Ty* push_back(Ty* node) {
+            return *insert(end(), node);
+        }
+
+        /// \brief Erase the node
+        /// \param pos node position
+        /// \return iterator to the next node
+        iterator erase(const iterator pos) {
+            auto* node = pos.get();
+            assert(node != nullptr && hook(node)->owner_ == this);
+            auto* node_hook = hook(node);
+
+            auto* prev = node_hook->prev_;
+            auto* next = node_hook->next_;
+            (prev != nullptr ? hook(prev)->next_ : head_) = next;
+            (next != nullptr ? hook(next)->prev_ : tail_) = prev;
+
+            node_hook->prev_ = nullptr;
+            node_hook->next_ = nullptr;
+            node_hook->self_ = nullptr;
+            node_hook->owner_ = nullptr;
+            --size_;
+            return iterator(next, this);
+        }
+
+        /// \brief Erase all the nodes that match the predicate
+        /// \param predicate callback
+        /// \return number of erased nodes
+        std::size_t erase_if(const std::function<bool(Ty*)>& predicate) {
+            std::size_t result = 0;
+
+            for (auto it = begin(); it != end();) {
+                if (!predicate(*it)) {
+                    ++it;
+                    continue;
+                }
+
+                it = erase(it);
+                ++result;
+            }
+
+            return result;
+        }
+
+        /// \brief Erase all the nodes
+        void clear() {
+            for (auto it = begin(); it != end();) {
+                it = erase(it);
+            }
+        }
+
+        /// \brief Get the node position in O(1)
+        /// \param node node ptr, should be linked to this list
+        /// \return iterator
+        [[nodiscard]] iterator iterator_to(const Ty* node) const {
+            assert(node != nullptr && hook(node)->owner_ == this);
+            return iterator(const_cast<Ty*>(node), this);
+        }
+
+        /// \brief Check whether the node is linked to this list
+        /// \param node node ptr
+        /// \return true/false
+        [[nodiscard]] bool contains(const Ty* node) const noexcept {
+            return node != nullptr && hook(node)->owner_ == this;
+        }
+
+        /// \brief Get the node by its index
+        /// \note This is O(n), prefer iterators whenever possible
+        /// \param index node index
+        /// \return node ptr
+        [[nodiscard]] Ty* at(const std::size_t index) const {
+            assert(index < size_);
+            return *std::next(begin(), static_cast<std::ptrdiff_t>(index));
+        }
+
+        [[nodiscard]] Ty* front() const {
+            assert(head_ != nullptr);
+            return head_;
+        }
+
+        [[nodiscard]] Ty* back() const {
+            assert(tail_ != nullptr);
+            return tail_;
+        }
+
+        [[nodiscard]] iterator begin() const noexcept {
+            return iterator(head_, this);
+        }
+
+        [[nodiscard]] iterator end() const noexcept {
+            return iterator(nullptr, this);
+        }
+
+        [[nodiscard]] reverse_iterator rbegin() const noexcept {
+            return reverse_iterator(end());
+        }
+
+        [[nodiscard]] reverse_iterator rend() const noexcept {
+            return reverse_iterator(begin());
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size_ == 0;
+        }
+
+    private:
+        static Hook* hook(Ty* node) noexcept {
+            return static_cast<Hook*>(node);
+        }
+
+        static const Hook* hook(const Ty* node) noexcept {
+            return static_cast<const Hook*>(node);
+        }
+
+        Ty* head_ = nullptr;
+        Ty* tail_ = nullptr;
+        std::size_t size_ = 0;
+    };
+} // namespace util
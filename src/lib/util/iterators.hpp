@@ -3,7 +3,7 @@
 
 namespace util {
     template <typename Ty>
-    class DerefSharedPtrIter {
+    class DerefPtrIter {
     public:
         using iterator_category = std::forward_iterator_tag;
         using value_type = std::remove_const_t<Ty>;
@@ -11,19 +11,19 @@ namespace util {
         using pointer = value_type*;
         using reference = value_type&;
 
-        using base_iter_type = typename std::vector<std::shared_ptr<value_type>>::iterator;
-        using const_base_iter_type = typename std::vector<std::shared_ptr<value_type>>::const_iterator;
+        using base_iter_type = typename std::vector<value_type*>::iterator;
+        using const_base_iter_type = typename std::vector<value_type*>::const_iterator;
         using iter_type = std::conditional_t<std::is_const_v<Ty>, const_base_iter_type, base_iter_type>;
 
-        explicit DerefSharedPtrIter(iter_type it): it_(it) { }
-        DEFAULT_DTOR(DerefSharedPtrIter);
+        explicit DerefPtrIter(iter_type it): it_(it) { }
+        DEFAULT_DTOR(DerefPtrIter);
 
-        DerefSharedPtrIter& operator++() {
+        DerefPtrIter& operator++() {
             ++it_;
             return *this;
         }
 
-        bool operator!=(const DerefSharedPtrIter& other) const {
+        bool operator!=(const DerefPtrIter& other) const {
             return it_ != other.it_;
         }
 
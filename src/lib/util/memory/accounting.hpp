@@ -0,0 +1,297 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// \note Allocation accounting, scoped by the trace spans (see `util::trace::Span`). Every allocation is
+/// accounted to the innermost span of the thread that made it, both to its stage (span name) and to its function (the
+/// function of the innermost span that has one). The accounting itself is done by the global operator new hook, which
+/// is compiled into the obfuscator only if `OBFUSCATOR_MEMORY_ACCOUNTING` is set, as it adds a header to every allocation.
+namespace memory::accounting {
+    namespace detail {
+        struct frame_t;
+    } // namespace detail
+
+    /// \brief Accumulated allocations
+    struct entry_t {
+        /// \brief Total number of allocated bytes/allocations
+        std::atomic<std::uint64_t> allocated = 0;
+        std::atomic<std::uint64_t> allocations = 0;
+        /// \brief Bytes that are still alive
+        std::atomic<std::int64_t> live = 0;
+        /// \brief Max of `live`
+        std::atomic<std::int64_t> peak = 0;
+        /// \brief Bytes that were allocated within the scope instances and were still alive when they were left, summed up
+        std::atomic<std::int64_t> retained = 0;
+
+        void on_alloc(const std::size_t size) noexcept {
+            allocated.fetch_add(size, std::memory_order_relaxed);
+            allocations.fetch_add(1, std::memory_order_relaxed);
+
+            const auto now = live.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) + static_cast<std::int64_t>(size);
+            for (auto prev = peak.load(std::memory_order_relaxed); prev < now && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed);) {
+                // retry
+            }
+        }
+
+        void on_free(const std::size_t size) noexcept {
+            live.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+        }
+    };
+
+    /// \brief Entries that the allocation is accounted to, should be stored by the hook along with the allocation
+    struct owner_t {
+        entry_t* stage = nullptr;
+        entry_t* function = nullptr;
+        /// \brief Scope instance that made the allocation, it's never dereferenced by the other threads
+        const detail::frame_t* frame = nullptr;
+        std::uint64_t serial = 0;
+    };
+
+    namespace detail {
+        /// \brief State of the scope instance, `live` values are touched only by the thread that owns the scope, so that
+        /// the retained bytes of every instance are its own and don't depend on what the other threads are doing with the entry
+        struct frame_t {
+            frame_t* parent = nullptr;
+            /// \brief The frame that has introduced the current function, could be this one
+            frame_t* function_frame = nullptr;
+            /// \brief Frames are stack allocated, so the same address could be reused by the next scope
+            std::uint64_t serial = 0;
+            /// \brief Bytes that were allocated within this scope (nested stages excluded) and are still alive
+            std::int64_t stage_live = 0;
+            /// \brief Bytes that were allocated within the function (nested stages included) and are still alive
+            std::int64_t function_live = 0;
+        };
+
+        // NOLINTBEGIN
+        inline constinit std::atomic_bool enabled = false;
+        /// \brief Allocations that were made outside of any scope, as well as the whole process allocations
+        inline constinit entry_t unscoped = {};
+        inline constinit entry_t total = {};
+        /// \brief Owner of the allocations that are made by this thread
+        inline constinit thread_local owner_t current = {};
+        /// \brief Innermost scope instance of this thread
+        inline constinit thread_local frame_t* frame = nullptr;
+        inline constinit thread_local std::uint64_t frame_serial = 0;
+        // NOLINTEND
+
+        /// \brief Named entries storage, entries are never released as the allocations could outlive their scopes
+        class Registry {
+        public:
+            using Entries = std::map<std::string, std::unique_ptr<entry_t>, std::less<>>;
+
+            /// \brief The registry is leaked on purpose, the static objects that are destroyed after it are still
+            /// referencing its entries from their allocation headers
+            [[nodiscard]] static Registry& get() {
+                static auto* instance = new Registry(); // NOLINT(cppcoreguidelines-owning-memory)
+                return *instance;
+            }
+
+            [[nodiscard]] entry_t* stage(const std::string_view name) {
+                return find_or_create(stages_, name);
+            }
+
+            [[nodiscard]] entry_t* function(const std::string_view name) {
+                return find_or_create(functions_, name);
+            }
+
+            /// \brief Iterate over the stages and functions
+            template <typename Fn>
+            void iter(Fn&& callback) {
+                const std::lock_guard _(mtx_);
+                callback(stages_, functions_);
+            }
+
+        private:
+            [[nodiscard]] entry_t* find_or_create(Entries& entries, const std::string_view name) {
+                const std::lock_guard _(mtx_);
+                if (const auto it = entries.find(name); it != entries.end()) {
+                    return it->second.get();
+                }
+
+                return entries.emplace(std::string{name}, std::make_unique<entry_t>()).first->second.get();
+            }
+
+            std::mutex mtx_ = {};
+            Entries stages_ = {};
+            Entries functions_ = {};
+        };
+    } // namespace detail
+
+    /// \brief Start accounting the allocations to the scopes, should be called by the hook owner
+    inline void enable() {
+        detail::enabled.store(true, std::memory_order_release);
+    }
+
+    /// \brief Check whether the allocations are accounted
+    [[nodiscard]] inline bool enabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Account the allocation to the current scope
+    /// \param size allocation size
+    /// \return owner that should be passed to `on_free` once this allocation is released
+    [[nodiscard]] inline owner_t on_alloc(const std::size_t size) noexcept {
+        detail::total.on_alloc(size);
+
+        auto owner = detail::current;
+        if (owner.stage == nullptr) {
+            owner.stage = &detail::unscoped;
+        }
+
+        if (auto* frame = detail::frame; frame != nullptr) {
+            owner.frame = frame;
+            owner.serial = frame->serial;
+            frame->stage_live += static_cast<std::int64_t>(size);
+            if (frame->function_frame != nullptr) {
+                frame->function_frame->function_live += static_cast<std::int64_t>(size);
+            }
+        }
+
+        owner.stage->on_alloc(size);
+        if (owner.function != nullptr) {
+            owner.function->on_alloc(size);
+        }
+        return owner;
+    }
+
+    /// \brief Release the allocation
+    /// \param owner owner that was returned by `on_alloc`
+    /// \param size allocation size
+    inline void on_free(const owner_t& owner, const std::size_t size) noexcept {
+        detail::total.on_free(size);
+        if (owner.stage != nullptr) {
+            owner.stage->on_free(size);
+        }
+        if (owner.function != nullptr) {
+            owner.function->on_free(size);
+        }
+
+        /// The allocation is no longer retained by its scope only if it was released by the same thread before the scope was left,
+        /// we're looking for it within our own frames, as the owner frame could be already gone
+        if (owner.frame == nullptr) {
+            return;
+        }
+        for (auto* frame = detail::frame; frame != nullptr; frame = frame->parent) {
+            if (frame != owner.frame || frame->serial != owner.serial) {
+                continue;
+            }
+
+            frame->stage_live -= static_cast<std::int64_t>(size);
+            if (frame->function_frame != nullptr) {
+                frame->function_frame->function_live -= static_cast<std::int64_t>(size);
+            }
+            break;
+        }
+    }
+
+    /// \brief Scope that the allocations of the current thread are accounted to
+    class Scope {
+    public:
+        NON_COPYABLE(Scope);
+
+        /// \param stage Stage name
+        /// \param function Function name, the parent scope function is inherited if it's empty
+        explicit Scope(const std::string_view stage, const std::string_view function = {}) {
+            if (!enabled()) {
+                return;
+            }
+
+            auto& registry = detail::Registry::get();
+            previous_ = detail::current;
+            owner_ = {
+                .stage = registry.stage(stage),
+                .function = function.empty() ? previous_.function : registry.function(function),
+            };
+
+            frame_ = {
+                .parent = detail::frame,
+                .serial = ++detail::frame_serial,
+            };
+            if (owner_.function != nullptr && owner_.function != previous_.function) {
+                frame_.function_frame = &frame_;
+            } else if (owner_.function != nullptr && frame_.parent != nullptr) {
+                frame_.function_frame = frame_.parent->function_frame;
+            }
+
+            detail::current = owner_;
+            detail::frame = &frame_;
+            active_ = true;
+        }
+
+        ~Scope() {
+            if (!active_) {
+                return;
+            }
+
+            detail::current = previous_;
+            detail::frame = frame_.parent;
+            owner_.stage->retained.fetch_add(frame_.stage_live, std::memory_order_relaxed);
+
+            /// Nested scopes of the same function are already accounted by the outer one
+            if (frame_.function_frame == &frame_) {
+                owner_.function->retained.fetch_add(frame_.function_live, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        bool active_ = false;
+        owner_t owner_ = {};
+        owner_t previous_ = {};
+        detail::frame_t frame_ = {};
+    };
+
+    /// \brief Snapshot of an entry
+    struct usage_t {
+        std::string name = {};
+        std::uint64_t allocated = 0;
+        std::uint64_t allocations = 0;
+        std::int64_t live = 0;
+        std::int64_t peak = 0;
+        std::int64_t retained = 0;
+    };
+
+    /// \brief Snapshot of all the entries, stages and functions are sorted by their peaks
+    struct report_t {
+        usage_t total = {};
+        std::vector<usage_t> stages = {};
+        std::vector<usage_t> functions = {};
+    };
+
+    /// \brief Collect the report
+    [[nodiscard]] inline report_t report() {
+        auto snapshot = [](const std::string_view name, const entry_t& entry) -> usage_t {
+            return {
+                .name = std::string{name},
+                .allocated = entry.allocated.load(std::memory_order_relaxed),
+                .allocations = entry.allocations.load(std::memory_order_relaxed),
+                .live = entry.live.load(std::memory_order_relaxed),
+                .peak = entry.peak.load(std::memory_order_relaxed),
+                .retained = entry.retained.load(std::memory_order_relaxed),
+            };
+        };
+
+        report_t result = {.total = snapshot("total", detail::total)};
+        result.stages.emplace_back(snapshot("(unscoped)", detail::unscoped));
+        detail::Registry::get().iter([&](const detail::Registry::Entries& stages, const detail::Registry::Entries& functions) -> void {
+            for (const auto& [name, entry] : stages) {
+                result.stages.emplace_back(snapshot(name, *entry));
+            }
+            for (const auto& [name, entry] : functions) {
+                result.functions.emplace_back(snapshot(name, *entry));
+            }
+        });
+
+        std::ranges::stable_sort(result.stages, std::ranges::greater{}, &usage_t::peak);
+        std::ranges::stable_sort(result.functions, std::ranges::greater{}, &usage_t::peak);
+        return result;
+    }
+} // namespace memory::accounting
@@ -0,0 +1,76 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace util {
+    /// \brief Typed object pool, objects are allocated in chunks and destroyed all at once along with the pool
+    /// \note There's no way to free a single object, which is fine since the analysis objects
+    /// live as long as the function they belong to
+    /// \tparam Ty Object type
+    /// \tparam ChunkSize Number of objects per chunk
+    template <typename Ty, std::size_t ChunkSize = 256>
+    class ObjectPool {
+    public:
+        DEFAULT_CTOR(ObjectPool);
+        NON_COPYABLE(ObjectPool);
+
+        ~ObjectPool() {
+            clear();
+        }
+
+        /// \brief Construct a new object within the pool
+        /// \tparam Args Constructor argument types
+        /// \param args Constructor arguments
+        /// \return Object pointer, valid until the pool is cleared
+        template <typename... Args>
+        [[nodiscard]] Ty* make(Args&&... args) {
+            if (chunks_.empty() || used_ == ChunkSize) {
+                chunks_.emplace_back(new storage_t[ChunkSize]);
+                used_ = 0;
+            }
+
+            auto* result = std::construct_at(reinterpret_cast<Ty*>(&chunks_.back()[used_]), std::forward<Args>(args)...);
+            ++used_;
+            ++size_;
+            return result;
+        }
+
+        /// \brief Destroy all the objects and release the memory
+        void clear() noexcept {
+            for (std::size_t chunk = 0; chunk < chunks_.size(); ++chunk) {
+                const auto count = chunk + 1 == chunks_.size() ? used_ : ChunkSize;
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::destroy_at(std::launder(reinterpret_cast<Ty*>(&chunks_[chunk][i])));
+                }
+            }
+
+            chunks_.clear();
+            used_ = 0;
+            size_ = 0;
+        }
+
+        /// \brief Get the number of allocated objects
+        /// \return Number of objects
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+    private:
+        /// \brief Uninitialized storage for a single object
+        struct alignas(Ty) storage_t {
+            std::byte data[sizeof(Ty)];
+        };
+
+        /// \brief Allocated chunks
+        std::vector<std::unique_ptr<storage_t[]>> chunks_ = {};
+        /// \brief Number of objects that are used in the last chunk
+        std::size_t used_ = 0;
+        /// \brief Total number of objects
+        std::size_t size_ = 0;
+    };
+} // namespace util
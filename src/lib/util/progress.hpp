@@ -2,6 +2,8 @@
 #include "logger.hpp"
 #include "util/stopwatch.hpp"
 
+#include <mutex>
+
 namespace util {
     /// \brief Progress-bar object
     class Progress {
@@ -17,7 +19,10 @@ namespace util {
         }
 
         /// \brief Do a step and update the progress msg
+        /// \note Thread-safe, workers could step the same progress bar
         void step() {
+            const std::lock_guard _(mtx_);
+
             /// Increment the step
             ++step_;
 
@@ -43,5 +48,7 @@ namespace util {
         std::size_t steps_ = {};
         /// \brief Current step
         std::ptrdiff_t step_ = -1; // we start at -1 and it will automatically increment it to 0
+        /// \brief Step mutex
+        std::mutex mtx_ = {};
     };
 } // namespace util
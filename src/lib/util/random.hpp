@@ -1,19 +1,111 @@
 #pragma once
 #include "util/logger.hpp"
+#include "util/structs.hpp"
 #include "util/types.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cstring>
 #include <numeric>
 #include <optional>
 #include <random>
+#include <string_view>
 
 namespace rnd {
     namespace detail {
-        /// We are gonna use the mersenne twister prng because its pretty convenient
-        /// and its already present in std
-        inline std::mt19937_64 prng = {}; // NOLINT
+        /// \brief SplitMix64 finalizer, used to derive seeds/states
+        /// \param value input value
+        /// \return mixed value
+        [[nodiscard]] constexpr std::uint64_t splitmix64(std::uint64_t value) noexcept {
+            value += 0x9E3779B97F4A7C15ULL;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            return value ^ (value >> 31);
+        }
+
+        /// \brief FNV-1a, we can't use std::hash here because its result is implementation-defined
+        /// and we want the same streams on every platform
+        /// \param value string that it should hash
+        /// \return hash
+        [[nodiscard]] constexpr std::uint64_t fnv1a(const std::string_view value) noexcept {
+            std::uint64_t result = 0xCBF29CE484222325ULL;
+            for (const char c : value) {
+                result ^= static_cast<std::uint8_t>(c);
+                result *= 0x100000001B3ULL;
+            }
+            return result;
+        }
+
+        /// \brief xoshiro256** prng, its much faster than mersenne twister and has a tiny state,
+        /// so we could afford to have a separate stream per every function/transform
+        /// @credits: https://prng.di.unimi.it/xoshiro256starstar.c
+        class Xoshiro256 {
+        public:
+            DEFAULT_DTOR(Xoshiro256);
+            DEFAULT_COPY(Xoshiro256);
+            using result_type = std::uint64_t;
+
+            /// \param seed_value seed
+            explicit Xoshiro256(const std::uint64_t seed_value = 0) noexcept {
+                seed(seed_value);
+            }
+
+            /// \brief Reset the prng state
+            /// \param seed_value seed
+            void seed(const std::uint64_t seed_value) noexcept {
+                /// Expand the seed to state using splitmix, as suggested by the authors
+                for (std::size_t i = 0; i < state_.size(); ++i) {
+                    state_[i] = splitmix64(seed_value + i * 0x9E3779B97F4A7C15ULL);
+                }
+            }
+
+            /// \brief Generate the next number
+            /// \return random number
+            result_type operator()() noexcept {
+                const auto result = std::rotl(state_[1] * 5, 7) * 9;
+                const auto t = state_[1] << 17;
+
+                state_[2] ^= state_[0];
+                state_[3] ^= state_[1];
+                state_[1] ^= state_[2];
+                state_[0] ^= state_[3];
+
+                state_[2] ^= t;
+                state_[3] = std::rotl(state_[3], 45);
+
+                return result;
+            }
+
+            [[nodiscard]] static constexpr result_type min() noexcept {
+                return std::numeric_limits<result_type>::min();
+            }
+
+            [[nodiscard]] static constexpr result_type max() noexcept {
+                return std::numeric_limits<result_type>::max();
+            }
+
+        private:
+            std::array<std::uint64_t, 4> state_ = {};
+        };
+
+        /// \brief The seed that was set via `seed`, all the streams are derived from it
+        inline std::uint64_t global_seed = 0; // NOLINT
 
-        /// \brief Set the MT seed
+        /// \brief Thread fallback prng, used when there's no stream active on the current thread
+        inline thread_local Xoshiro256 thread_prng = {}; // NOLINT
+
+        /// \brief Stream that is currently active on this thread
+        inline thread_local Xoshiro256* current_prng = nullptr; // NOLINT
+
+        /// \brief Get the prng that should be used on this thread
+        /// \return prng reference
+        [[nodiscard]] inline Xoshiro256& prng() noexcept {
+            return current_prng != nullptr ? *current_prng : thread_prng;
+        }
+
+        /// \brief Set the global seed
         /// \param seed seed to set
         inline void seed(std::optional<std::uint64_t> seed = std::nullopt) {
             /// Generate the random seed, if needed
@@ -24,10 +116,67 @@ namespace rnd {
 
             /// Set the seed
             logger::info("random: seed is {:#x}", *seed);
-            prng.seed(*seed);
+            global_seed = *seed;
+            thread_prng.seed(*seed);
+        }
+
+        /// \brief Derive the stream seed from the global seed and stream keys
+        /// \param key stream key, function name for example
+        /// \param tag stream tag, transform tag for example
+        /// \param index stream index, used to tell apart the streams with the same key and tag
+        /// \return seed
+        [[nodiscard]] inline std::uint64_t derive_seed(const std::string_view key, const std::uint64_t tag, const std::uint64_t index) noexcept {
+            auto result = splitmix64(global_seed ^ fnv1a(key));
+            result = splitmix64(result ^ tag);
+            return splitmix64(result ^ index);
+        }
+
+        /// \brief Get a random number in range [0; range]
+        /// \param range max value
+        /// \return random number
+        [[nodiscard]] inline std::uint64_t bounded(const std::uint64_t range) noexcept {
+            auto& gen = prng();
+            if (range == std::numeric_limits<std::uint64_t>::max()) {
+                return gen();
+            }
+
+            /// Reject the values that would make the result biased, which is (2^64 % bound) values at most
+            const auto bound = range + 1;
+            const auto threshold = (0 - bound) % bound;
+            for (;;) {
+                if (const auto value = gen(); value >= threshold) {
+                    return value % bound;
+                }
+            }
         }
     } // namespace detail
 
+    /// \brief A scoped random stream, every rnd:: call on this thread would use this stream while its alive.
+    /// Streams depend only on the global seed and their keys, so the output doesn't depend on the order
+    /// in which functions are processed, nor on the number of threads.
+    class Stream {
+    public:
+        NON_COPYABLE(Stream);
+
+        /// \param key stream key, function name for example
+        /// \param tag stream tag, transform tag for example
+        /// \param index stream index, used to tell apart the streams with the same key and tag
+        explicit Stream(const std::string_view key, const std::uint64_t tag = 0, const std::uint64_t index = 0)
+            : prng_(detail::derive_seed(key, tag, index)), previous_(detail::current_prng) {
+            detail::current_prng = &prng_;
+        }
+
+        ~Stream() {
+            detail::current_prng = previous_;
+        }
+
+    private:
+        /// \brief Stream state
+        detail::Xoshiro256 prng_;
+        /// \brief Stream that was active before this one
+        detail::Xoshiro256* previous_ = nullptr;
+    };
+
     /// \brief Get random number in desired range
     /// \tparam Ty result type
     /// \param min minimal value, by default set to the min limit of the `Ty` type
@@ -35,17 +184,23 @@ namespace rnd {
     /// \return random number
     template <typename Ty = std::uint32_t, typename TyVal = std::remove_reference_t<Ty>, typename Limits = std::numeric_limits<TyVal>>
     TyVal number(const TyVal min = Limits::min(), const TyVal max = Limits::max()) {
-        /// We cannot generate une byte of data with uniform_int_distribution
-        using GenTy = std::conditional_t<types::is_any_of_v<Ty, std::int8_t, std::uint8_t, char>, int, TyVal>;
-        std::uniform_int_distribution<GenTy> dist(min, max);
-        return static_cast<TyVal>(dist(detail::prng));
+        /// Operate on unsigned values, so that the range wouldn't overflow for signed types
+        using UnsignedTy = std::make_unsigned_t<TyVal>;
+        const auto range = static_cast<UnsignedTy>(static_cast<UnsignedTy>(max) - static_cast<UnsignedTy>(min));
+        return static_cast<TyVal>(static_cast<UnsignedTy>(min) + static_cast<UnsignedTy>(detail::bounded(range)));
     }
 
     /// \brief Generate a number of bytes
     /// \param ptr pointer where it should write these bytes to
     /// \param size size
     inline void bytes(std::uint8_t* ptr, const std::size_t size) {
-        std::generate_n(ptr, size, []() -> std::uint8_t { return number<std::uint8_t>(); });
+        auto& gen = detail::prng();
+
+        /// Fill 8 bytes per every generated number
+        for (std::size_t offset = 0; offset < size; offset += sizeof(std::uint64_t)) {
+            const auto value = gen();
+            std::memcpy(ptr + offset, &value, std::min(sizeof(value), size - offset));
+        }
     }
 
     /// \brief Generate a number of bytes and return them as a vector
@@ -63,7 +218,7 @@ namespace rnd {
     /// \param chance (from 0 to 100)% chance
     /// \return true/false
     inline bool chance(const std::uint8_t chance) {
-        return number<std::uint8_t>(0, 100) <= chance;
+        return number<std::uint8_t>(1, 100) <= chance;
     }
 
     /// \brief Get a random item from the container
@@ -105,6 +105,12 @@ namespace util {
             return ElapsedTime(Clock::now() - started_);
         }
 
+        /// \brief Get the raw difference between current and start time
+        /// \return Clock duration
+        [[nodiscard]] auto duration() const noexcept {
+            return Clock::now() - started_;
+        }
+
     private:
         /// \brief Start time
         TimePoint started_ = {};
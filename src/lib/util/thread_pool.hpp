@@ -0,0 +1,97 @@
+#pragma once
+#include "util/structs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace util {
+    /// \brief A tiny fork-join thread pool that is used to run independent jobs in parallel
+    /// \note Workers are spawned per batch, there are only a couple of batches per run
+    /// so there's no point in keeping them alive in between
+    class ThreadPool {
+    public:
+        DEFAULT_DTOR(ThreadPool);
+        NON_COPYABLE(ThreadPool);
+
+        /// \brief Job callback, receives the job index and the worker index
+        using Callback = std::function<void(std::size_t, std::size_t)>;
+
+        /// \param num_threads Number of workers, 0 - use all the available hardware threads
+        explicit ThreadPool(const std::size_t num_threads = 0): num_threads_(num_threads) {
+            if (num_threads_ == 0) {
+                num_threads_ = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            }
+        }
+
+        /// \brief Run the callback for every job index, jobs are dispatched in the specified order
+        /// \param order Job indices
+        /// \param callback Job callback
+        /// \note The first exception thrown by any of the jobs is rethrown on the caller thread
+        void for_each(const std::vector<std::size_t>& order, const Callback& callback) const {
+            const auto num_workers = std::min(num_threads_, order.size());
+
+            /// No need to spawn anything if there's only one worker
+            if (num_workers <= 1) {
+                std::ranges::for_each(order, [&callback](const std::size_t index) -> void { callback(index, 0); });
+                return;
+            }
+
+            std::atomic_size_t next_job = 0;
+            std::exception_ptr exception = nullptr;
+            std::mutex exception_mtx = {};
+
+            /// Spawn workers, they would be joined once we leave this scope
+            {
+                std::vector<std::jthread> workers = {};
+                workers.reserve(num_workers);
+
+                for (std::size_t worker = 0; worker < num_workers; ++worker) {
+                    workers.emplace_back([&, worker]() -> void {
+                        for (auto job = next_job.fetch_add(1); job < order.size(); job = next_job.fetch_add(1)) {
+                            try {
+                                callback(order[job], worker);
+                            } catch (...) {
+                                const std::lock_guard _(exception_mtx);
+                                if (exception == nullptr) {
+                                    exception = std::current_exception();
+                                }
+
+                                /// No need to dispatch the remaining jobs
+                                next_job = order.size();
+                            }
+                        }
+                    });
+                }
+            }
+
+            if (exception != nullptr) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        /// \brief Run the callback for job indices in range [0; count)
+        /// \param count Number of jobs
+        /// \param callback Job callback
+        void for_each(const std::size_t count, const Callback& callback) const {
+            std::vector<std::size_t> order(count);
+            std::iota(order.begin(), order.end(), 0);
+            for_each(order, callback);
+        }
+
+        /// \brief Get the number of workers
+        /// \return Number of workers
+        [[nodiscard]] std::size_t size() const noexcept {
+            return num_threads_;
+        }
+
+    private:
+        /// \brief Number of workers
+        std::size_t num_threads_ = 1;
+    };
+} // namespace util
@@ -0,0 +1,151 @@
+#pragma once
+#include "util/format.hpp"
+#include "util/memory/accounting.hpp"
+#include "util/structs.hpp"
+#include "util/types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// \note Scoped spans that are exported in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+/// Every thread records its spans into its own buffer, so there's no locking in the hot path, and when tracing is
+/// disabled the span is just an atomic load. Spans are also the scopes for the allocation accounting, if it's enabled.
+namespace util::trace {
+    namespace detail {
+        using Clock = std::chrono::steady_clock;
+
+        /// \brief Finished span
+        struct event_t {
+            std::string name = {};
+            std::string function = {};
+            Clock::time_point start = {};
+            Clock::duration duration = {};
+        };
+
+        /// \brief Per-thread event storage, owned by the recorder so that it outlives the thread
+        struct buffer_t {
+            std::uint32_t tid = 0;
+            std::vector<event_t> events = {};
+        };
+
+        class Recorder : public types::Singleton<Recorder> {
+        public:
+            /// \brief Get the buffer of the current thread
+            [[nodiscard]] buffer_t& local() {
+                thread_local buffer_t* buffer = nullptr;
+                if (buffer != nullptr) {
+                    return *buffer;
+                }
+
+                const std::lock_guard _(mtx_);
+                auto& result = buffers_.emplace_back(std::make_unique<buffer_t>());
+                result->tid = static_cast<std::uint32_t>(buffers_.size());
+                buffer = result.get();
+                return *buffer;
+            }
+
+            /// \brief Iterate over all the recorded events
+            /// \note Should be called once all the traced threads are done
+            template <typename Fn>
+            void iter_events(Fn&& callback) {
+                const std::lock_guard _(mtx_);
+                for (const auto& buffer : buffers_) {
+                    for (const auto& event : buffer->events) {
+                        callback(buffer->tid, event);
+                    }
+                }
+            }
+
+            std::atomic_bool enabled = false;
+            Clock::time_point epoch = Clock::now();
+
+        private:
+            std::mutex mtx_ = {};
+            std::vector<std::unique_ptr<buffer_t>> buffers_ = {};
+        };
+
+        /// \brief Convert the duration to microseconds
+        [[nodiscard]] inline double to_us(const Clock::duration duration) {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+    } // namespace detail
+
+    /// \brief Start recording the spans
+    inline void enable() {
+        auto& recorder = detail::Recorder::get();
+        recorder.epoch = detail::Clock::now();
+        recorder.enabled.store(true, std::memory_order_release);
+    }
+
+    /// \brief Check whether the spans are recorded
+    [[nodiscard]] inline bool enabled() {
+        return detail::Recorder::get().enabled.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Scoped span, it is recorded once it goes out of scope
+    class Span {
+    public:
+        NON_COPYABLE(Span);
+
+        /// \param name Span name, like "bb_decomp: phase 1" or the transform name
+        /// \param function Name of the function that is being processed, if any
+        explicit Span(const std::string_view name, const std::string_view function = {}): scope_(name, function) {
+            if (!enabled()) {
+                return;
+            }
+
+            event_.emplace(detail::event_t{
+                .name = std::string{name},
+                .function = std::string{function},
+                .start = detail::Clock::now(),
+            });
+        }
+
+        ~Span() {
+            if (!event_.has_value()) {
+                return;
+            }
+
+            event_->duration = detail::Clock::now() - event_->start;
+            detail::Recorder::get().local().events.emplace_back(std::move(*event_));
+        }
+
+    private:
+        memory::accounting::Scope scope_;
+        std::optional<detail::event_t> event_ = std::nullopt;
+    };
+
+    /// \brief Save the recorded spans as a Chrome trace json
+    /// \param path Output path
+    inline void save(const std::filesystem::path& path) {
+        auto& recorder = detail::Recorder::get();
+
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error(std::format("trace: unable to open {}", path.string()));
+        }
+
+        file << R"({"displayTimeUnit":"ms","traceEvents":[)" << '\n';
+        file << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"obfuscator"}})";
+
+        recorder.iter_events([&file, &recorder](const std::uint32_t tid, const detail::event_t& event) -> void {
+            file << std::format(R"(,{}{{"name":{},"cat":"obfuscator","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f})", '\n',
+                                format::json(event.name), tid, detail::to_us(event.start - recorder.epoch), detail::to_us(event.duration));
+            if (!event.function.empty()) {
+                file << std::format(R"(,"args":{{"function":{}}})", format::json(event.function));
+            }
+            file << '}';
+        });
+
+        file << "\n]}\n";
+    }
+} // namespace util::trace
@@ -0,0 +1,79 @@
+#include "tests_util.hpp"
+#include <analysis/common/cfg.hpp>
+
+#include <array>
+
+namespace {
+    struct node_t {
+        analysis::bb_id_t id = 0;
+    };
+
+    std::vector<node_t*> to_vector(const std::span<node_t* const> value) {
+        return {value.begin(), value.end()};
+    }
+} // namespace
+
+TEST(CFG, push_dedup) {
+    OBFUSCATOR_TEST_START;
+
+    std::array<node_t, 4> nodes = {node_t{0}, node_t{1}, node_t{2}, node_t{3}};
+    analysis::cfg_edges_t<node_t> edges = {};
+
+    ASSERT_TRUE(edges.push(0, 2, &nodes[2]));
+    ASSERT_TRUE(edges.push(0, 1, &nodes[1]));
+    ASSERT_FALSE(edges.push(0, 2, &nodes[2]));
+    ASSERT_TRUE(edges.push(3, 0, &nodes[0]));
+    ASSERT_EQ(edges.size(), 3);
+
+    /// Insertion order should be preserved
+    ASSERT_EQ(to_vector(edges.at(0)), (std::vector<node_t*>{&nodes[2], &nodes[1]}));
+    ASSERT_TRUE(edges.at(1).empty());
+    ASSERT_TRUE(edges.at(2).empty());
+    ASSERT_EQ(to_vector(edges.at(3)), (std::vector<node_t*>{&nodes[0]}));
+    ASSERT_TRUE(edges.at(1337).empty());
+}
+
+TEST(CFG, erase) {
+    OBFUSCATOR_TEST_START;
+
+    std::array<node_t, 3> nodes = {node_t{0}, node_t{1}, node_t{2}};
+    analysis::cfg_edges_t<node_t> edges = {};
+
+    edges.push(0, 1, &nodes[1]);
+    edges.push(0, 2, &nodes[2]);
+    edges.push(1, 2, &nodes[2]);
+    ASSERT_EQ(edges.at(0).size(), 2);
+
+    ASSERT_EQ(edges.erase(0), 2);
+    ASSERT_TRUE(edges.at(0).empty());
+    ASSERT_EQ(edges.at(1).size(), 1);
+
+    /// Erased edges could be inserted again
+    ASSERT_TRUE(edges.push(0, 2, &nodes[2]));
+    ASSERT_EQ(to_vector(edges.at(0)), (std::vector<node_t*>{&nodes[2]}));
+
+    ASSERT_EQ(edges.erase_if([](const analysis::bb_id_t) -> bool { return true; }), 2);
+    ASSERT_EQ(edges.size(), 0);
+    ASSERT_TRUE(edges.at(0).empty());
+}
+
+TEST(CFG, stable_spans) {
+    OBFUSCATOR_TEST_START;
+
+    std::array<node_t, 3> nodes = {node_t{0}, node_t{1}, node_t{2}};
+    analysis::cfg_edges_t<node_t> edges = {};
+
+    edges.push(0, 1, &nodes[1]);
+    const auto row = edges.at(0);
+
+    /// Modifying the other rows shouldn't invalidate the spans that were already handed out
+    edges.push(1, 2, &nodes[2]);
+    edges.push(2, 0, &nodes[0]);
+    ASSERT_EQ(edges.at(2).size(), 1);
+    edges.erase(1);
+    ASSERT_EQ(edges.at(1).size(), 0);
+
+    ASSERT_EQ(row.data(), edges.at(0).data());
+    ASSERT_EQ(to_vector(row), (std::vector<node_t*>{&nodes[1]}));
+    ASSERT_EQ(edges.size(), 2);
+}
@@ -0,0 +1,113 @@
+#include "tests_util.hpp"
+#include <analysis/common/provider.hpp>
+#include <analysis/liveness/liveness.hpp>
+
+#include <functional>
+
+namespace {
+    /// \brief Emit the instructions and push them to the basic block
+    /// \return the last pushed instruction
+    analysis::insn_t* emit(analysis::bb_t* bb, zasm::Program& program, const std::function<void(zasm::x86::Assembler&)>& callback) {
+        analysis::functional_bb_provider_t provider = {};
+        zasm::x86::Assembler as(program);
+        as.setCursor(program.getTail());
+
+        auto* start = as.getCursor();
+        callback(as);
+
+        analysis::insn_t* result = nullptr;
+        for (auto* node = start != nullptr ? start->getNext() : program.getHead(); node != nullptr; node = node->getNext()) {
+            result = bb->push_insn(node, &provider);
+            if (node == as.getCursor()) {
+                break;
+            }
+        }
+        return result;
+    }
+
+    void link(analysis::bb_t* from, analysis::bb_t* to) {
+        from->push_successor(to);
+        to->push_predecessor(from);
+    }
+
+    constexpr auto kRax = static_cast<analysis::reg_mask_t>(1U << 0U);
+    constexpr auto kRcx = static_cast<analysis::reg_mask_t>(1U << 1U);
+    constexpr auto kRdx = static_cast<analysis::reg_mask_t>(1U << 2U);
+} // namespace
+
+TEST(Liveness, dead_registers) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    zasm::Program program(zasm::MachineMode::AMD64);
+
+    /// entry -> (left, right) -> merge, merge overwrites ecx/edx before leaving the function
+    analysis::bb_storage_t storage = {};
+    auto* entry = storage.make_bb(program.getMode());
+    auto* left = storage.make_bb(program.getMode());
+    auto* right = storage.make_bb(program.getMode());
+    auto* merge = storage.make_bb(program.getMode());
+
+    const auto* entry_last = emit(entry, program, [](Assembler& a) -> void {
+        a.mov(ecx, zasm::Imm(1));
+        a.mov(edx, zasm::Imm(2));
+    });
+    const auto* left_last = emit(left, program, [](Assembler& a) -> void { a.mov(eax, ecx); });
+    emit(right, program, [](Assembler& a) -> void { a.mov(eax, edx); });
+    emit(merge, program, [](Assembler& a) -> void {
+        a.mov(ecx, zasm::Imm(0));
+        a.mov(edx, zasm::Imm(0));
+    });
+
+    link(entry, left);
+    link(entry, right);
+    link(left, merge);
+    link(right, merge);
+
+    /// eax is overwritten on both paths, ecx/edx are read by one of them
+    const auto after_entry = analysis::liveness::dead_after(entry_last);
+    ASSERT_NE(after_entry & kRax, 0);
+    ASSERT_EQ(after_entry & (kRcx | kRdx), 0);
+
+    /// ecx/edx are overwritten by the merge block, but eax is live until the function exit
+    const auto after_left = analysis::liveness::dead_after(left_last);
+    ASSERT_EQ(after_left & (kRcx | kRdx), kRcx | kRdx);
+    ASSERT_EQ(after_left & kRax, 0);
+
+    /// Unknown successors, everything is live
+    ASSERT_EQ(analysis::liveness::live_after(merge->instructions.back()), analysis::kAllLive);
+}
+
+TEST(Liveness, flags) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    zasm::Program program(zasm::MachineMode::AMD64);
+    Assembler as(program);
+
+    /// compare -> use, `use` reads ZF and then overwrites all the flags
+    analysis::bb_storage_t storage = {};
+    auto* compare = storage.make_bb(program.getMode());
+    auto* use = storage.make_bb(program.getMode());
+
+    emit(compare, program, [](Assembler& a) -> void { a.cmp(eax, ecx); });
+    const auto* mov = emit(compare, program, [](Assembler& a) -> void { a.mov(edx, zasm::Imm(1)); });
+    emit(use, program, [](Assembler& a) -> void {
+        a.setz(bl);
+        a.add(eax, zasm::Imm(1));
+    });
+    link(compare, use);
+
+    const auto* cmp = compare->instructions.front();
+    ASSERT_EQ(analysis::liveness::live_after(cmp).flags, analysis::FL_ZF);
+    ASSERT_EQ(analysis::liveness::live_before(mov).flags, analysis::FL_ZF);
+    ASSERT_EQ(analysis::liveness::live_before(cmp).flags, 0);
+
+    /// Inserting a CF reader should update the liveness of the predecessor
+    analysis::functional_bb_provider_t provider = {};
+    as.setCursor(program.getTail());
+    as.adc(edx, zasm::Imm(0));
+    use->push_insn(as.getCursor(), &provider, std::nullopt, std::nullopt, use->instructions.begin());
+    ASSERT_EQ(analysis::liveness::live_after(cmp).flags, analysis::FL_ZF | analysis::FL_CF);
+    ASSERT_EQ(analysis::liveness::live_before(cmp).flags, 0);
+}
@@ -0,0 +1,80 @@
+#include "tests_util.hpp"
+#include <analysis/loops/loops.hpp>
+
+#include <array>
+
+namespace {
+    void link(analysis::bb_t* from, analysis::bb_t* to) {
+        from->push_successor(to);
+        to->push_predecessor(from);
+    }
+} // namespace
+
+TEST(Loops, nested) {
+    OBFUSCATOR_TEST_START;
+
+    /// entry -> outer header -> inner header <-> inner body -> outer latch -> outer header
+    ///                       -> exit
+    analysis::bb_storage_t storage = {};
+    std::array<analysis::bb_t*, 6> bbs = {};
+    for (auto& bb : bbs) {
+        bb = storage.make_bb(zasm::MachineMode::AMD64);
+    }
+    const auto [entry, outer, inner, body, latch, exit] = bbs;
+
+    link(entry, outer);
+    link(outer, inner);
+    link(inner, body);
+    link(body, inner);
+    link(body, latch);
+    link(latch, outer);
+    link(outer, exit);
+
+    ASSERT_EQ(analysis::loops::update(storage, entry), 2);
+
+    ASSERT_EQ(entry->loop_depth, 0);
+    ASSERT_EQ(outer->loop_depth, 1);
+    ASSERT_EQ(inner->loop_depth, 2);
+    ASSERT_EQ(body->loop_depth, 2);
+    ASSERT_EQ(latch->loop_depth, 1);
+    ASSERT_EQ(exit->loop_depth, 0);
+
+    /// Outer loop goes first, the inner header could be entered from the outer header only
+    const auto loops = analysis::loops::find(storage, entry);
+    ASSERT_EQ(loops.size(), 2);
+    ASSERT_EQ(loops[0].header, outer);
+    ASSERT_EQ(loops[0].blocks.size(), 4);
+    ASSERT_EQ(loops[0].preheader(), entry);
+    ASSERT_EQ(loops[1].header, inner);
+    ASSERT_EQ(loops[1].preheader(), nullptr); // outer header has two successors
+}
+
+TEST(Loops, dominators) {
+    OBFUSCATOR_TEST_START;
+
+    /// Diamond: entry -> (left, right) -> merge
+    analysis::bb_storage_t storage = {};
+    std::array<analysis::bb_t*, 4> bbs = {};
+    for (auto& bb : bbs) {
+        bb = storage.make_bb(zasm::MachineMode::AMD64);
+    }
+    const auto [entry, left, right, merge] = bbs;
+
+    link(entry, left);
+    link(entry, right);
+    link(left, merge);
+    link(right, merge);
+
+    const analysis::loops::Dominators dominators(storage, entry);
+    ASSERT_EQ(dominators.idom(entry), nullptr);
+    ASSERT_EQ(dominators.idom(left), entry);
+    ASSERT_EQ(dominators.idom(right), entry);
+    ASSERT_EQ(dominators.idom(merge), entry);
+
+    ASSERT_TRUE(dominators.dominates(entry, merge));
+    ASSERT_TRUE(dominators.dominates(merge, merge));
+    ASSERT_FALSE(dominators.dominates(left, merge));
+    ASSERT_FALSE(dominators.dominates(merge, entry));
+
+    ASSERT_EQ(analysis::loops::update(storage, entry), 0);
+}
@@ -0,0 +1,94 @@
+#include "tests_util.hpp"
+#include <analysis/common/provider.hpp>
+#include <analysis/stack_height/stack_height.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace {
+    /// \brief Put every node of the program into a single basic block
+    analysis::bb_t* make_bb(analysis::bb_storage_t& storage, zasm::Program& program) {
+        analysis::functional_bb_provider_t provider = {};
+        auto* bb = storage.make_bb(program.getMode());
+        for (auto* node = program.getHead(); node != nullptr; node = node->getNext()) {
+            bb->push_insn(node, &provider);
+        }
+        return bb;
+    }
+} // namespace
+
+TEST(StackHeight, prologue_epilogue) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    zasm::Program program(zasm::MachineMode::AMD64);
+    Assembler as(program);
+    as.push(rbx);
+    as.sub(rsp, zasm::Imm(0x20));
+    as.mov(rax, qword_ptr(rsp, 0x30));
+    as.call(zasm::Imm(0x1000));
+    as.lea(rsp, qword_ptr(rsp, 0x20));
+    as.pop(rbx);
+    as.ret();
+
+    analysis::bb_storage_t storage = {};
+    const auto* bb = make_bb(storage, program);
+
+    const auto heights = analysis::stack_height::compute(bb);
+    ASSERT_TRUE(heights.has_value());
+
+    std::vector<std::int64_t> result = {};
+    for (const auto* insn : bb->instructions) {
+        result.emplace_back(heights->at(insn));
+    }
+    ASSERT_EQ(result, (std::vector<std::int64_t>{0, -8, -0x28, -0x28, -0x28, -8, 0}));
+}
+
+TEST(StackHeight, untracked) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    zasm::Program program(zasm::MachineMode::AMD64);
+    Assembler as(program);
+    as.push(rbp);
+    as.mov(rbp, rsp);
+    as.leave();
+    as.ret();
+
+    analysis::bb_storage_t storage = {};
+    const auto* bb = make_bb(storage, program);
+    ASSERT_FALSE(analysis::stack_height::compute(bb).has_value());
+}
+
+TEST(StackHeight, sp_aliases) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    auto compute = [](const std::function<void(Assembler&)>& emit) -> bool {
+        zasm::Program program(zasm::MachineMode::AMD64);
+        Assembler as(program);
+        as.push(rbp);
+        emit(as);
+        as.pop(rbp);
+        as.ret();
+
+        analysis::bb_storage_t storage = {};
+        return analysis::stack_height::compute(make_bb(storage, program)).has_value();
+    };
+
+    /// Frame pointer derived from sp
+    ASSERT_FALSE(compute([](Assembler& as) -> void { as.lea(rbp, qword_ptr(rsp, -0x10)); }));
+    ASSERT_FALSE(compute([](Assembler& as) -> void { as.lea(rax, qword_ptr(rsp, 8)); }));
+    ASSERT_FALSE(compute([](Assembler& as) -> void { as.lea(rax, qword_ptr(rsp, rcx, 1, 8)); }));
+    ASSERT_FALSE(compute([](Assembler& as) -> void { as.push(rsp); }));
+    ASSERT_FALSE(compute([](Assembler& as) -> void { as.mov(qword_ptr(rax), rsp); }));
+
+    /// Loads/stores through sp and the addresses that aren't derived from it
+    ASSERT_TRUE(compute([](Assembler& as) -> void { as.mov(rax, qword_ptr(rsp, 0x10)); }));
+    ASSERT_TRUE(compute([](Assembler& as) -> void { as.mov(qword_ptr(rsp, 0x10), rax); }));
+    ASSERT_TRUE(compute([](Assembler& as) -> void { as.lea(rax, qword_ptr(rcx, 8)); }));
+    ASSERT_TRUE(compute([](Assembler& as) -> void {
+        as.lea(rsp, qword_ptr(rsp, -0x10));
+        as.lea(rsp, qword_ptr(rsp, 0x10));
+    }));
+}
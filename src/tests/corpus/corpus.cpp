@@ -0,0 +1,52 @@
+#include "tests_util.hpp"
+
+#include <analysis/analysis.hpp>
+#include <corpus/corpus.hpp>
+#include <func_parser/map/map.hpp>
+
+namespace {
+    constexpr corpus::config_t kConfig = {.functions = 8, .blocks = 12, .jump_table_fanout = 5, .relocated_immediates = 6};
+
+    template <pe::any_raw_image_t Img>
+    void check_corpus(const std::string_view name) {
+        auto output = corpus::generate<Img>(kConfig);
+        ASSERT_EQ(output.functions.size(), kConfig.functions);
+
+        pe::Image<Img> image(memory::cast<Img*>(output.image.data()));
+        ASSERT_TRUE(image.is_valid());
+        ASSERT_EQ(image.is_x64(), (std::is_same_v<Img, win::image_x64_t>));
+        ASSERT_EQ(image.relocations.size(), kConfig.functions * kConfig.relocated_immediates + //
+                                                (image.is_x64() ? 0 : kConfig.functions)); // x86 jump tables are relocated too
+
+        /// Map should match the generated functions
+        const auto path = std::filesystem::temp_directory_path() / std::format("obfuscator_corpus_{}.exe", name);
+        corpus::save(output, path);
+        const auto symbols = func_parser::map::discover_functions(std::filesystem::path{path}.replace_extension(".map"), image.sections);
+        ASSERT_EQ(symbols.size(), output.functions.size());
+        for (std::size_t i = 0; i < symbols.size(); ++i) {
+            ASSERT_EQ(symbols[i].name, output.functions[i].name);
+            ASSERT_EQ(symbols[i].rva, output.functions[i].rva);
+        }
+
+        /// Every block should be discovered, including the jump table targets
+        for (const auto& function : output.functions) {
+            const auto analysed = analysis::analyse(&image, function);
+            ASSERT_GE(analysed.bb_storage->size(), kConfig.blocks);
+        }
+    }
+} // namespace
+
+TEST(Corpus, x64) {
+    OBFUSCATOR_TEST_START;
+    check_corpus<win::image_x64_t>("x64");
+}
+
+TEST(Corpus, x86) {
+    OBFUSCATOR_TEST_START;
+    check_corpus<win::image_x86_t>("x86");
+}
+
+TEST(Corpus, invalid_config) {
+    OBFUSCATOR_TEST_START;
+    ASSERT_THROW(std::ignore = corpus::generate<win::image_x64_t>(corpus::config_t{.functions = 0}), std::runtime_error);
+}
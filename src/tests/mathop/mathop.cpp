@@ -0,0 +1,175 @@
+#include "tests_util.hpp"
+#include <mathop/mathop.hpp>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace {
+    /// \brief Registers of every supported width
+    using width_t = std::pair<zasm::BitSize, zasm::x86::Gp>;
+    const std::array kWidths = {
+        width_t{zasm::BitSize::_8, zasm::x86::cl},
+        width_t{zasm::BitSize::_16, zasm::x86::cx},
+        width_t{zasm::BitSize::_32, zasm::x86::ecx},
+        width_t{zasm::BitSize::_64, zasm::x86::rcx},
+    };
+
+    /// \brief Lift the revert of the operation
+    /// \return emitted instructions
+    std::vector<zasm::Instruction> lift(const mathop::Operation& operation, const zasm::x86::Gp reg, const std::optional<mathop::Argument>& rhs) {
+        zasm::Program program(zasm::MachineMode::AMD64);
+        zasm::x86::Assembler assembler(program);
+        operation.lift_revert(&assembler, reg, rhs);
+
+        std::vector<zasm::Instruction> result = {};
+        for (const auto* node = program.getHead(); node != nullptr; node = node->getNext()) {
+            if (const auto* insn = node->getIf<zasm::Instruction>(); insn != nullptr) {
+                result.emplace_back(*insn);
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] ZydisMnemonic mnemonic(const zasm::Instruction& insn) {
+        return static_cast<ZydisMnemonic>(insn.getMnemonic().value());
+    }
+} // namespace
+
+TEST(Mathop, new_operations) {
+    OBFUSCATOR_TEST_START;
+
+    const mathop::operations::Rol rol = {};
+    const mathop::operations::Ror ror = {};
+    const mathop::operations::Bswap bswap = {};
+    const mathop::operations::LeaAdd lea_add = {};
+
+    const auto value = mathop::imm_for_bits(zasm::BitSize::_32, 0x11223344);
+    const auto count = mathop::imm_for_bits(zasm::BitSize::_32, 8);
+    ASSERT_EQ(std::get<std::int32_t>(rol.emulate(value, count)), 0x22334411);
+    ASSERT_EQ(std::get<std::int32_t>(ror.emulate(value, count)), 0x44112233);
+    ASSERT_EQ(std::get<std::int32_t>(bswap.emulate(value, std::nullopt)), 0x44332211);
+    ASSERT_EQ(std::get<std::int32_t>(lea_add.emulate(value, count)), 0x1122334C);
+
+    /// No bswap/lea for the 8/16bit operands
+    ASSERT_FALSE(bswap.cost(zasm::BitSize::_16).has_value());
+    ASSERT_FALSE(lea_add.cost(zasm::BitSize::_8).has_value());
+    ASSERT_TRUE(bswap.cost(zasm::BitSize::_64).has_value());
+}
+
+TEST(Mathop, lift_rotate) {
+    OBFUSCATOR_TEST_START;
+
+    const mathop::operations::Rol rol = {};
+    const mathop::operations::Ror ror = {};
+    for (const auto& [bit_size, reg] : kWidths) {
+        const auto count = mathop::imm_for_bits(bit_size, 5);
+
+        /// Rol is reverted by ror with the same count and vice versa
+        for (const auto& [operation, expected] : {std::pair<const mathop::Operation*, ZydisMnemonic>{&rol, ZYDIS_MNEMONIC_ROR},
+                                                  std::pair<const mathop::Operation*, ZydisMnemonic>{&ror, ZYDIS_MNEMONIC_ROL}}) {
+            const auto insns = lift(*operation, reg, mathop::convert(count));
+            ASSERT_EQ(insns.size(), 1);
+            ASSERT_EQ(mnemonic(insns.front()), expected);
+            ASSERT_EQ(insns.front().getOperandIf<zasm::Reg>(0)->getId(), reg.getId());
+            ASSERT_EQ(insns.front().getOperandIf<zasm::Imm>(1)->value<std::int64_t>(), 5);
+        }
+
+        /// Emulation and the lifted revert should cancel each other out
+        const auto value = mathop::imm_for_bits(bit_size, 0x1122334455667788);
+        ASSERT_EQ(ror.emulate(rol.emulate(value, count), count), value);
+    }
+}
+
+TEST(Mathop, lift_lea_add) {
+    OBFUSCATOR_TEST_START;
+
+    const mathop::operations::LeaAdd lea_add = {};
+    for (const auto& [bit_size, reg] : kWidths) {
+        const auto rhs = mathop::imm_for_bits(bit_size, 0x1234);
+        if (getBitSize(bit_size) < 32) {
+            ASSERT_THROW(lift(lea_add, reg, mathop::convert(rhs)), std::runtime_error);
+            continue;
+        }
+
+        /// lea r, [r - imm]
+        const auto insns = lift(lea_add, reg, mathop::convert(rhs));
+        ASSERT_EQ(insns.size(), 1);
+        ASSERT_EQ(mnemonic(insns.front()), ZYDIS_MNEMONIC_LEA);
+        ASSERT_EQ(insns.front().getOperandIf<zasm::Reg>(0)->getId(), reg.getId());
+
+        const auto* mem = insns.front().getOperandIf<zasm::Mem>(1);
+        ASSERT_NE(mem, nullptr);
+        ASSERT_EQ(mem->getBase().getId(), reg.getId());
+        ASSERT_FALSE(mem->getIndex().isValid());
+        ASSERT_EQ(mem->getDisplacement(), -0x1234);
+    }
+}
+
+TEST(Mathop, lift_bswap) {
+    OBFUSCATOR_TEST_START;
+
+    const mathop::operations::Bswap bswap = {};
+    for (const auto& [bit_size, reg] : kWidths) {
+        if (getBitSize(bit_size) < 32) {
+            continue;
+        }
+
+        const auto insns = lift(bswap, reg, std::nullopt);
+        ASSERT_EQ(insns.size(), 1);
+        ASSERT_EQ(mnemonic(insns.front()), ZYDIS_MNEMONIC_BSWAP);
+        ASSERT_EQ(insns.front().getOperandCount(), 1);
+        ASSERT_EQ(insns.front().getOperandIf<zasm::Reg>(0)->getId(), reg.getId());
+
+        const auto value = mathop::imm_for_bits(bit_size, 0x1122334455667788);
+        ASSERT_EQ(bswap.emulate(bswap.emulate(value, std::nullopt), std::nullopt), value);
+    }
+}
+
+TEST(Mathop, generate_narrow) {
+    OBFUSCATOR_TEST_START;
+    rnd::detail::seed(0x1337);
+
+    /// No bswap/lea for the 8/16bit operands, even with the count-based generation
+    for (const auto& [bit_size, reg] : {kWidths[0], kWidths[1]}) {
+        for (std::size_t i = 0; i < 64; ++i) {
+            auto expression = mathop::ExpressionGenerator::get().generate(bit_size, std::size_t{16});
+            for (const auto& operation : expression) {
+                ASSERT_NE(operation.kind(), mathop::Kind::BSWAP);
+            }
+
+            zasm::Program program(zasm::MachineMode::AMD64);
+            zasm::x86::Assembler assembler(program);
+            expression.lift_revert(&assembler, reg);
+            for (const auto* node = program.getHead(); node != nullptr; node = node->getNext()) {
+                const auto* insn = node->getIf<zasm::Instruction>();
+                ASSERT_NE(insn, nullptr);
+                ASSERT_NE(mnemonic(*insn), ZYDIS_MNEMONIC_LEA);
+                ASSERT_NE(mnemonic(*insn), ZYDIS_MNEMONIC_BSWAP);
+            }
+        }
+    }
+}
+
+TEST(Mathop, budget) {
+    OBFUSCATOR_TEST_START;
+    rnd::detail::seed(0x1337);
+
+    for (const auto bit_size : {zasm::BitSize::_8, zasm::BitSize::_16, zasm::BitSize::_32, zasm::BitSize::_64}) {
+        for (std::size_t i = 0; i < 32; ++i) {
+            const auto expression = mathop::ExpressionGenerator::get().generate(bit_size, mathop::budget_t{.cycles = 12, .bytes = 40});
+
+            const auto cost = expression.cost();
+            ASSERT_LE(cost.latency, 12U);
+            ASSERT_LE(cost.size, 40U);
+            ASSERT_GT(cost.latency, 0U);
+
+            /// Neighbouring operations shouldn't fold
+            std::optional<mathop::Kind> prev_kind = std::nullopt;
+            for (const auto& operation : expression) {
+                ASSERT_NE(prev_kind, operation.kind());
+                prev_kind = operation.kind();
+            }
+        }
+    }
+}
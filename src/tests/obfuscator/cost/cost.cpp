@@ -0,0 +1,128 @@
+#include "tests_util.hpp"
+#include <obfuscator/cost/cost.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace {
+    using Emitter = std::function<void(zasm::x86::Assembler&)>;
+    using obfuscator::cost::cost_t;
+    using budget_t = config_parser::overhead_budget_t;
+
+    /// \brief Emit a program
+    /// \param emit callback that emits the program
+    /// \return zasm program
+    std::shared_ptr<zasm::Program> make_program(const Emitter& emit) {
+        auto program = std::make_shared<zasm::Program>(zasm::MachineMode::AMD64);
+        zasm::x86::Assembler assembler(*program);
+        emit(assembler);
+        return program;
+    }
+
+    /// \brief Estimate the cost of the only instruction within the program
+    /// \param emit callback that emits the instruction
+    /// \return cost
+    cost_t of_insn(const Emitter& emit) {
+        const auto program = make_program(emit);
+        return obfuscator::cost::of(program->getMode(), program->getHead());
+    }
+} // namespace
+
+TEST(Cost, of) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+    using obfuscator::cost::detail::kBranchLatency;
+    using obfuscator::cost::detail::kMemLatency;
+
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.mov(rax, rcx); }), (cost_t{.instructions = 1, .cycles = 1, .bytes = 3}));
+
+    /// Memory operands, implicit ones included
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.mov(rax, qword_ptr(rcx)); }),
+              (cost_t{.instructions = 1, .mem_ops = 1, .cycles = 1 + kMemLatency, .bytes = 3}));
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.push(rcx); }), (cost_t{.instructions = 1, .mem_ops = 1, .cycles = 1 + kMemLatency, .bytes = 1}));
+
+    /// Lea doesn't access the memory
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.lea(rax, qword_ptr(rcx, 8)); }), (cost_t{.instructions = 1, .cycles = 1, .bytes = 4}));
+
+    /// Branches
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.jmp(rax); }), (cost_t{.instructions = 1, .branches = 1, .cycles = 1 + kBranchLatency, .bytes = 2}));
+    ASSERT_EQ(of_insn([](Assembler& as) -> void { as.ret(); }).branches, 1);
+
+    /// The whole program
+    const auto program = make_program([](Assembler& as) -> void {
+        as.push(rcx);
+        as.mov(rax, rcx);
+        as.ret();
+    });
+    auto expected = of_insn([](Assembler& as) -> void { as.push(rcx); });
+    expected += of_insn([](Assembler& as) -> void { as.mov(rax, rcx); });
+    expected += of_insn([](Assembler& as) -> void { as.ret(); });
+    ASSERT_EQ(obfuscator::cost::of(*program), expected);
+    ASSERT_EQ(expected.instructions, 3);
+    ASSERT_EQ(expected.branches, 1);
+    ASSERT_EQ(expected.bytes, 5);
+}
+
+TEST(Cost, exhausted_percent) {
+    OBFUSCATOR_TEST_START;
+
+    const auto budget = budget_t{.kind = budget_t::e_kind::PERCENT, .value = 30};
+    const auto original = cost_t{.cycles = 100, .bytes = 1000};
+
+    ASSERT_FALSE(obfuscator::cost::exhausted(budget, original, original));
+    ASSERT_FALSE(obfuscator::cost::exhausted(budget, original, cost_t{.cycles = 129, .bytes = 100000}));
+    ASSERT_TRUE(obfuscator::cost::exhausted(budget, original, cost_t{.cycles = 130}));
+    ASSERT_TRUE(obfuscator::cost::exhausted(budget, original, cost_t{.cycles = 500}));
+
+    /// Zero budget means that nothing could be added at all
+    ASSERT_TRUE(obfuscator::cost::exhausted(budget_t{.kind = budget_t::e_kind::PERCENT, .value = 0}, original, original));
+}
+
+TEST(Cost, exhausted_bytes) {
+    OBFUSCATOR_TEST_START;
+
+    const auto budget = budget_t{.kind = budget_t::e_kind::BYTES, .value = 4};
+    const auto original = cost_t{.cycles = 100, .bytes = 10};
+
+    ASSERT_FALSE(obfuscator::cost::exhausted(budget, original, original));
+    ASSERT_FALSE(obfuscator::cost::exhausted(budget, original, cost_t{.cycles = 100000, .bytes = 13}));
+    ASSERT_TRUE(obfuscator::cost::exhausted(budget, original, cost_t{.bytes = 14}));
+    ASSERT_TRUE(obfuscator::cost::exhausted(budget, original, cost_t{.bytes = 100}));
+}
+
+TEST(Cost, tracker) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    const auto program = make_program([](Assembler& as) -> void {
+        as.mov(rax, rcx);
+        as.ret();
+    });
+    const auto original = obfuscator::cost::of(*program);
+
+    obfuscator::cost::Tracker tracker(program);
+    ASSERT_EQ(tracker.original(), original);
+    ASSERT_EQ(tracker.current(), original);
+
+    /// Insert
+    Assembler assembler(*program);
+    assembler.setCursor(program->getHead());
+    assembler.push(rcx);
+    assembler.pop(rcx);
+    ASSERT_EQ(tracker.current(), obfuscator::cost::of(*program));
+    ASSERT_EQ(tracker.current().instructions, 4);
+    ASSERT_EQ(tracker.original(), original);
+
+    /// Destroy
+    auto* push = program->getHead()->getNext();
+    auto* pop = push->getNext();
+    program->destroy(push);
+    ASSERT_EQ(tracker.current(), obfuscator::cost::of(*program));
+    ASSERT_EQ(tracker.current().instructions, 3);
+
+    /// Detached nodes are subtracted only once
+    program->detach(pop);
+    ASSERT_EQ(tracker.current(), original);
+    program->destroy(pop);
+    ASSERT_EQ(tracker.current(), original);
+}
@@ -0,0 +1,208 @@
+#include "tests_util.hpp"
+#include <analysis/analysis.hpp>
+#include <corpus/corpus.hpp>
+#include <obfuscator/peephole/peephole.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace {
+    using Emitter = std::function<void(zasm::x86::Assembler&)>;
+
+    struct result_t {
+        std::vector<ZydisMnemonic> mnemonics = {};
+        std::vector<zasm::Instruction> instructions = {};
+        std::size_t removed = 0;
+    };
+
+    /// \brief Run the optimizer on the emitted program
+    /// \param emit callback that emits the program
+    /// \return remaining instructions
+    result_t optimize(const Emitter& emit) {
+        /// We need a real function for the analysis state, its program is replaced with ours though
+        auto output = corpus::generate<win::image_x64_t>(corpus::config_t{.functions = 1, .blocks = 2});
+        pe::X64Image image(memory::cast<win::image_x64_t*>(output.image.data()));
+        const auto analysed = analysis::analyse(&image, output.functions.front());
+
+        obfuscator::Function<pe::X64Image> function(analysed, &image);
+        function.program = std::make_shared<zasm::Program>(zasm::MachineMode::AMD64);
+        function.assembler = std::make_shared<zasm::x86::Assembler>(*function.program);
+        function.cursor = std::make_unique<easm::Cursor>(function.program, function.assembler);
+        emit(*function.assembler);
+
+        result_t result = {.removed = obfuscator::peephole::optimize(&function)};
+        for (auto* node = function.program->getHead(); node != nullptr; node = node->getNext()) {
+            if (const auto* insn = node->getIf<zasm::Instruction>(); insn != nullptr) {
+                result.mnemonics.emplace_back(static_cast<ZydisMnemonic>(insn->getMnemonic().value()));
+                result.instructions.emplace_back(*insn);
+            }
+        }
+        return result;
+    }
+} // namespace
+
+TEST(Peephole, push_pop) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    auto result = optimize([](Assembler& as) -> void {
+        as.push(rcx);
+        as.pop(rcx);
+        as.nop();
+    });
+    ASSERT_EQ(result.removed, 2);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_NOP}));
+
+    /// Different registers
+    result = optimize([](Assembler& as) -> void {
+        as.push(rcx);
+        as.pop(rdx);
+    });
+    ASSERT_EQ(result.removed, 0);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_PUSH, ZYDIS_MNEMONIC_POP}));
+
+    /// Stack pointer is never touched
+    result = optimize([](Assembler& as) -> void {
+        as.push(rsp);
+        as.pop(rsp);
+    });
+    ASSERT_EQ(result.removed, 0);
+}
+
+TEST(Peephole, pop_push) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    auto result = optimize([](Assembler& as) -> void {
+        as.pop(rcx);
+        as.push(rcx);
+    });
+    ASSERT_EQ(result.removed, 1);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_MOV}));
+
+    /// `mov rcx, [rsp]`
+    const auto& mov = result.instructions.front();
+    const auto* dst = mov.getOperandIf<zasm::Reg>(0);
+    const auto* src = mov.getOperandIf<zasm::Mem>(1);
+    ASSERT_TRUE(dst != nullptr && src != nullptr);
+    ASSERT_EQ(dst->getId(), rcx.getId());
+    ASSERT_EQ(src->getBase().getId(), rsp.getId());
+    ASSERT_EQ(src->getDisplacement(), 0);
+
+    /// Different registers
+    result = optimize([](Assembler& as) -> void {
+        as.pop(rcx);
+        as.push(rdx);
+    });
+    ASSERT_EQ(result.removed, 0);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_POP, ZYDIS_MNEMONIC_PUSH}));
+
+    /// 16bit push/pop are moving sp by 2, that's not a qword load
+    result = optimize([](Assembler& as) -> void {
+        as.pop(cx);
+        as.push(cx);
+    });
+    ASSERT_EQ(result.removed, 0);
+}
+
+TEST(Peephole, pushf_popf) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    auto result = optimize([](Assembler& as) -> void {
+        as.pushfq();
+        as.popfq();
+        as.nop();
+    });
+    ASSERT_EQ(result.removed, 2);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_NOP}));
+
+    /// Not adjacent
+    result = optimize([](Assembler& as) -> void {
+        as.pushfq();
+        as.nop();
+        as.popfq();
+    });
+    ASSERT_EQ(result.removed, 0);
+}
+
+TEST(Peephole, popf_pushf_fold) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    /// Two flag saving stubs next to each other
+    auto result = optimize([](Assembler& as) -> void {
+        as.popfq();
+        as.mov(rax, rcx);
+        as.pushfq();
+        as.mov(rdx, rcx);
+        as.popfq();
+    });
+    ASSERT_EQ(result.removed, 2);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_MOV, ZYDIS_MNEMONIC_MOV, ZYDIS_MNEMONIC_POPFQ}));
+
+    /// Stuff that shouldn't be executed with a different stack pointer/flags in between
+    const std::vector<Emitter> in_between = {
+        [](Assembler& as) -> void { as.mov(rax, rsp); },
+        [](Assembler& as) -> void { as.lea(rax, qword_ptr(rsp, 8)); },
+        [](Assembler& as) -> void { as.mov(rcx, qword_ptr(rsp, 0x30)); },
+        [](Assembler& as) -> void { as.mov(qword_ptr(rax), rcx); },
+        [](Assembler& as) -> void { as.setz(al); },
+        [](Assembler& as) -> void { as.add(rax, rcx); },
+        [](Assembler& as) -> void { as.push(rax); },
+    };
+    for (const auto& emit : in_between) {
+        result = optimize([&emit](Assembler& as) -> void {
+            as.popfq();
+            emit(as);
+            as.pushfq();
+            as.mov(rdx, rcx);
+            as.popfq();
+        });
+        ASSERT_EQ(result.removed, 0);
+    }
+
+    /// Flags are read before they're restored
+    result = optimize([](Assembler& as) -> void {
+        as.popfq();
+        as.mov(rax, rcx);
+        as.pushfq();
+        as.setz(al);
+        as.popfq();
+    });
+    ASSERT_EQ(result.removed, 0);
+
+    /// Flags are never restored
+    result = optimize([](Assembler& as) -> void {
+        as.popfq();
+        as.mov(rax, rcx);
+        as.pushfq();
+        as.mov(rdx, rcx);
+    });
+    ASSERT_EQ(result.removed, 0);
+}
+
+TEST(Peephole, jmp_to_next) {
+    OBFUSCATOR_TEST_START;
+    using namespace zasm::x86;
+
+    auto result = optimize([](Assembler& as) -> void {
+        auto label = as.createLabel();
+        as.jmp(label);
+        as.bind(label);
+        as.nop();
+    });
+    ASSERT_EQ(result.removed, 1);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_NOP}));
+
+    /// There's something in between
+    result = optimize([](Assembler& as) -> void {
+        auto label = as.createLabel();
+        as.jmp(label);
+        as.nop();
+        as.bind(label);
+        as.nop();
+    });
+    ASSERT_EQ(result.removed, 0);
+    ASSERT_EQ(result.mnemonics, (std::vector{ZYDIS_MNEMONIC_JMP, ZYDIS_MNEMONIC_NOP, ZYDIS_MNEMONIC_NOP}));
+}
@@ -0,0 +1,23 @@
+#include "tests_util.hpp"
+
+#include <corpus/corpus.hpp>
+#include <pe/pe.hpp>
+
+TEST(PeRebuilder, file_output) {
+    OBFUSCATOR_TEST_START;
+
+    const auto output = corpus::generate<win::image_x64_t>(corpus::config_t{.functions = 4, .blocks = 4, .relocated_immediates = 2});
+
+    /// Rebuilder patches the raw image headers, so every image gets its own copy
+    auto buffer_input = output.image;
+    pe::X64Image buffer_image(memory::cast<win::image_x64_t*>(buffer_input.data()));
+    const auto expected = buffer_image.rebuild_pe_image();
+
+    auto file_input = output.image;
+    pe::X64Image file_image(memory::cast<win::image_x64_t*>(file_input.data()));
+    const auto path = std::filesystem::temp_directory_path() / "obfuscator_rebuilt.exe";
+    file_image.rebuild_pe_image(path);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(util::read_file(path), expected);
+}
@@ -0,0 +1,36 @@
+#include "tests_util.hpp"
+
+#include <corpus/corpus.hpp>
+#include <pe/pe.hpp>
+
+TEST(PeSections, copy_on_write) {
+    OBFUSCATOR_TEST_START;
+
+    const auto output = corpus::generate<win::image_x64_t>(corpus::config_t{.functions = 4, .blocks = 4});
+    const auto path = std::filesystem::temp_directory_path() / "obfuscator_sections.exe";
+    corpus::save(output, path);
+
+    const util::MappedFile file(path);
+    ASSERT_EQ(file.size(), output.image.size());
+    ASSERT_TRUE(std::equal(file.data(), file.data() + file.size(), output.image.begin()));
+
+    pe::X64Image image(memory::cast<win::image_x64_t*>(file.data()));
+    ASSERT_FALSE(image.sections.empty());
+    ASSERT_TRUE(std::ranges::all_of(image.sections, [](const pe::section_t& sec) -> bool { return sec.raw_data.is_view(); }));
+
+    /// Lookups shouldn't copy anything
+    const auto exec_sections = image.find_sections_if([](const pe::section_t& sec) -> bool { return sec.characteristics.mem_execute; });
+    ASSERT_EQ(exec_sections.size(), 1);
+    ASSERT_EQ(image.rva_to_ptr(exec_sections[0]->virtual_address), file.data() + exec_sections[0]->ptr_raw_data);
+
+    /// Only the modified section should be materialized, the mapped file should stay untouched
+    const auto rva = output.functions.front().rva;
+    const auto original = *image.rva_to_ptr(rva);
+    *image.rva_to_mutable_ptr(rva) = static_cast<std::uint8_t>(~original);
+
+    const auto* text = image.rva_to_section(static_cast<std::uint32_t>(rva));
+    ASSERT_FALSE(text->raw_data.is_view());
+    ASSERT_EQ(*image.rva_to_ptr(rva), static_cast<std::uint8_t>(~original));
+    ASSERT_EQ(file.data()[text->ptr_raw_data + (rva - text->virtual_address)], original);
+    ASSERT_EQ(std::ranges::count_if(image.sections, [](const pe::section_t& sec) -> bool { return !sec.raw_data.is_view(); }), 1);
+}
@@ -0,0 +1,80 @@
+#include "tests_util.hpp"
+#include <profile/profile.hpp>
+
+#include <format>
+
+TEST(Profile, text) {
+    OBFUSCATOR_TEST_START;
+
+    const auto profile = profile::Profile::from_text("# rva hits\n"
+                                                     "0x1010 5\n"
+                                                     "1000 10 # no prefix\n"
+                                                     "\n"
+                                                     "0x1010 1\n"
+                                                     "0x2000 100\n");
+    ASSERT_EQ(profile.size(), 3);
+
+    ASSERT_EQ(profile.hits(0x1000, 0x1010), 10);
+    ASSERT_EQ(profile.hits(0x1000, 0x1011), 16);
+    ASSERT_EQ(profile.hits(0x1011, 0x2000), 0);
+    ASSERT_EQ(profile.hits(0, 0xFFFFFFFF), 116);
+}
+
+TEST(Profile, text_invalid) {
+    OBFUSCATOR_TEST_START;
+
+    for (const auto* line : {"0x1000 abc", "zz 5", "12xyz 7", "0x1000 7abc", "0x1000", "0x 5", "0x1000 -5", "0x1000 5 6",
+                             "0x1000 99999999999999999999", "0x10000000000000000 5"}) {
+        ASSERT_THROW((void)profile::Profile::from_text(std::format("0x2000 1\n{}\n", line)), std::runtime_error);
+    }
+}
+
+TEST(Profile, binary) {
+    OBFUSCATOR_TEST_START;
+
+    std::vector<std::uint8_t> content(profile::kBinaryMagic.begin(), profile::kBinaryMagic.end());
+    auto push = [&content]<typename Ty>(Ty value) -> void {
+        for (std::size_t i = 0; i < sizeof(Ty); ++i) {
+            content.emplace_back(static_cast<std::uint8_t>(value >> (i * 8)));
+        }
+    };
+
+    push(std::uint32_t{0x2000});
+    push(std::uint64_t{0x100000000});
+    push(std::uint32_t{0x1000});
+    push(std::uint64_t{7});
+
+    const auto profile = profile::Profile::from_binary(content);
+    ASSERT_EQ(profile.size(), 2);
+    ASSERT_EQ(profile.hits(0x1000, 0x1001), 7);
+    ASSERT_EQ(profile.hits(0x1001, 0x2001), 0x100000000);
+
+    content.pop_back();
+    ASSERT_THROW((void)profile::Profile::from_binary(content), std::runtime_error);
+}
+
+TEST(Profile, chance_scales) {
+    OBFUSCATOR_TEST_START;
+
+    /// 200 blocks, so the top 2 are considered hot
+    std::vector<std::uint64_t> hits(200, 0);
+    hits[0] = 1'000'000;
+    hits[1] = 500'000;
+    hits[2] = 50'000; // 5% of the hottest one
+    hits[3] = 1;
+
+    const auto scales = profile::chance_scales(hits);
+    ASSERT_EQ(scales.size(), hits.size());
+    ASSERT_EQ(scales[0], 0.F);
+    ASSERT_EQ(scales[1], 0.F);
+    ASSERT_LT(scales[2], 0.25F);
+    ASSERT_GT(scales[3], 0.9F);
+    ASSERT_LT(scales[3], 1.F);
+    ASSERT_EQ(scales[4], 1.F);
+    ASSERT_EQ(scales.back(), 1.F);
+
+    /// At least one block is always hot
+    ASSERT_EQ(profile::chance_scales(std::vector<std::uint64_t>{10, 1}).front(), 0.F);
+    ASSERT_EQ(profile::chance_scales(std::vector<std::uint64_t>{0, 0}), (std::vector{1.F, 1.F}));
+    ASSERT_TRUE(profile::chance_scales({}).empty());
+}
@@ -0,0 +1,99 @@
+#include "tests_util.hpp"
+#include <util/memory/accounting.hpp>
+
+#include <algorithm>
+#include <latch>
+#include <thread>
+
+namespace {
+    [[nodiscard]] memory::accounting::usage_t find(const std::vector<memory::accounting::usage_t>& usages, const std::string_view name) {
+        const auto it = std::ranges::find(usages, name, &memory::accounting::usage_t::name);
+        return it != usages.end() ? *it : memory::accounting::usage_t{};
+    }
+} // namespace
+
+TEST(MemoryAccounting, scopes) {
+    OBFUSCATOR_TEST_START;
+
+    /// The hook isn't compiled into the tests, so we're accounting the allocations by hand
+    memory::accounting::enable();
+
+    memory::accounting::owner_t leaked = {};
+    {
+        const memory::accounting::Scope outer("accounting: outer", "accounting_func");
+        const auto temporary = memory::accounting::on_alloc(100);
+
+        {
+            /// Function should be inherited from the outer scope
+            const memory::accounting::Scope inner("accounting: inner");
+            leaked = memory::accounting::on_alloc(40);
+            ASSERT_EQ(leaked.function, temporary.function);
+        }
+
+        memory::accounting::on_free(temporary, 100);
+    }
+
+    const auto report = memory::accounting::report();
+
+    const auto outer = find(report.stages, "accounting: outer");
+    ASSERT_EQ(outer.allocated, 100);
+    ASSERT_EQ(outer.peak, 100);
+    ASSERT_EQ(outer.live, 0);
+    ASSERT_EQ(outer.retained, 0);
+
+    const auto inner = find(report.stages, "accounting: inner");
+    ASSERT_EQ(inner.allocated, 40);
+    ASSERT_EQ(inner.live, 40);
+    ASSERT_EQ(inner.retained, 40);
+
+    const auto function = find(report.functions, "accounting_func");
+    ASSERT_EQ(function.allocated, 140);
+    ASSERT_EQ(function.allocations, 2);
+    ASSERT_EQ(function.peak, 140);
+    ASSERT_EQ(function.retained, 40);
+
+    memory::accounting::on_free(leaked, 40);
+    ASSERT_EQ(find(memory::accounting::report().functions, "accounting_func").live, 0);
+}
+
+TEST(MemoryAccounting, retained_per_thread) {
+    OBFUSCATOR_TEST_START;
+    memory::accounting::enable();
+
+    /// Both threads are within the same stage at the same time, only the second one leaks
+    std::latch entered(2);
+    std::latch allocated(1);
+    std::latch released(1);
+    memory::accounting::owner_t leaked = {};
+
+    std::thread first([&]() -> void {
+        const memory::accounting::Scope scope("accounting: threads", "accounting_threads_a");
+        entered.arrive_and_wait();
+        allocated.wait();
+
+        const auto temporary = memory::accounting::on_alloc(30);
+        memory::accounting::on_free(temporary, 30);
+        released.count_down();
+    });
+    std::thread second([&]() -> void {
+        const memory::accounting::Scope scope("accounting: threads", "accounting_threads_b");
+        entered.arrive_and_wait();
+
+        leaked = memory::accounting::on_alloc(50);
+        allocated.count_down();
+        released.wait();
+    });
+    first.join();
+    second.join();
+
+    auto report = memory::accounting::report();
+    ASSERT_EQ(find(report.stages, "accounting: threads").retained, 50);
+    ASSERT_EQ(find(report.functions, "accounting_threads_a").retained, 0);
+    ASSERT_EQ(find(report.functions, "accounting_threads_b").retained, 50);
+
+    /// Released by another thread after the scope was left, it's still retained by the scope
+    memory::accounting::on_free(leaked, 50);
+    report = memory::accounting::report();
+    ASSERT_EQ(find(report.stages, "accounting: threads").live, 0);
+    ASSERT_EQ(find(report.stages, "accounting: threads").retained, 50);
+}
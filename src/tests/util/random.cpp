@@ -0,0 +1,51 @@
+#include "tests_util.hpp"
+#include <util/random.hpp>
+
+namespace {
+    std::vector<std::uint64_t> draw(const std::string_view key, const std::uint64_t tag, const std::uint64_t index) {
+        const rnd::Stream stream(key, tag, index);
+
+        std::vector<std::uint64_t> result = {};
+        for (std::size_t i = 0; i < 16; ++i) {
+            result.emplace_back(rnd::number<std::uint64_t>());
+        }
+        return result;
+    }
+} // namespace
+
+TEST(Random, stream_determinism) {
+    OBFUSCATOR_TEST_START;
+    rnd::detail::seed(0x1337);
+
+    ASSERT_EQ(draw("main", 1, 0), draw("main", 1, 0));
+    ASSERT_NE(draw("main", 1, 0), draw("main", 2, 0));
+    ASSERT_NE(draw("main", 1, 0), draw("main", 1, 1));
+    ASSERT_NE(draw("main", 1, 0), draw("sub_1337", 1, 0));
+}
+
+TEST(Random, stream_nesting) {
+    OBFUSCATOR_TEST_START;
+    rnd::detail::seed(0x1337);
+
+    const auto expected = draw("main", 1, 0);
+
+    /// Streams should not affect each other
+    const rnd::Stream outer("main", 1, 0);
+    ASSERT_EQ(rnd::number<std::uint64_t>(), expected.front());
+    static_cast<void>(draw("sub_1337", 1, 0));
+    ASSERT_EQ(rnd::number<std::uint64_t>(), expected.at(1));
+}
+
+TEST(Random, ranges) {
+    OBFUSCATOR_TEST_START;
+    rnd::detail::seed(0x1337);
+
+    for (std::size_t i = 0; i < 10000; ++i) {
+        const auto value = rnd::number<std::int8_t>(-5, 5);
+        ASSERT_GE(value, -5);
+        ASSERT_LE(value, 5);
+
+        ASSERT_FALSE(rnd::chance(0));
+        ASSERT_TRUE(rnd::chance(100));
+    }
+}
@@ -0,0 +1,44 @@
+#include "tests_util.hpp"
+#include <util/thread_pool.hpp>
+#include <util/trace.hpp>
+
+#include <fstream>
+#include <sstream>
+
+TEST(Trace, chrome_json) {
+    OBFUSCATOR_TEST_START;
+
+    /// Spans that were recorded before the tracing was enabled should be ignored
+    {
+        const util::trace::Span _("ignored");
+    }
+
+    util::trace::enable();
+    {
+        const util::trace::Span outer("outer");
+        const util::trace::Span inner("inner", R"(quoted "function")");
+    }
+
+    util::ThreadPool(4).for_each(8, [](const std::size_t, std::size_t) -> void {
+        const util::trace::Span _("worker"); //
+    });
+
+    const auto path = std::filesystem::temp_directory_path() / "obfuscator_trace.json";
+    util::trace::save(path);
+
+    std::stringstream stream = {};
+    stream << std::ifstream(path).rdbuf();
+    const auto json = stream.str();
+
+    ASSERT_TRUE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+    ASSERT_TRUE(json.ends_with("]}\n"));
+    ASSERT_FALSE(json.contains(R"("name":"ignored")"));
+    ASSERT_TRUE(json.contains(R"("name":"outer","cat":"obfuscator","ph":"X","pid":1,"tid":1,)"));
+    ASSERT_TRUE(json.contains(R"("args":{"function":"quoted \"function\""})"));
+
+    std::size_t workers = 0;
+    for (auto pos = json.find(R"("name":"worker")"); pos != std::string::npos; pos = json.find(R"("name":"worker")", pos + 1)) {
+        ++workers;
+    }
+    ASSERT_EQ(workers, 8);
+}